@@ -0,0 +1,175 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+/*
+ * Converts assets into the formats the engine loads fastest, so that they can
+ * be prepared ahead of time by a build pipeline. Meshes are stored in the mesh
+ * cache, images are cooked into block compressed textures next to them, and
+ * scenes are compiled into the scene cache.
+ * Usage:
+ *   load bake [--decode-benchmark] <file or directory>...
+ * Directories are searched recursively. With --decode-benchmark, images are
+ * only decoded and timed, one at a time and then in parallel
+ */
+
+#include <algorithm>
+#include <base/texturecache.h>
+#include <chrono>
+#include <core/threadpool.h>
+#include <core/file.h>
+#include <core/package.h>
+#include <iostream>
+#include <iterator>
+#include <scene/meshcache.h>
+#include <scene/scenecache.h>
+#include <string>
+#include <vector>
+
+static bool HasExtension(const std::string &path,
+                         const std::vector<std::string> &extensions) {
+  return std::any_of(
+      std::begin(extensions), std::end(extensions), [&](const auto &ext) {
+        return path.size() > ext.size() &&
+               path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+      });
+}
+
+static bool IsMeshFile(const std::string &path) {
+  return HasExtension(path, {".blend", ".obj", ".fbx", ".dae", ".3ds", ".ply"});
+}
+
+// RawImage can only decode PNG images
+static bool IsTextureFile(const std::string &path) {
+  return HasExtension(path, {".png"});
+}
+
+static bool IsSceneFile(const std::string &path) {
+  return HasExtension(path, {"scene.json"});
+}
+
+static void FindFiles(const std::string &dir, std::vector<std::string> &out) {
+  std::vector<std::string> names;
+  Directory::GetFiles(dir, names);
+  for (const auto &name : names) out.push_back(dir + '/' + name);
+
+  names.clear();
+  Directory::GetFolders(dir, names);
+  for (const auto &name : names) FindFiles(dir + '/' + name, out);
+}
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+static bool DecodeBenchmark(const std::vector<std::string> &paths) {
+  std::vector<std::string> images;
+  std::copy_if(paths.begin(), paths.end(), std::back_inserter(images),
+               IsTextureFile);
+  if (images.empty()) {
+    std::cerr << "No images to decode\n";
+    return false;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::size_t bytes = 0;
+  for (const auto &path : images) {
+    RawImage image;
+    image.Load(path, true);
+    bytes += image.data.size();
+  }
+  auto sequential = MillisecondsSince(start);
+
+  start = std::chrono::steady_clock::now();
+  auto decoded = RawImage::LoadMany(images, true);
+  auto parallel = MillisecondsSince(start);
+
+  std::cout << "Decoded " << images.size() << " images (" << bytes
+            << " bytes)\n  one at a time: " << sequential
+            << "ms\n  in parallel on " << ThreadPool::Shared().Size()
+            << " threads: " << parallel << "ms\n";
+  return true;
+}
+
+extern "C" bool Bake_Run() {
+  const auto &args = Package::args;
+  if (args.empty()) {
+    std::cerr
+        << "Usage: load bake [--decode-benchmark] <file or directory>...\n";
+    return false;
+  }
+
+  bool benchmark = false;
+  std::vector<std::string> paths;
+  for (auto arg : args) {
+    if (arg == "--decode-benchmark") {
+      benchmark = true;
+      continue;
+    }
+
+    if (Directory::Exists(arg)) {
+      while (arg.size() > 1 && arg.back() == '/') arg.pop_back();
+      FindFiles(arg, paths);
+    } else
+      paths.push_back(arg);
+  }
+
+  if (benchmark) return DecodeBenchmark(paths);
+
+  unsigned meshes = 0, textures = 0, scenes = 0, failed = 0;
+  for (const auto &path : paths) {
+    if (IsMeshFile(path)) {
+      if (MeshBinaryCache::Bake(path)) {
+        std::cout << path << " -> " << MeshBinaryCache::Path(path) << '\n';
+        meshes++;
+        continue;
+      }
+    } else if (IsTextureFile(path)) {
+      if (TextureCache::Bake(path)) {
+        std::cout << path << " -> " << TextureCache::Path(path) << '\n';
+        textures++;
+        continue;
+      }
+    } else if (IsSceneFile(path)) {
+      if (SceneCache::Compile(path)) {
+        std::cout << path << " -> " << SceneCache::Path(path) << '\n';
+        scenes++;
+        continue;
+      }
+    } else
+      continue;
+
+    std::cerr << "Failed to bake '" << path << "'\n";
+    failed++;
+  }
+
+  std::cout << "Baked " << meshes << " meshes, " << textures << " textures and "
+            << scenes << " scenes";
+  if (failed) std::cout << ", " << failed << " failed";
+  std::cout << '\n';
+  return failed == 0;
+}
@@ -0,0 +1,189 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__ASSET_STREAMER_H
+#define _BASE__ASSET_STREAMER_H
+
+#include <chrono>
+#include <core/threadpool.h>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Whether a streamed asset can be used yet. Assets which are still loading or
+ * failed to load are drawn with a placeholder, or not at all
+ */
+enum class AssetState { Loading, Ready, Failed };
+
+/*
+ * Loads assets in the background. Reading and decoding files happens on a
+ * thread pool, and the results are uploaded on the main thread by Pump, which
+ * stops once it has used up the budget for the frame.
+ *
+ * Uploads should not be too large to fit within a frame's budget, as each is
+ * run in full once started. If decoding throws, the error is logged and the
+ * uploads receive a value-initialized result, which they should treat as a
+ * failure to load
+ */
+class AssetStreamer {
+  struct Job {
+    std::string key;
+    std::future<void> decoded;
+
+    // The decoded value, shared between the uploads
+    std::shared_ptr<void> result;
+    std::vector<std::function<std::size_t()>> uploads;
+
+    // Run once the uploads are done, or when the job is dropped
+    std::vector<std::function<void(bool)>> finishes;
+  };
+
+  ThreadPool &pool;
+  std::deque<Job> jobs;
+
+  Job *FindJob(const std::string &key);
+
+  /*
+   * Runs the uploads of a job whose decode has finished
+   * @returns the number of bytes uploaded
+   */
+  std::size_t Upload(Job &job);
+
+public:
+  struct Budget {
+    std::size_t bytes = 8 * 1024 * 1024;
+    std::chrono::duration<double, std::milli> time{2.0};
+  };
+
+  struct Statistics {
+    unsigned submitted = 0, uploaded = 0, failed = 0;
+    std::size_t bytesUploaded = 0;
+
+    // Frames in which uploads were left waiting for the next frame
+    unsigned framesAtBudget = 0;
+  };
+
+  Budget budget;
+  Statistics statistics;
+
+  explicit AssetStreamer(ThreadPool &_pool = ThreadPool::Shared())
+      : pool(_pool) {}
+  AssetStreamer(const AssetStreamer &) = delete;
+  AssetStreamer &operator=(const AssetStreamer &) = delete;
+
+  /*
+   * Waits for any decodes still running, and finishes the assets which weren't
+   * uploaded
+   */
+  ~AssetStreamer();
+
+  /*
+   * Queues an asset to be decoded on a worker thread and uploaded on the main
+   * thread. If an asset with the same key is still pending, it is only
+   * decoded once and each upload receives the same value
+   * @param key Identifies the asset, such as its path. Assets with the same
+   * key must decode to the same type
+   * @param decode Function returning the decoded asset
+   * @param upload Function taking the decoded asset by reference, which uploads
+   * it and returns the number of bytes uploaded
+   */
+  template <typename Decode, typename Upload>
+  void Submit(const std::string &key, Decode decode, Upload upload) {
+    Submit(key, std::move(decode), std::move(upload),
+           [](auto & /* value */, bool /* uploaded */) {});
+  }
+
+  /*
+   * Queues an asset like Submit, with a function which frees what the decoded
+   * value holds once it is no longer needed
+   * @param finish Function taking the decoded asset by reference and whether
+   * it was uploaded. Runs on the main thread once every upload sharing the
+   * value has run, or when the asset is dropped without being uploaded
+   */
+  template <typename Decode, typename Upload, typename Finish>
+  void Submit(const std::string &key, Decode decode, Upload upload,
+              Finish finish) {
+    using Value = std::invoke_result_t<Decode>;
+    static_assert(std::is_default_constructible<Value>::value,
+                  "Decoded assets must be default constructible, so that "
+                  "failed decodes can be uploaded as a failure");
+    using Result = std::optional<Value>;
+    auto *job = FindJob(key);
+    if (!job) {
+      auto result = std::make_shared<Result>();
+      jobs.push_back({key, pool.Submit([decode = std::move(decode), result] {
+                        result->emplace(decode());
+                      }),
+                      result,
+                      {},
+                      {}});
+      job = &jobs.back();
+      statistics.submitted++;
+    }
+
+    auto result = std::static_pointer_cast<Result>(job->result);
+    job->uploads.push_back([upload = std::move(upload), result]() mutable {
+      // Left empty if decoding threw
+      if (!*result) result->emplace();
+      return upload(**result);
+    });
+    job->finishes.push_back(
+        [finish = std::move(finish), result](bool uploaded) mutable {
+          if (!*result) result->emplace();
+          finish(**result, uploaded);
+        });
+  }
+
+  /*
+   * Uploads decoded assets until the budget for the frame is used up. Call
+   * once per frame on the main thread
+   */
+  void Pump();
+
+  /*
+   * @returns the number of assets which haven't been uploaded yet
+   */
+  std::size_t Pending() const { return jobs.size(); }
+
+  /*
+   * Decodes and uploads every pending asset, ignoring the budget
+   */
+  void Finish();
+
+  static AssetStreamer *active;
+};
+
+std::ostream &operator<<(std::ostream &os,
+                         const AssetStreamer::Statistics &stats);
+
+#endif // _BASE__ASSET_STREAMER_H
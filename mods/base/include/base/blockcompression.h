@@ -0,0 +1,92 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__BLOCK_COMPRESSION_H
+#define _BASE__BLOCK_COMPRESSION_H
+
+#include <base/image.h>
+#include <vector>
+
+/*
+ * Block compressed formats, which store each 4x4 block of texels in a fixed
+ * number of bytes that the GPU samples from directly
+ */
+enum class BlockFormat : GLenum {
+  // Opaque colour in 8 bytes per block
+  BC1 = GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+  // Colour with smooth alpha in 16 bytes per block
+  BC3 = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+};
+
+/*
+ * One mip level of a block compressed image
+ */
+struct CompressedLevel {
+  IVec2 size;
+  std::vector<unsigned char> data;
+};
+
+struct CompressedImage {
+  BlockFormat format = BlockFormat::BC1;
+
+  // The base level followed by each smaller level
+  std::vector<CompressedLevel> levels;
+
+  std::size_t Bytes() const;
+};
+
+namespace BlockCompression {
+/*
+ * @returns the number of bytes a level of the given size uses
+ */
+std::size_t LevelBytes(BlockFormat format, IVec2 size);
+
+/*
+ * @returns BC1 if every texel is opaque, otherwise BC3
+ */
+BlockFormat ChooseFormat(const RawImage &image);
+
+/*
+ * Compresses an RGBA image. Each block's colours are fitted to a line along
+ * their principal axis, and alpha is fitted to its range
+ */
+CompressedLevel Compress(const RawImage &image, BlockFormat format);
+
+/*
+ * Compresses an image and each of its mip levels
+ * @param mipmaps The levels below 'image', from Mipmaps::BuildChain
+ */
+CompressedImage Compress(const RawImage &image,
+                         const std::vector<RawImage> &mipmaps,
+                         BlockFormat format);
+
+/*
+ * Decompresses a level back into RGBA, for drivers without S3TC support
+ */
+RawImage Decompress(const CompressedLevel &level, BlockFormat format);
+} // namespace BlockCompression
+
+#endif // _BASE__BLOCK_COMPRESSION_H
@@ -27,57 +27,173 @@ SOFTWARE.
 #ifndef _BASE__BUFFER_H
 #define _BASE__BUFFER_H
 
-#include <vector>
+#include <base/bufferarena.h>
 #include <base/gl.h>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Memory held by a buffer or mesh in system RAM and on the GPU
+ */
+struct Residency {
+  std::size_t cpuBytes = 0, gpuBytes = 0;
+
+  Residency &operator+=(const Residency &other) {
+    cpuBytes += other.cpuBytes;
+    gpuBytes += other.gpuBytes;
+    return *this;
+  }
+};
 
+/*
+ * Vertex data stored in a range of a buffer shared with other meshes. Offsets
+ * passed to glVertexAttribPointer must be relative to Offset(). The CPU-side
+ * copy of the data is freed once uploaded, unless KeepData is set
+ */
 template <typename T>
 class Buffer {
-  GLuint ID = 0;
+  BufferArena::Allocation allocation;
   std::vector<T> data;
+  bool keepData = false;
 
 public:
   Buffer() {}
   Buffer(const std::vector<T> &bufferData) : data(bufferData) {}
-  ~Buffer()
-    { if (ID) glDeleteBuffers(1, &ID); }
 
   void Data(const std::vector<T> &value) { data = value; }
+  void Data(std::vector<T> &&value) { data = std::move(value); }
 
-  void Use() const { glBindBuffer(GL_ARRAY_BUFFER, ID); }
+  /*
+   * Keeps the data in RAM after Generate, for meshes which are read on the
+   * CPU (e.g. for collision or picking)
+   */
+  void KeepData(bool keep) { keepData = keep; }
+  const std::vector<T> &GetData() const { return data; }
+
+  Residency GetResidency() const {
+    return {data.capacity() * sizeof(T), allocation.Size()};
+  }
+
+  void Use() const { glBindBuffer(GL_ARRAY_BUFFER, allocation.Buffer()); }
 
   static void ClearUse() { glBindBuffer(GL_ARRAY_BUFFER, 0); }
 
-  void Generate() {
-    glGenBuffers(1, &ID);
-    glBindBuffer(GL_ARRAY_BUFFER, ID);
-    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW);
+  std::size_t Offset() const { return allocation.Offset(); }
+
+  /*
+   * Uploads the data and binds the buffer
+   * @returns false if the category's memory budget refused the data, in
+   * which case nothing is bound
+   */
+  bool Generate(MemoryCategory category = MemoryCategory::Vertex) {
+    auto bytes = data.size() * sizeof(T);
+    allocation = BufferArena::Get(category).Allocate(data.data(), bytes);
+    if (!allocation && bytes) return false;
+    if (!keepData) std::vector<T>().swap(data);
+    Use();
+    return true;
   }
 };
 
+/*
+ * A range of an index buffer, such as one of several meshes packed into the
+ * same buffers. Indices in the range are relative to 'baseVertex'
+ */
+struct IndexRange {
+  GLsizei first = 0, count = 0;
+  GLint baseVertex = 0;
+};
+
+/*
+ * Triangle indices. Indices are uploaded as 16 bit values when they all fit
+ */
 class ElementBuffer {
-  GLuint ID = 0;
+  BufferArena::Allocation allocation;
   std::vector<GLuint> data;
+  GLsizei count = 0;
+  GLenum type = GL_UNSIGNED_INT;
+  bool keepData = false, uploaded = false;
 
 public:
   ElementBuffer() {}
   ElementBuffer(const std::vector<GLuint> &bufferData) : data(bufferData) {}
-  ~ElementBuffer()
-    { if (ID) glDeleteBuffers(1, &ID); }
 
   void Data(const std::vector<GLuint> &value) { data = value; }
+  void Data(std::vector<GLuint> &&value) { data = std::move(value); }
+
+  void KeepData(bool keep) { keepData = keep; }
+  const std::vector<GLuint> &GetData() const { return data; }
 
-  void Use() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID); }
+  Residency GetResidency() const {
+    return {data.capacity() * sizeof(GLuint), allocation.Size()};
+  }
+
+  void Use() const {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, allocation.Buffer());
+  }
 
   static void ClearUse() { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
 
-  void Generate();
+  /*
+   * @returns the smallest GL type which can hold every index
+   */
+  static GLenum IndexType(const std::vector<GLuint> &indices);
+  static std::size_t IndexSize(GLenum indexType) {
+    return indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  }
+
+  GLenum GetIndexType() const { return type; }
+
+  /*
+   * @returns the offset of an index in the bound element buffer, as passed to
+   * the draw functions
+   */
+  const GLvoid *Indices(GLsizei first = 0) const {
+    return reinterpret_cast<const GLvoid *>(static_cast<std::uintptr_t>(
+        allocation.Offset() + first * IndexSize(type)));
+  }
+
+  /*
+   * Uploads the indices if they haven't been already
+   * @returns false if the index memory budget refused the indices
+   */
+  bool Upload();
+
+  /*
+   * Uploads the indices and attaches them to the bound vertex array
+   * @returns false if the indices could not be uploaded
+   */
+  bool Generate() {
+    if (!Upload()) return false;
+    Use();
+    return true;
+  }
 
   void Draw() const
-    { glDrawElements(GL_TRIANGLES, data.size(), GL_UNSIGNED_INT, 0); }
+    { glDrawElements(GL_TRIANGLES, count, type, Indices()); }
+
+  void DrawInstanced(unsigned instances) const {
+    glDrawElementsInstanced(GL_TRIANGLES, count, type, Indices(), instances);
+  }
+
+  void DrawRange(const IndexRange &range) const {
+    glDrawElementsBaseVertex(GL_TRIANGLES, range.count, type,
+                             Indices(range.first), range.baseVertex);
+  }
+
+  /*
+   * Draws several ranges in one call
+   * @param offsets Offsets from Indices
+   */
+  void DrawMulti(const GLsizei *counts, const GLvoid *const *offsets,
+                 GLsizei drawCount) const {
+    glMultiDrawElements(GL_TRIANGLES, counts, type, offsets, drawCount);
+  }
 
-  void DrawInstanced(unsigned count) const {
-    glDrawElementsInstanced(GL_TRIANGLES, data.size(),
-                            GL_UNSIGNED_INT, 0, count);
+  void DrawRangeInstanced(const IndexRange &range, unsigned instances) const {
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.count, type,
+                                      Indices(range.first), instances,
+                                      range.baseVertex);
   }
 
   friend class InstancedMesh;
@@ -0,0 +1,133 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__BUFFER_ARENA_H
+#define _BASE__BUFFER_ARENA_H
+
+#include <base/freelist.h>
+#include <base/gl.h>
+#include <base/gpumemory.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * Sub-allocates ranges of a few large GL buffers, rather than creating a
+ * buffer object for every vertex attribute and index list. Blocks which become
+ * empty are given back to the driver
+ */
+class BufferArena {
+  struct Block {
+    GLuint ID = 0;
+    FreeListAllocator allocator;
+
+    Block(std::size_t size) : allocator(size) {}
+  };
+
+  MemoryCategory category;
+  std::size_t blockSize;
+  std::vector<std::unique_ptr<Block>> blocks;
+
+  Block *AddBlock(std::size_t size);
+  void ReleaseBlock(std::size_t index);
+  void Free(Block *block, std::size_t offset, std::size_t size);
+
+public:
+  static constexpr const std::size_t defaultBlockSize = 8 * 1024 * 1024;
+
+  /*
+   * A range of a buffer owned by an arena, which is freed when destroyed
+   */
+  class Allocation {
+    BufferArena *arena = nullptr;
+    Block *block = nullptr;
+    std::size_t offset = 0, size = 0;
+
+    Allocation(BufferArena *_arena, Block *_block, std::size_t _offset,
+               std::size_t _size)
+        : arena(_arena), block(_block), offset(_offset), size(_size) {}
+
+    friend class BufferArena;
+
+  public:
+    Allocation() {}
+    Allocation(const Allocation &) = delete;
+    Allocation &operator=(const Allocation &) = delete;
+    Allocation(Allocation &&other) { *this = std::move(other); }
+    Allocation &operator=(Allocation &&other);
+    ~Allocation() { Reset(); }
+
+    void Reset();
+
+    explicit operator bool() const { return block != nullptr; }
+
+    GLuint Buffer() const { return block ? block->ID : 0; }
+    std::size_t Offset() const { return offset; }
+    std::size_t Size() const { return size; }
+  };
+
+  BufferArena(MemoryCategory _category,
+              std::size_t _blockSize = defaultBlockSize)
+      : category(_category), blockSize(_blockSize) {}
+  BufferArena(const BufferArena &) = delete;
+  BufferArena &operator=(const BufferArena &) = delete;
+  ~BufferArena();
+
+  /*
+   * Allocates a range and fills it with 'data'. Data larger than the block
+   * size is given a block of its own
+   * @returns An empty allocation if the category's memory budget would be
+   * exceeded
+   */
+  Allocation Allocate(const void *data, std::size_t bytes,
+                      std::size_t alignment = 16);
+
+  std::size_t BlockCount() const { return blocks.size(); }
+
+  /*
+   * The arena buffers of a given category are allocated from, in the active
+   * set of arenas. There is no arena for textures
+   */
+  static BufferArena &Get(MemoryCategory category);
+};
+
+/*
+ * An arena for each category of buffer. Usually owned by Resources, so that
+ * the arenas outlive every mesh loaded through it
+ */
+struct BufferArenas {
+  BufferArena vertices{MemoryCategory::Vertex}, indices{MemoryCategory::Index},
+      instances{MemoryCategory::Instance};
+
+  /*
+   * The arenas used by BufferArena::Get
+   */
+  static BufferArenas *active;
+
+  BufferArena &Get(MemoryCategory category);
+};
+
+#endif // _BASE__BUFFER_ARENA_H
@@ -0,0 +1,75 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__FREE_LIST_H
+#define _BASE__FREE_LIST_H
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+/*
+ * Hands out ranges of a fixed-size region, such as a GPU buffer. Uses first
+ * fit over free ranges ordered by offset, and merges neighbouring free ranges
+ * when an allocation is freed so the region does not fragment over time
+ */
+class FreeListAllocator {
+  std::size_t capacity;
+  std::size_t used = 0;
+
+  // Offset to size of each free range
+  std::map<std::size_t, std::size_t> freeRanges;
+
+  // Offset to size of each allocation, including any padding for alignment
+  std::unordered_map<std::size_t, std::size_t> allocations;
+
+public:
+  FreeListAllocator(std::size_t _capacity);
+
+  /*
+   * @returns The offset of the allocated range, or nothing if there is no free
+   * range large enough
+   */
+  std::optional<std::size_t> Allocate(std::size_t size,
+                                      std::size_t alignment = 1);
+
+  /*
+   * Frees the allocation starting at 'offset'
+   *
+   * @returns Whether 'offset' was the start of an allocation
+   */
+  bool Free(std::size_t offset);
+
+  std::size_t Capacity() const { return capacity; }
+  std::size_t Used() const { return used; }
+  bool Empty() const { return allocations.empty(); }
+
+  std::size_t LargestFreeRange() const;
+  std::size_t FreeRangeCount() const { return freeRanges.size(); }
+};
+
+#endif // _BASE__FREE_LIST_H
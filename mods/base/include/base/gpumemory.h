@@ -0,0 +1,108 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__GPU_MEMORY_H
+#define _BASE__GPU_MEMORY_H
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+
+enum class MemoryCategory { Vertex, Index, Instance, Texture };
+
+/*
+ * Static class which keeps track of the GPU memory allocated by the engine,
+ * grouped by what it is used for. Each category may be given a budget, which
+ * allocations are refused beyond
+ */
+class GPUMemory {
+  /*
+   * As class is static, we don't want to be able to create GPUMemory objects
+   */
+  GPUMemory() = delete;
+
+public:
+  static constexpr const std::size_t categoryCount = 4;
+
+  struct Usage {
+    // Bytes allocated from the driver, and the part of that holding data
+    std::size_t reserved = 0, used = 0;
+
+    // Maximum number of bytes which may be reserved, or 0 for no limit
+    std::size_t budget = 0;
+
+    bool Allows(std::size_t bytes) const {
+      return budget == 0 || reserved + bytes <= budget;
+    }
+  };
+
+private:
+  static std::array<Usage, categoryCount> usage;
+
+public:
+  static const char *Name(MemoryCategory category);
+
+  static const Usage &Get(MemoryCategory category) {
+    return usage[static_cast<std::size_t>(category)];
+  }
+
+  static void SetBudget(MemoryCategory category, std::size_t bytes) {
+    usage[static_cast<std::size_t>(category)].budget = bytes;
+  }
+
+  /*
+   * Records memory allocated from the driver
+   * @returns false, without recording anything, if the allocation would go
+   * over the category's budget
+   */
+  static bool Reserve(MemoryCategory category, std::size_t bytes);
+
+  /*
+   * Records memory allocated from the driver which can't be refused, such as
+   * streaming buffers and render targets. Going over budget is only reported
+   */
+  static void Record(MemoryCategory category, std::size_t bytes);
+  static void Release(MemoryCategory category, std::size_t bytes);
+
+  /*
+   * Records reserved memory being filled or emptied
+   */
+  static void AddUsed(MemoryCategory category, std::size_t bytes) {
+    usage[static_cast<std::size_t>(category)].used += bytes;
+  }
+  static void RemoveUsed(MemoryCategory category, std::size_t bytes) {
+    usage[static_cast<std::size_t>(category)].used -= bytes;
+  }
+
+  static std::size_t TotalReserved();
+
+  /*
+   * Writes the usage of every category in a human readable form
+   */
+  static void Report(std::ostream &os);
+};
+
+#endif // _BASE__GPU_MEMORY_H
@@ -32,11 +32,31 @@ SOFTWARE.
 #include <string>
 #include <vector>
 
+class ThreadPool;
+
+/*
+ * An image decoded into 8-bit RGBA, with rows stored contiguously
+ */
 struct RawImage {
   IVec2 size;
   std::vector<unsigned char> data;
 
+  /*
+   * Decodes a PNG straight into 'data'
+   * @param flip Whether to store the bottom row first, as OpenGL expects
+   * @returns false if the image could not be decoded, leaving it empty
+   */
   bool Load(const std::string &path, bool flip = false);
+
+  /*
+   * Decodes several images at once on a thread pool
+   * @param pool The pool to decode on, or the shared pool if null
+   * @returns the images in the same order as their paths. Images which could
+   * not be decoded are empty
+   */
+  static std::vector<RawImage> LoadMany(const std::vector<std::string> &paths,
+                                        bool flip = false,
+                                        ThreadPool *pool = nullptr);
 };
 
 #endif // _BASE__IMAGE_H
@@ -28,9 +28,11 @@ SOFTWARE.
 #define _BASE__MESH_H
 
 #include <array>
+#include <base/meshlet.h>
 #include <base/vertexattribute.h>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <math/mat.h>
 #include <math/vec.h>
 #include <test/macros.h>
@@ -50,18 +52,192 @@ public:
   static void ClearUse() { glBindVertexArray(0); }
 };
 
+/*
+ * Vertex attributes and indices which are uploaded once and can be drawn by
+ * any number of meshes, each with its own vertex array
+ */
+class MeshGeometry {
+  std::vector<VertexAttribute> attributes;
+  ElementBuffer indices;
+
+  bool hasVertexTransform = false;
+  Mat4 vertexTransform;
+
+  std::vector<Meshlet> meshlets;
+
+  Vec3 boundsCenter;
+  float boundsRadius = 0.0f;
+
+public:
+  MeshGeometry(std::vector<GLuint> indexData) {
+    indices.Data(std::move(indexData));
+  }
+
+  /*
+   * Adds an attribute, such as positions or texture coordinates. Must be
+   * called before the geometry is used by a mesh
+   */
+  void AddAttribute(VertexAttribute attribute) {
+    attributes.push_back(std::move(attribute));
+  }
+
+  /*
+   * A transform applied to vertices before the model transform, such as the
+   * dequantization matrix of a quantized mesh
+   */
+  void SetVertexTransform(const Mat4 &m) {
+    vertexTransform = m;
+    hasVertexTransform = true;
+  }
+  bool HasVertexTransform() const { return hasVertexTransform; }
+  const Mat4 &GetVertexTransform() const { return vertexTransform; }
+
+  /*
+   * Clusters of the geometry's triangles. Meshes drawing geometry with
+   * clusters can cull them each frame with Mesh::Cull. Their bounds are in the
+   * model's space, without the vertex transform
+   */
+  void SetMeshlets(std::vector<Meshlet> m) { meshlets = std::move(m); }
+  const std::vector<Meshlet> &GetMeshlets() const { return meshlets; }
+
+  /*
+   * A sphere containing every vertex, before the vertex transform. A radius
+   * of 0 means the bounds are unknown
+   */
+  void SetBounds(Vec3 center, float radius) {
+    boundsCenter = center;
+    boundsRadius = radius;
+  }
+  const Vec3 &GetBoundsCenter() const { return boundsCenter; }
+  float GetBoundsRadius() const { return boundsRadius; }
+
+  /*
+   * Keeps vertices and indices in RAM after they are uploaded. Has no effect
+   * once uploaded
+   */
+  void KeepData(bool keep);
+
+  /*
+   * Uploads any data which hasn't been uploaded, and sets up the bound vertex
+   * array to use it
+   * @returns false if any of the data could not be uploaded
+   */
+  bool Bind();
+
+  const ElementBuffer &GetIndexBuffer() const { return indices; }
+  const std::vector<VertexAttribute> &GetAttributes() const {
+    return attributes;
+  }
+
+  Residency GetResidency() const;
+};
+
 class Mesh {
-  VertexAttribute vertices;
+  std::shared_ptr<MeshGeometry> geometry;
   VertexArray vao;
-  ElementBuffer indices;
 
   unsigned instanceCount;
 
+  // Set if Setup could not upload the mesh, which is then never drawn
+  bool failed = false;
+
+  // Meshes drawing part of their geometry
+  bool hasRange = false;
+  IndexRange range;
+
+  // The clusters which passed the last Cull, as arguments for
+  // glMultiDrawElements
+  bool culled = false;
+  std::vector<IndexRange> visible;
+  std::vector<GLsizei> visibleCounts;
+  std::vector<const GLvoid *> visibleOffsets;
+
 public:
-  Mesh(const std::vector<GLfloat> &verts, const std::vector<GLuint> &indexData,
+  /*
+   * Totals for every call to Cull. Games may report and reset them each frame
+   */
+  static Meshlets::CullStatistics cullStatistics;
+
+  Mesh(std::vector<GLfloat> verts, std::vector<GLuint> indexData,
+       unsigned _instanceCount);
+
+  /*
+   * Creates a mesh whose vertex attributes are all stored in one buffer
+   */
+  Mesh(InterleavedVertices verts, std::vector<GLuint> indexData,
        unsigned _instanceCount);
 
-  void Setup(std::function<void()> setupFunc);
+  /*
+   * Creates a mesh which draws geometry shared with other meshes
+   */
+  Mesh(std::shared_ptr<MeshGeometry> _geometry, unsigned _instanceCount)
+      : geometry(std::move(_geometry)), instanceCount(_instanceCount) {}
+
+  const std::shared_ptr<MeshGeometry> &GetGeometry() const { return geometry; }
+
+  /*
+   * Draws only part of the geometry's indices, such as one mesh of a model
+   * whose meshes share buffers
+   */
+  void SetRange(const IndexRange &r) {
+    range = r;
+    hasRange = true;
+  }
+  bool HasRange() const { return hasRange; }
+  const IndexRange &GetRange() const { return range; }
+
+  /*
+   * Keeps vertices and indices in RAM after Setup uploads them. Must be called
+   * before Setup
+   */
+  void KeepData(bool keep) { geometry->KeepData(keep); }
+
+  /*
+   * Vertex data kept by KeepData. Positions are only available for meshes
+   * which don't use interleaved vertices
+   */
+  const std::vector<GLuint> &GetIndices() const {
+    return geometry->GetIndexBuffer().GetData();
+  }
+  const std::vector<GLfloat> *GetPositions() const;
+
+  /*
+   * Uploads the geometry and sets up the mesh's vertex array
+   * @param setupFunc Sets up extra attributes with the vertex array bound, and
+   * returns false if they could not be uploaded
+   * @returns false if the mesh could not be uploaded, in which case it is
+   * never drawn
+   */
+  bool Setup(std::function<bool()> setupFunc);
+  bool IsFailed() const { return failed; }
+
+  /*
+   * Runs 'updateFunc' with the vertex array bound so that attribute pointers
+   * can be changed after Setup
+   */
+  void UpdateAttributes(std::function<void()> updateFunc);
+
+  /*
+   * Finds which of the geometry's clusters may be visible, so that Draw only
+   * draws those. Has no effect if the geometry has no clusters or the mesh
+   * draws more than one instance
+   * @param mvp The model-view-projection matrix, without the geometry's
+   * vertex transform
+   * @param eye The camera's position in the model's space
+   */
+  void Cull(const Mat4 &mvp, Vec3 eye);
+  bool CanCull() const {
+    return instanceCount == 1 && !geometry->GetMeshlets().empty();
+  }
+
+  unsigned GetInstanceCount() const { return instanceCount; }
+  void SetInstanceCount(unsigned count) { instanceCount = count; }
+
+  /*
+   * @returns the memory used by the mesh's geometry, which may be shared with
+   * other meshes
+   */
+  Residency GetResidency() const { return geometry->GetResidency(); }
 
   void Draw() const;
 };
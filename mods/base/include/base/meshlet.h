@@ -0,0 +1,122 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__MESHLET_H
+#define _BASE__MESHLET_H
+
+#include <base/buffer.h>
+#include <cstddef>
+#include <math/mat.h>
+#include <math/vec.h>
+#include <ostream>
+#include <vector>
+
+/*
+ * A small cluster of a mesh's triangles, stored as a contiguous range of its
+ * indices, with bounds for culling the whole cluster at once
+ */
+struct Meshlet {
+  GLuint firstIndex = 0, indexCount = 0;
+
+  /*
+   * A sphere containing every vertex of the cluster
+   */
+  Vec3 center;
+  float radius = 0.0f;
+
+  /*
+   * Every triangle's normal is within a cone around 'coneAxis'. 'coneCutoff'
+   * is the sine of the cone's half angle, and is 1 when the cone is too wide
+   * for the cluster to ever be entirely back-facing
+   */
+  Vec3 coneAxis;
+  float coneCutoff = 1.0f;
+};
+
+namespace Meshlets {
+/*
+ * 124 triangles and 64 vertices per cluster keep clusters small enough to
+ * cull usefully, while being large enough that the per-cluster cost stays low
+ */
+constexpr const unsigned defaultMaxTriangles = 124, defaultMaxVertices = 64;
+
+/*
+ * Splits triangles into clusters in the order they are drawn, so indices are
+ * left unchanged. Run after MeshOptimizer::OptimizeVertexCache, which keeps
+ * neighbouring triangles close together
+ * @param positions Three floats per vertex
+ */
+std::vector<Meshlet> Build(const std::vector<GLuint> &indices,
+                           const std::vector<GLfloat> &positions,
+                           std::size_t vertexCount,
+                           unsigned maxTriangles = defaultMaxTriangles,
+                           unsigned maxVertices = defaultMaxVertices);
+
+/*
+ * The planes of a view frustum. Points inside have positive distance to
+ * every plane
+ */
+struct Frustum {
+  // a, b, c and d of each plane's equation ax + by + cz + d = 0
+  float planes[6][4];
+
+  /*
+   * Extracts the planes from a model-view-projection matrix, so they are in
+   * the model's space
+   */
+  static Frustum FromMatrix(const Mat4 &mvp);
+
+  bool Intersects(Vec3 center, float radius) const;
+};
+
+/*
+ * @param eye The camera's position in the model's space
+ * @returns whether every triangle in the cluster faces away from the camera
+ */
+bool IsBackFacing(const Meshlet &meshlet, Vec3 eye);
+
+struct CullStatistics {
+  std::size_t clusters = 0, frustumCulled = 0, backFacing = 0;
+  std::size_t triangles = 0, trianglesDrawn = 0;
+
+  CullStatistics &operator+=(const CullStatistics &other);
+};
+
+std::ostream &operator<<(std::ostream &os, const CullStatistics &stats);
+
+/*
+ * Finds the clusters which may be visible. Neighbouring visible clusters are
+ * merged into a single range
+ * @param mvp The model-view-projection matrix the mesh is drawn with
+ * @param eye The camera's position in the model's space
+ * @param visible Set to the index ranges to draw
+ * @returns the number of clusters and triangles culled
+ */
+CullStatistics Cull(const std::vector<Meshlet> &meshlets, const Mat4 &mvp,
+                    Vec3 eye, std::vector<IndexRange> &visible);
+} // namespace Meshlets
+
+#endif // _BASE__MESHLET_H
@@ -0,0 +1,113 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__MESH_OPTIMIZER_H
+#define _BASE__MESH_OPTIMIZER_H
+
+#include <base/gl.h>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+/*
+ * Functions for reordering indexed triangle lists so that they render faster.
+ * All of them work on triangle lists with indices less than 'vertexCount'
+ */
+namespace MeshOptimizer {
+/*
+ * Number of entries in the modelled post-transform vertex cache. 16 is a
+ * conservative estimate which suits most GPUs
+ */
+constexpr const unsigned defaultCacheSize = 16;
+
+struct VertexCacheStatistics {
+  /*
+   * Average cache miss ratio (vertex shader invocations per triangle, between
+   * 0.5 and 3) and average transform to vertex ratio (invocations per vertex,
+   * 1 at best)
+   */
+  float acmr = 0.0f, atvr = 0.0f;
+};
+
+std::ostream &operator<<(std::ostream &os, const VertexCacheStatistics &stats);
+
+/*
+ * Simulates a FIFO vertex cache of size 'cacheSize' over the triangles
+ */
+VertexCacheStatistics
+AnalyzeVertexCache(const std::vector<GLuint> &indices, std::size_t vertexCount,
+                   unsigned cacheSize = defaultCacheSize);
+
+/*
+ * Reorders triangles to reuse recently transformed vertices, using Tipsify
+ * (Sander, Nehab and Barczak, 2007)
+ */
+void OptimizeVertexCache(std::vector<GLuint> &indices, std::size_t vertexCount,
+                         unsigned cacheSize = defaultCacheSize);
+
+/*
+ * Reorders clusters of triangles so that those facing outwards from the middle
+ * of the mesh are drawn first and occlude the rest. Clusters are split where
+ * the vertex cache is already cold, and the new order is only kept if it
+ * raises ACMR by less than 'threshold' times. Should be run after
+ * OptimizeVertexCache
+ * @param positions Three floats per vertex
+ */
+void OptimizeOverdraw(std::vector<GLuint> &indices,
+                      const std::vector<GLfloat> &positions,
+                      std::size_t vertexCount, float threshold = 1.05f,
+                      unsigned cacheSize = defaultCacheSize);
+
+/*
+ * Renumbers vertices in the order the triangles first use them, so vertex
+ * fetches walk through memory linearly. Unused vertices are dropped
+ * @returns A table giving each old vertex its new index, or ~0u if unused
+ */
+std::vector<GLuint> OptimizeVertexFetch(std::vector<GLuint> &indices,
+                                        std::size_t vertexCount);
+
+/*
+ * Moves vertex data into the order given by a table from OptimizeVertexFetch
+ * @param components The number of values each vertex has in 'data'
+ */
+template <typename T>
+void RemapVertices(std::vector<T> &data, std::size_t components,
+                   const std::vector<GLuint> &remap) {
+  std::size_t newCount = 0;
+  for (auto index : remap)
+    if (index != ~0u) newCount++;
+
+  std::vector<T> remapped(newCount * components);
+  for (std::size_t i = 0; i < remap.size(); i++) {
+    if (remap[i] == ~0u) continue;
+    for (std::size_t c = 0; c < components; c++)
+      remapped[remap[i] * components + c] = data[i * components + c];
+  }
+  data = std::move(remapped);
+}
+} // namespace MeshOptimizer
+
+#endif // _BASE__MESH_OPTIMIZER_H
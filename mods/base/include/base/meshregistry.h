@@ -0,0 +1,82 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__MESH_REGISTRY_H
+#define _BASE__MESH_REGISTRY_H
+
+#include <base/mesh.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Geometry shared between every mesh loaded with the same key, which should
+ * include the path and every import option which changes the data. The
+ * registry does not keep geometry alive - it is freed once the last mesh using
+ * it is destroyed
+ */
+class MeshRegistry {
+  std::unordered_map<std::string, std::weak_ptr<MeshGeometry>> meshes;
+
+public:
+  /*
+   * @returns the geometry registered under 'key', or nullptr if there is none
+   * or it has been freed
+   */
+  std::shared_ptr<MeshGeometry> Find(const std::string &key) const;
+
+  void Register(const std::string &key,
+                const std::shared_ptr<MeshGeometry> &geometry) {
+    meshes[key] = geometry;
+  }
+
+  /*
+   * Gets the geometry registered under 'key', calling 'load' to create it if
+   * necessary
+   * @param load Function returning a std::shared_ptr<MeshGeometry>, which may
+   * be null if loading fails
+   */
+  template <typename Loader>
+  std::shared_ptr<MeshGeometry> Get(const std::string &key, Loader load) {
+    if (auto geometry = Find(key)) return geometry;
+
+    std::shared_ptr<MeshGeometry> geometry = load();
+    if (geometry) Register(key, geometry);
+    return geometry;
+  }
+
+  /*
+   * Removes entries whose geometry has been freed
+   */
+  void Prune();
+
+  /*
+   * @returns the number of meshes still in use
+   */
+  std::size_t Size() const;
+};
+
+#endif // _BASE__MESH_REGISTRY_H
@@ -0,0 +1,76 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__MIPMAP_H
+#define _BASE__MIPMAP_H
+
+#include <base/image.h>
+#include <cstddef>
+#include <vector>
+
+namespace Mipmaps {
+/*
+ * @returns the number of levels in a full mip chain for an image of the given
+ * size, including the image itself
+ */
+unsigned LevelCount(IVec2 size);
+
+/*
+ * @returns the number of bytes used by a full chain of RGBA levels, including
+ * the base level
+ */
+std::size_t ChainBytes(IVec2 size);
+
+/*
+ * @returns the size of a level of an image's mip chain
+ */
+IVec2 LevelSize(IVec2 size, unsigned level);
+
+/*
+ * Chooses the finest level needed to draw an image at a size on screen, so
+ * that a texel of the level covers at least a pixel
+ * @param pixels The size the image's larger side covers on screen. Sizes of 0
+ * or less are unknown, and choose the base level
+ * @param bias Added to the level before it is rounded down. Positive values
+ * choose blurrier levels
+ * @returns a level of the image's chain
+ */
+unsigned LevelForSize(IVec2 size, float pixels, float bias = 0.0f);
+
+/*
+ * Halves an RGBA image with a 2x2 box filter. Colour channels are averaged in
+ * linear space, since averaging sRGB values darkens the result, while alpha
+ * is averaged directly. Odd edges reuse the last row or column
+ */
+RawImage Downsample(const RawImage &image);
+
+/*
+ * @returns every level below the base image, down to 1x1
+ */
+std::vector<RawImage> BuildChain(const RawImage &image);
+} // namespace Mipmaps
+
+#endif // _BASE__MIPMAP_H
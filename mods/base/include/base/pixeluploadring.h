@@ -0,0 +1,151 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__PIXEL_UPLOAD_RING_H
+#define _BASE__PIXEL_UPLOAD_RING_H
+
+#include <atomic>
+#include <base/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+
+/*
+ * Staging memory for texture uploads, in a persistently mapped pixel unpack
+ * buffer used as a ring. Worker threads allocate space and copy pixels into
+ * it, and the main thread then uploads textures from the buffer, so the
+ * driver copies from GPU visible memory without stalling the main thread.
+ *
+ * A fence guards each allocation once it is submitted, and its space is reused
+ * after the GPU has finished reading it. Allocations are reclaimed in order,
+ * so one which is held for a long time stops the ring from wrapping past it.
+ *
+ * Needs ARB_buffer_storage. Without it, or when the ring is full, allocations
+ * are empty and callers should upload from their own memory instead
+ */
+class PixelUploadRing {
+public:
+  struct Allocation {
+    std::uint64_t id = 0;
+
+    // Offset of the allocation within the buffer, which uploads read from
+    std::size_t offset = 0, size = 0;
+    unsigned char *data = nullptr;
+
+    explicit operator bool() const { return data != nullptr; }
+
+    /*
+     * @returns the pointer to pass to an upload reading from 'at' bytes into
+     * the allocation while the ring is bound
+     */
+    const GLvoid *Source(std::size_t at = 0) const {
+      return reinterpret_cast<const GLvoid *>(offset + at);
+    }
+  };
+
+  // Allocations may be made from several threads at once
+  struct Statistics {
+    std::atomic<unsigned> staged{0}, full{0};
+    std::atomic<std::size_t> bytesStaged{0};
+  };
+
+private:
+  struct Block {
+    std::uint64_t id;
+    std::size_t offset, size;
+    GLsync fence = nullptr;
+
+    // Set once the block is submitted or released
+    bool done = false;
+  };
+
+  GLuint ID = 0;
+  unsigned char *data = nullptr;
+  std::size_t capacity = 0;
+
+  // Guards the blocks, which are kept in the order they were allocated
+  std::mutex mutex;
+  std::deque<Block> blocks;
+  std::size_t head = 0;
+  std::uint64_t nextID = 1;
+
+  void Finish(const Allocation &allocation, GLsync fence);
+
+public:
+  Statistics statistics;
+
+  /*
+   * Creates and maps the buffer. Must be called on the main thread
+   * @param capacity Size of the buffer in bytes, which limits the largest
+   * texture that can be staged
+   */
+  explicit PixelUploadRing(std::size_t capacity = 64 * 1024 * 1024);
+  PixelUploadRing(const PixelUploadRing &) = delete;
+  PixelUploadRing &operator=(const PixelUploadRing &) = delete;
+  ~PixelUploadRing();
+
+  bool IsAvailable() const { return data != nullptr; }
+
+  /*
+   * Reserves space for pixels. May be called from any thread
+   * @returns an empty allocation if the ring is unavailable or doesn't have
+   * enough free space
+   */
+  Allocation Allocate(std::size_t bytes);
+
+  /*
+   * Binds the buffer as the pixel unpack buffer, so that uploads read from it
+   */
+  void Bind() const { glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID); }
+  static void Unbind() { glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); }
+
+  /*
+   * Fences an allocation after the uploads reading from it have been issued,
+   * so that its space is reused once they complete. Must be called on the
+   * main thread
+   */
+  void Submit(const Allocation &allocation);
+
+  /*
+   * Frees an allocation which won't be uploaded. May be called from any thread
+   */
+  void Release(const Allocation &allocation) { Finish(allocation, nullptr); }
+
+  /*
+   * Reuses the space of allocations which the GPU has finished reading,
+   * without waiting. Must be called on the main thread, such as once a frame
+   */
+  void Reclaim();
+
+  static PixelUploadRing *active;
+};
+
+std::ostream &operator<<(std::ostream &os,
+                         const PixelUploadRing::Statistics &stats);
+
+#endif // _BASE__PIXEL_UPLOAD_RING_H
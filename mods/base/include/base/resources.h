@@ -28,13 +28,99 @@ SOFTWARE.
 #define _BASE__RESOURCES_H
 
 #include <memory>
+#include <base/bufferarena.h>
+#include <base/meshregistry.h>
 #include <base/texture.h>
+#include <base/texturestreamer.h>
 #include <base/shader.h>
+#include <base/shadervariants.h>
 #include <core/mapping.h>
 
+/*
+ * Loads shaders through the active resources' variant cache, so that named
+ * shaders with identical settings share one program
+ */
+struct ShaderVariantLoader {
+  static void Load(std::shared_ptr<Shader> &value,
+                   const Shader::Settings &settings);
+};
+
+/*
+ * Streams textures through the active AssetStreamer if there is one, so that
+ * they are decoded in the background and drawn with a placeholder meanwhile.
+ * Textures with 'streaming' set are loaded by the active TextureStreamer
+ */
+struct TextureStreamLoader {
+  static void Load(std::shared_ptr<Texture> &value,
+                   const TextureSettings &settings);
+};
+
 struct Resources {
-  JSONDeferredReadMapping<std::shared_ptr<Texture>, TextureSettings> textures;
-  JSONDeferredReadMapping<std::shared_ptr<Shader>, Shader::Settings> shaders;
+  /*
+   * Declared first so that the arenas are destroyed after every mesh and
+   * buffer below
+   */
+  BufferArenas bufferArenas;
+
+  Resources() { BufferArenas::active = &bufferArenas; }
+  ~Resources() {
+    if (BufferArenas::active == &bufferArenas) BufferArenas::active = nullptr;
+  }
+  Resources(const Resources &) = delete;
+  Resources &operator=(const Resources &) = delete;
+
+  JSONDeferredReadMapping<std::shared_ptr<Texture>, TextureSettings,
+                          std::hash<std::string>, TextureStreamLoader>
+      textures;
+  JSONDeferredReadMapping<std::shared_ptr<Shader>, Shader::Settings,
+                          std::hash<std::string>, ShaderVariantLoader>
+      shaders;
+
+  ShaderVariants shaderVariants;
+
+  /*
+   * Meshes loaded by path, so that every user of a mesh shares its buffers
+   */
+  MeshRegistry meshes;
+
+  /*
+   * Gets a variant of a named shader with extra definitions, compiling it if
+   * necessary
+   * @param name The name of the base shader in 'shaders'
+   * @param definitions Definitions to add to the base shader's definitions
+   * @returns the variant
+   */
+  std::shared_ptr<Shader>
+  GetShaderVariant(const std::string &name,
+                   const Shader::Definitions &definitions);
+
+  /*
+   * Submits a list of variants for compilation ahead of time
+   * @param requests The variants a scene will need
+   */
+  void WarmUpShaderVariants(const std::vector<ShaderVariantRequest> &requests);
+
+  /*
+   * Submits every shader which hasn't been loaded yet for compilation, without
+   * waiting for the results. Each shader is resolved the first time it is
+   * used, so other loading can happen while the driver compiles
+   * @returns false if any shader's files could not be read
+   */
+  bool SubmitShaders();
+
+  /*
+   * Waits for all submitted shaders to finish compiling
+   */
+  void ResolveShaders();
+
+  /*
+   * Loads every texture marked for packing which hasn't been loaded yet, as
+   * layers of texture arrays. Textures are grouped by size and sampling
+   * settings. Call after reading the textures and before the scene which uses
+   * them
+   * @returns the number of arrays created
+   */
+  unsigned PackTextures();
 
   static Resources *active;
 };
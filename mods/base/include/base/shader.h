@@ -27,11 +27,26 @@ SOFTWARE.
 #ifndef _BASE__SHADER_H
 #define _BASE__SHADER_H
 
+#include <algorithm>
 #include <base/gl.h>
+#include <base/stringhash.h>
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <math/mat.h>
 #include <math/vec.h>
+#include <ostream>
 #include <unordered_map>
+#include <vector>
+
+/*
+ * When enabled, each shader keeps a copy of the values its uniforms were last
+ * set to, and skips uploads which would not change them. Define as 0 to always
+ * upload
+ */
+#ifndef SHADER_SHADOW_UNIFORMS
+#define SHADER_SHADOW_UNIFORMS 1
+#endif
 
 /*
  * Class for loading and using a GLSL shader
@@ -48,6 +63,66 @@ class Shader {
    */
   static Shader *current;
 
+  /*
+   * Copy of the value last uploaded to a uniform location, used to skip
+   * uploads which wouldn't change anything
+   */
+  struct UniformShadow {
+    bool valid = false;
+    alignas(GLfloat) unsigned char value[sizeof(GLfloat) * 16];
+
+    /*
+     * Records a new value for the uniform
+     * @returns true if the value differs from the one previously recorded
+     */
+    bool Update(const void *data, std::size_t size) {
+      if (size > sizeof(value)) {
+        valid = false;
+        return true;
+      }
+      if (valid && std::memcmp(value, data, size) == 0) return false;
+      std::memcpy(value, data, size);
+      valid = true;
+      return true;
+    }
+  };
+
+  /*
+   * Locations of every active uniform in the linked program, keyed by the hash
+   * of the uniform's name. Filled once after linking so that looking up a
+   * uniform never requires a round-trip to the driver
+   */
+  std::unordered_map<StringHash, GLint> uniformLocations;
+
+#if SHADER_SHADOW_UNIFORMS
+  /*
+   * Shadow copies of uniform values, indexed by location
+   */
+  std::vector<UniformShadow> shadows;
+#endif
+
+  /*
+   * Queries the linked program for its active uniforms and fills
+   * 'uniformLocations'
+   */
+  void CacheUniformLocations();
+
+  /*
+   * Whether the program has been submitted for compilation but not resolved
+   */
+  bool compiling = false;
+
+  /*
+   * State kept between submitting a program and resolving it
+   */
+  struct {
+    GLuint vertexShaderID = 0, fragmentShaderID = 0;
+    StringHash cacheKey = 0;
+
+    // Time spent issuing the compile and link calls
+    double seconds = 0.0;
+  } pending;
+
 public:
   using Definitions = std::unordered_map<std::string, std::string>;
 
@@ -56,6 +131,24 @@ public:
     Shader::Definitions definitions;
   };
 
+private:
+  /*
+   * The settings the shader was last submitted with
+   */
+  Settings settings;
+
+public:
+
+  /*
+   * Counts of uniform uploads made and skipped by all shaders. Uploads are only
+   * skipped when SHADER_SHADOW_UNIFORMS is enabled
+   */
+  struct UniformStatistics {
+    unsigned long uploads = 0, skipped = 0;
+  };
+
+  static UniformStatistics uniformStatistics;
+
   struct Uniform {
 #ifdef NDEBUG
     Uniform() = default;
@@ -73,166 +166,211 @@ assert(owner == Shader::Current());
 
     void Set(GLfloat v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLfloat value[] = {v};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform1f(location, v);
     }
 
     void Set(Vec2 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLfloat value[] = {v.x, v.y};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform2f(location, v.x, v.y);
     }
 
     void Set(Vec3 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLfloat value[] = {v.x, v.y, v.z};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform3f(location, v.x, v.y, v.z);
     }
 
     void Set(Vec4 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLfloat value[] = {v.x, v.y, v.z, v.w};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform4f(location, v.x, v.y, v.z, v.w);
     }
 
     void Set(GLint v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLint value[] = {v};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform1i(location, v);
     }
 
     void Set(IVec2 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLint value[] = {v.x, v.y};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform2i(location, v.x, v.y);
     }
 
     void Set(IVec3 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLint value[] = {v.x, v.y, v.z};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform3i(location, v.x, v.y, v.z);
     }
 
     void Set(IVec4 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLint value[] = {v.x, v.y, v.z, v.w};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform4i(location, v.x, v.y, v.z, v.w);
     }
 
     void Set(GLuint v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLuint value[] = {v};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform1ui(location, v);
     }
 
     void Set(UVec2 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLuint value[] = {v.x, v.y};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform2ui(location, v.x, v.y);
     }
 
     void Set(UVec3 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLuint value[] = {v.x, v.y, v.z};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform3ui(location, v.x, v.y, v.z);
     }
 
     void Set(UVec4 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      const GLuint value[] = {v.x, v.y, v.z, v.w};
+      if (Unchanged(value, sizeof(value))) return;
       glUniform4ui(location, v.x, v.y, v.z, v.w);
     }
 
     void Set1(GLsizei count, const GLfloat *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLfloat) * 1, count)) return;
       glUniform1fv(location, count, v);
     }
 
     void Set2(GLsizei count, const GLfloat *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLfloat) * 2, count)) return;
       glUniform2fv(location, count, v);
     }
 
     void Set3(GLsizei count, const GLfloat *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLfloat) * 3, count)) return;
       glUniform3fv(location, count, v);
     }
 
     void Set4(GLsizei count, const GLfloat *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLfloat) * 4, count)) return;
       glUniform4fv(location, count, v);
     }
 
     void Set1(GLsizei count, const GLint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLint) * 1, count)) return;
       glUniform1iv(location, count, v);
     }
 
     void Set2(GLsizei count, const GLint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLint) * 2, count)) return;
       glUniform2iv(location, count, v);
     }
 
     void Set3(GLsizei count, const GLint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLint) * 3, count)) return;
       glUniform3iv(location, count, v);
     }
 
     void Set4(GLsizei count, const GLint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLint) * 4, count)) return;
       glUniform4iv(location, count, v);
     }
 
     void Set1(GLsizei count, const GLuint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLuint) * 1, count)) return;
       glUniform1uiv(location, count, v);
     }
 
     void Set2(GLsizei count, const GLuint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLuint) * 2, count)) return;
       glUniform2uiv(location, count, v);
     }
 
     void Set3(GLsizei count, const GLuint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLuint) * 3, count)) return;
       glUniform3uiv(location, count, v);
     }
 
     void Set4(GLsizei count, const GLuint *v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(v, sizeof(GLuint) * 4, count)) return;
       glUniform4uiv(location, count, v);
     }
 
     void SetMatrix2(GLsizei count, GLboolean transpose, Mat2 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix2fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix3(GLsizei count, GLboolean transpose, Mat3 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix3fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix4(GLsizei count, GLboolean transpose, Mat4 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix4fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix2x3(GLsizei count, GLboolean transpose, Mat2x3 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix2x3fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix3x2(GLsizei count, GLboolean transpose, Mat3x2 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix3x2fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix2x4(GLsizei count, GLboolean transpose, Mat2x4 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix2x4fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix4x2(GLsizei count, GLboolean transpose, Mat4x2 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix4x2fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix3x4(GLsizei count, GLboolean transpose, Mat3x4 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix3x4fv(location, count, transpose, &v[0][0]);
     }
 
     void SetMatrix4x3(GLsizei count, GLboolean transpose, Mat4x3 v) {
       SHADER_UNIFORM_SET_ASSERTS
+      if (Unchanged(&v[0][0], sizeof(v), count, transpose)) return;
       glUniformMatrix4x3fv(location, count, transpose, &v[0][0]);
     }
 
@@ -243,41 +381,144 @@ assert(owner == Shader::Current());
 #endif
     GLint location;
 
+#if SHADER_SHADOW_UNIFORMS
+    /*
+     * The shader whose shadow copies track this uniform. The copies are looked
+     * up by location on each upload, as they are replaced whenever the shader
+     * is linked again
+     */
+    Shader *shader = nullptr;
+
+    /*
+     * Checks whether an upload can be skipped because it would not change the
+     * uniform's value, and records the new value otherwise
+     * @param data The first element being uploaded
+     * @param size The size in bytes of one element
+     * @param count The number of array elements being uploaded
+     * @param transpose Whether matrices are being transposed
+     * @returns true if the upload should be skipped
+     */
+    bool Unchanged(const void *data, std::size_t size, GLsizei count = 1,
+                   GLboolean transpose = GL_FALSE) {
+      if (!shader || location < 0 ||
+          static_cast<std::size_t>(location) >= shader->shadows.size()) {
+        uniformStatistics.uploads++;
+        return false;
+      }
+
+      auto &shadows = shader->shadows;
+      if (count != 1 || transpose) {
+        // Array elements have consecutive locations. Forget what they held
+        // rather than tracking the whole upload
+        auto end = std::min(shadows.size(),
+                            static_cast<std::size_t>(location) +
+                                static_cast<std::size_t>(std::max(count, 0)));
+        for (auto i = static_cast<std::size_t>(location); i < end; i++)
+          shadows[i].valid = false;
+        uniformStatistics.uploads++;
+        return false;
+      }
+
+      if (shadows[location].Update(data, size)) {
+        uniformStatistics.uploads++;
+        return false;
+      }
+      uniformStatistics.skipped++;
+      return true;
+    }
+#else
+    bool Unchanged(const void *, std::size_t, GLsizei = 1,
+                   GLboolean = GL_FALSE) {
+      uniformStatistics.uploads++;
+      return false;
+    }
+#endif // if SHADER_SHADOW_UNIFORMS
+
     friend class Shader;
   };
 
   GLuint ID() const { return id; }
 
   Shader() {}
-  ~Shader() {
-    if (id) glDeleteProgram(id);
-  }
+  ~Shader();
 
+  /*
+   * Loads the shader, waiting for compilation to finish
+   * @param settings The files and definitions to build the shader from
+   * @returns true if the shader was built successfully
+   */
   bool Load(const Settings &settings);
 
   /*
-   * Gets a uniform variable from the shader
-   * @param name The name of the variable
+   * Reads the shader files and starts compiling and linking, without waiting
+   * for the result. Submitting several shaders before resolving any of them
+   * allows the driver to compile them concurrently
+   * @param settings The files and definitions to build the shader from
+   * @returns false if the shader files could not be read
+   */
+  bool Submit(const Settings &settings);
+
+  /*
+   * Waits for a submitted shader to finish compiling and checks the result.
+   * Called automatically the first time the shader is used
+   * @returns true if the shader was built successfully
+   */
+  bool Resolve();
+
+  const Settings &GetSettings() const { return settings; }
+
+  /*
+   * Finds the location of a uniform variable in the shader
+   * @param name The hash of the name of the variable
+   * @returns the location of the uniform, or -1 if the shader has no active
+   * uniform with that name
+   */
+  GLint FindUniform(StringHash name) {
+    if (compiling) Resolve();
+    auto it = uniformLocations.find(name);
+    return it == uniformLocations.end() ? -1 : it->second;
+  }
+
+  bool HasUniform(StringHash name) { return FindUniform(name) != -1; }
+
+  /*
+   * Gets a uniform variable from the shader. Use HashString to compute the
+   * hash of a literal name at compile time
+   * @param name The hash of the name of the variable
    * @returns a handle to the uniform
    */
-  Uniform GetUniform(const std::string &name) {
-    auto loc = glGetUniformLocation(id, name.c_str());
+  Uniform GetUniform(StringHash name) {
+    auto loc = FindUniform(name);
     // If the location is -1, the uniform name is not a uniform variable name in
     // the shader.
     // Structs must be set for each field, and arrays must have each
     // value set individually.
     assert(loc != -1);
 #ifdef NDEBUG
-    return loc;
+    Uniform uniform{loc};
 #else
-    return {loc, this};
+    Uniform uniform{loc, this};
 #endif
+#if SHADER_SHADOW_UNIFORMS
+    if (loc != -1) uniform.shader = this;
+#endif
+    return uniform;
+  }
+
+  /*
+   * Gets a uniform variable from the shader
+   * @param name The name of the variable
+   * @returns a handle to the uniform
+   */
+  Uniform GetUniform(const std::string &name) {
+    return GetUniform(HashString(name));
   }
 
   /*
    * Makes this shader active
    */
   void Use() {
+    if (compiling) Resolve();
     current = this;
     glUseProgram(id);
   }
@@ -293,4 +534,7 @@ struct JSONImpl<Shader::Settings> {
   static void Write(const Shader::Settings &value, JSON::Writer &writer);
 };
 
+std::ostream &operator<<(std::ostream &os,
+                         const Shader::UniformStatistics &stats);
+
 #endif // _BASE__SHADER_H
@@ -0,0 +1,126 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__SHADER_CACHE_H
+#define _BASE__SHADER_CACHE_H
+
+#include <base/gl.h>
+#include <base/stringhash.h>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+/*
+ * Static class for storing linked shader programs on disk with
+ * glGetProgramBinary, so that later runs can skip compiling and linking. Cached
+ * binaries are keyed by the final shader source, the definitions used, and the
+ * GL driver, and are ignored if the driver rejects them
+ */
+class ShaderBinaryCache {
+  /*
+   * As class is static, we don't want to be able to create ShaderBinaryCache
+   * objects
+   */
+  ShaderBinaryCache() = delete;
+
+public:
+  struct Statistics {
+    unsigned hits = 0, misses = 0, rejected = 0;
+
+    /*
+     * Total time spent loading cached binaries, and compiling and linking
+     * programs which were not cached
+     */
+    double hitSeconds = 0.0, missSeconds = 0.0;
+
+    double HitRate() const {
+      auto total = hits + misses;
+      return total ? static_cast<double>(hits) / total : 0.0;
+    }
+
+    /*
+     * Estimates the time saved by the cache, using the average time taken to
+     * build a program which was not cached. Returns 0 if nothing has been
+     * built from source yet
+     */
+    double SecondsSaved() const {
+      if (!misses) return 0.0;
+      return hits * (missSeconds / misses) - hitSeconds;
+    }
+  };
+
+  static Statistics statistics;
+
+  /*
+   * Whether the cache is used. Has no effect if the driver does not support
+   * program binaries
+   */
+  static bool enabled;
+
+  /*
+   * The directory (relative to the build path) cached binaries are stored in
+   */
+  static std::string directory;
+
+  /*
+   * Checks whether the driver can save and load program binaries
+   */
+  static bool Supported();
+
+  /*
+   * Computes the key a program is cached under
+   * @param vertexSource The final source of the vertex shader
+   * @param fragmentSource The final source of the fragment shader
+   * @param definitions The definitions the sources were built with
+   * @returns the key
+   */
+  static StringHash
+  Key(const std::string &vertexSource, const std::string &fragmentSource,
+      const std::unordered_map<std::string, std::string> &definitions);
+
+  /*
+   * Attempts to load a cached binary into a program
+   * @param program The program to load the binary into
+   * @param key The key the binary was stored with
+   * @returns true if the program was loaded and linked successfully
+   */
+  static bool Load(GLuint program, StringHash key);
+
+  /*
+   * Stores the binary of a linked program. The program should have been linked
+   * with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+   * @param program The linked program
+   * @param key The key to store the binary with
+   */
+  static void Store(GLuint program, StringHash key);
+
+  /*
+   * Prints the hit rate and time saved by the cache
+   */
+  static void Report(std::ostream &os);
+};
+
+#endif // _BASE__SHADER_CACHE_H
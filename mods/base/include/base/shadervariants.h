@@ -0,0 +1,108 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__SHADER_VARIANTS_H
+#define _BASE__SHADER_VARIANTS_H
+
+#include <base/shader.h>
+#include <base/stringhash.h>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * A request for a variant of a named shader, built with extra definitions
+ */
+struct ShaderVariantRequest {
+  std::string shader;
+  Shader::Definitions definitions;
+};
+
+template <>
+struct JSONImpl<ShaderVariantRequest> {
+  static void Read(ShaderVariantRequest &out, const JSON::Value &value,
+                   const JSON::ReadData &data);
+  static void Write(const ShaderVariantRequest &value, JSON::Writer &writer);
+};
+
+/*
+ * Cache of shader variants. A variant is a pair of shader files built with a
+ * particular set of definitions. Settings which only differ in the order of
+ * their definitions map to the same variant, so each variant is compiled once
+ * no matter how many times it is requested
+ */
+class ShaderVariants {
+  std::unordered_map<StringHash, std::shared_ptr<Shader>> variants;
+
+  /*
+   * Total number of requests, including ones served from the cache
+   */
+  unsigned requests = 0;
+
+public:
+  /*
+   * Computes the canonical key of a variant
+   * @param settings The files and definitions of the variant
+   * @returns the key
+   */
+  static StringHash Key(const Shader::Settings &settings);
+
+  /*
+   * Gets a variant, submitting it for compilation if it hasn't been requested
+   * before. The shader is resolved the first time it is used
+   * @param settings The files and definitions of the variant
+   * @returns the variant
+   */
+  std::shared_ptr<Shader> Get(const Shader::Settings &settings);
+
+  /*
+   * Gets a variant of a base shader with extra definitions
+   * @param base The files and definitions of the base shader
+   * @param definitions Definitions to add, replacing base definitions with the
+   * same name
+   * @returns the variant
+   */
+  std::shared_ptr<Shader> Get(const Shader::Settings &base,
+                              const Shader::Definitions &definitions);
+
+  /*
+   * The number of distinct variants which have been compiled
+   */
+  std::size_t Size() const { return variants.size(); }
+
+  /*
+   * The number of requests which were served by an existing variant
+   */
+  unsigned Deduplicated() const { return requests - variants.size(); }
+
+  /*
+   * Writes how many variants were compiled and how many requests shared them
+   */
+  void Report(std::ostream &os) const;
+};
+
+#endif // _BASE__SHADER_VARIANTS_H
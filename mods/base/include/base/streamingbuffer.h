@@ -0,0 +1,140 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__STREAMING_BUFFER_H
+#define _BASE__STREAMING_BUFFER_H
+
+#include <array>
+#include <base/gl.h>
+#include <base/gpumemory.h>
+#include <base/vertexlayout.h>
+#include <cstddef>
+#include <vector>
+
+/*
+ * A typed view of memory mapped from a StreamingBuffer
+ */
+template <typename T>
+struct MappedSpan {
+  T *data = nullptr;
+  std::size_t size = 0;
+
+  T *begin() const { return data; }
+  T *end() const { return data + size; }
+
+  T &operator[](std::size_t i) const { return data[i]; }
+
+  bool Empty() const { return size == 0; }
+};
+
+/*
+ * Vertex data which is rewritten every frame. The buffer is split into
+ * 'regionCount' regions so that the CPU can fill one while the GPU is still
+ * reading from the others.
+ *
+ * When ARB_buffer_storage is available, the buffer is mapped persistently and
+ * a fence guards each region. Otherwise the buffer is orphaned on each map,
+ * letting the driver hand back fresh storage without stalling.
+ */
+class StreamingBuffer {
+public:
+  static constexpr const unsigned regionCount = 3;
+
+private:
+  GLuint ID = 0;
+  bool persistent = false;
+
+  // Size in bytes of each region
+  std::size_t regionSize = 0;
+  unsigned region = 0;
+
+  // Bytes recorded with GPUMemory
+  std::size_t reserved = 0;
+
+  std::array<GLsync, regionCount> fences{};
+
+  // Persistently mapped pointer to the start of the whole buffer
+  unsigned char *persistentData = nullptr;
+  bool mapped = false;
+
+  void Allocate(std::size_t bytes);
+  void Release();
+
+  void WaitForRegion(unsigned r);
+
+  // Marks the current region as in use by commands submitted so far
+  void Fence();
+
+public:
+  StreamingBuffer() {}
+  StreamingBuffer(const StreamingBuffer &) = delete;
+  StreamingBuffer &operator=(const StreamingBuffer &) = delete;
+  ~StreamingBuffer() { Release(); }
+
+  /*
+   * Maps the next region, growing the buffer if it is smaller than 'bytes'.
+   * Only waits if the GPU is still reading from that region
+   *
+   * @returns A pointer which may be written to until Unmap is called, or
+   * nullptr if the buffer could not be mapped
+   */
+  void *Map(std::size_t bytes);
+
+  /*
+   * @returns A span of 'count' elements, or an empty span if the buffer could
+   * not be mapped
+   */
+  template <typename T>
+  MappedSpan<T> Map(std::size_t count) {
+    auto data = static_cast<T *>(Map(count * sizeof(T)));
+    return {data, data ? count : 0};
+  }
+
+  /*
+   * Finishes writing to the current region. Draw calls using the region must
+   * be submitted before the next call to Map
+   */
+  void Unmap();
+
+  /*
+   * @returns The offset in bytes of the current region within the buffer
+   */
+  std::size_t Offset() const { return persistent ? region * regionSize : 0; }
+
+  bool IsPersistent() const { return persistent; }
+  std::size_t RegionSize() const { return regionSize; }
+
+  void Use() const { glBindBuffer(GL_ARRAY_BUFFER, ID); }
+
+  /*
+   * Points vertex attributes at the current region. The vertex array to modify
+   * must be bound
+   */
+  void PointAttributes(const std::vector<InterleavedAttribute> &attributes,
+                       GLsizei stride, unsigned instanceDivisor) const;
+};
+
+#endif // _BASE__STREAMING_BUFFER_H
@@ -0,0 +1,82 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__STRING_HASH_H
+#define _BASE__STRING_HASH_H
+
+#include <cstdint>
+#include <string_view>
+
+/*
+ * 64-bit FNV-1a hash of a string. Usable at compile time, so literal names can
+ * be hashed once by the compiler and looked up without building strings.
+ */
+using StringHash = std::uint64_t;
+
+namespace StringHashing {
+constexpr StringHash offsetBasis = 14695981039346656037ull;
+constexpr StringHash prime = 1099511628211ull;
+} // namespace StringHashing
+
+/*
+ * Hashes a string, optionally continuing from a previous hash. Because FNV-1a
+ * is computed one byte at a time, HashString("b", HashString("a")) is equal to
+ * HashString("ab"), which allows names to be built up without allocating.
+ * @param str The string to hash
+ * @param seed The hash to continue from
+ * @returns the hash of the string
+ */
+constexpr StringHash HashString(std::string_view str,
+                                StringHash seed = StringHashing::offsetBasis) {
+  for (auto c : str) {
+    seed ^= static_cast<unsigned char>(c);
+    seed *= StringHashing::prime;
+  }
+  return seed;
+}
+
+/*
+ * Continues a hash with an array subscript, so that for an array name hash h,
+ * HashIndexed(h, 2) is equal to the hash of "name[2]".
+ * @param name The hash of the array name
+ * @param index The index into the array
+ * @returns the hash of the array element's name
+ */
+constexpr StringHash HashIndexed(StringHash name, unsigned index) {
+  char digits[10] = {};
+  unsigned count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + index % 10);
+    index /= 10;
+  } while (index);
+
+  name = HashString("[", name);
+  while (count)
+    name = HashString(std::string_view(&digits[--count], 1), name);
+  return HashString("]", name);
+}
+
+#endif // _BASE__STRING_HASH_H
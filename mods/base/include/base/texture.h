@@ -27,24 +27,198 @@ SOFTWARE.
 #ifndef _BASE__TEXTURE_H
 #define _BASE__TEXTURE_H
 
+#include <base/assetstreamer.h>
+#include <base/blockcompression.h>
 #include <base/gl.h>
+#include <base/gpumemory.h>
 #include <base/image.h>
+#include <base/pixeluploadring.h>
 #include <base/texturesettings.h>
 
+/*
+ * A 2D texture array whose layers are images of the same size, sampled with
+ * the same settings. Textures which are layers of one array are drawn without
+ * binding another texture in between
+ */
+class TextureArray {
+  GLuint id = 0;
+  IVec2 size;
+  unsigned layerCount = 0;
+
+  // Bytes recorded with GPUMemory
+  std::size_t bytes = 0;
+
+public:
+  TextureArray() {}
+  TextureArray(const TextureArray &) = delete;
+  TextureArray &operator=(const TextureArray &) = delete;
+  ~TextureArray();
+
+  /*
+   * @returns the most layers an array can have
+   */
+  static unsigned MaxLayers();
+
+  /*
+   * Uploads each image as a layer, in order
+   * @param layers Images which must all have the same size
+   * @returns false if the images differ in size, or the array would exceed
+   * the texture memory budget
+   */
+  bool Load(const std::vector<const RawImage *> &layers,
+            const TextureSettings &settings);
+
+  GLuint ID() const { return id; }
+  IVec2 Size() const { return size; }
+  unsigned LayerCount() const { return layerCount; }
+};
+
+/*
+ * A texture loaded from an image. Loading from a path prefers the texture
+ * cooked by TextureCache, and falls back to decoding the source image
+ */
 class Texture {
   GLuint id = 0;
   IVec2 size;
 
+  // Bytes recorded with GPUMemory
+  std::size_t bytes = 0;
+
+  AssetState state = AssetState::Ready;
+
+  // Set when the texture is a layer of an array rather than a texture itself
+  std::shared_ptr<TextureArray> array;
+  unsigned layer = 0;
+
+  // Set while a TextureStreamer decides which mip levels are resident
+  bool streamed = false;
+
+  bool Reserve(std::size_t amount);
+
+  // Deletes the texture so that it can be loaded again
+  void Free();
+
+  friend class TextureStreamer;
+
+  // Creates an empty texture with room for 'levelCount' mip levels, which are
+  // uploaded by StreamLevel from the smallest up
+  void BeginStreaming(const TextureSettings &settings, IVec2 size,
+                      unsigned levelCount);
+
+  // Uploads a level and makes it the finest level sampled, copying it through
+  // 'ring' when given one with room. Returns false if the level would exceed
+  // the texture memory budget
+  bool StreamLevel(unsigned level, const RawImage &image,
+                   PixelUploadRing *ring = nullptr);
+  bool StreamLevel(unsigned level, const CompressedLevel &image,
+                   BlockFormat format, PixelUploadRing *ring = nullptr);
+
+  // Frees a level, so that the next level is the finest level sampled
+  void EvictLevel(unsigned level, std::size_t levelBytes);
+
+  // Mip levels which a worker thread copied into a PixelUploadRing
+  struct StagedLevel {
+    IVec2 size;
+    std::size_t offset, bytes;
+  };
+
+  struct Staged {
+    PixelUploadRing::Allocation allocation;
+    std::vector<StagedLevel> levels;
+
+    // The block format of compressed levels, or 0 for RGBA levels
+    GLenum format = 0;
+  };
+
+  // Copies levels into the ring and frees their data. Leaves the levels
+  // untouched and returns an empty allocation if the ring is full
+  template <typename Level>
+  static Staged Stage(PixelUploadRing &ring, const std::vector<Level *> &levels,
+                      GLenum format);
+
+  // Copies the data of one level into the ring and binds it. Returns an empty
+  // allocation, leaving the ring unbound, without a ring or when it is full
+  static PixelUploadRing::Allocation
+  StageLevel(PixelUploadRing *ring, const std::vector<unsigned char> &data);
+
+  // Uploads staged levels from the ring. The allocation is left to the caller
+  // to submit once every texture sharing it has been loaded
+  bool Load(PixelUploadRing &ring, const Staged &staged,
+            const TextureSettings &settings);
+
 public:
   bool Load(const TextureSettings &settings);
-  void Load(const RawImage &raw, const TextureSettings &settings);
+
+  /*
+   * @returns false if the texture would exceed the texture memory budget
+   */
+  bool Load(const RawImage &raw, const TextureSettings &settings);
+
+  /*
+   * Loads the texture with mip levels which have already been built, such as
+   * on another thread
+   * @param mipmaps The levels below 'raw' from Mipmaps::BuildChain, used when
+   * the settings ask for box filtered mipmaps
+   * @returns false if the texture would exceed the texture memory budget
+   */
+  bool Load(const RawImage &raw, const std::vector<RawImage> &mipmaps,
+            const TextureSettings &settings);
+
+  /*
+   * Loads a block compressed texture, uploading its levels directly. Falls
+   * back to decompressing it when the driver doesn't support S3TC
+   * @returns false if the texture would exceed the texture memory budget
+   */
+  bool Load(const CompressedImage &image, const TextureSettings &settings);
 
   void CreateForFramebuffer(IVec2 size);
 
-  ~Texture()
-    { if (id) glDeleteTextures(1, &id); }
+  /*
+   * Makes the texture a view of one layer of an array
+   */
+  void SetLayer(std::shared_ptr<TextureArray> array, unsigned layer);
 
-  GLuint ID() const { return id; }
+  /*
+   * Fills the texture with a single grey pixel until it is replaced by
+   * loading it again, and marks it as loading
+   */
+  void LoadPlaceholder(const TextureSettings &settings);
+
+  /*
+   * Loads the texture on a background thread through an AssetStreamer. The
+   * texture is a placeholder until it has been uploaded. With an active
+   * PixelUploadRing, the worker copies the levels into the ring, and the
+   * upload of every texture sharing the file reads them from there
+   * @param texture The texture to load, which is kept alive until it has been
+   * uploaded
+   */
+  static void Stream(AssetStreamer &streamer,
+                     const std::shared_ptr<Texture> &texture,
+                     const TextureSettings &settings);
+
+  ~Texture();
+
+  AssetState GetState() const { return state; }
+
+  /*
+   * @returns true if a TextureStreamer manages the texture's mip levels
+   */
+  bool IsStreamed() const { return streamed; }
+
+  /*
+   * Binds a texture to a texture unit, unless it is already bound there
+   */
+  static void Bind(unsigned unit, GLenum target, GLuint id);
+  void Bind(unsigned unit) const { Bind(unit, Target(), ID()); }
+
+  bool IsLayer() const { return array != nullptr; }
+  unsigned Layer() const { return layer; }
+  const std::shared_ptr<TextureArray> &GetArray() const { return array; }
+
+  GLenum Target() const {
+    return array ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+  }
+  GLuint ID() const { return array ? array->ID() : id; }
   IVec2 Size() const { return size; }
 };
 
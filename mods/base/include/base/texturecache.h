@@ -0,0 +1,100 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__TEXTURE_CACHE_H
+#define _BASE__TEXTURE_CACHE_H
+
+#include <atomic>
+#include <base/blockcompression.h>
+#include <ostream>
+#include <string>
+
+/*
+ * Static class for storing block compressed textures, cooked ahead of time
+ * from their source images. Cooked textures are KTX files stored next to
+ * their source, holding every mip level, and are used while the size and
+ * modification time of the source are unchanged, or failing that while the
+ * source's contents hash to the same value. The source's details are stored
+ * in the file's "Eris.source" key. Values are stored in the byte order of the
+ * machine which wrote them, as KTX allows
+ */
+class TextureCache {
+  /*
+   * As class is static, we don't want to be able to create TextureCache
+   * objects
+   */
+  TextureCache() = delete;
+
+public:
+  // Textures may be loaded from several threads at once
+  struct Statistics {
+    std::atomic<unsigned> hits{0}, misses{0}, stale{0};
+
+    // Bytes of the cooked textures loaded, and of the RGBA images they replace
+    std::atomic<std::size_t> compressedBytes{0}, uncompressedBytes{0};
+  };
+
+  static Statistics statistics;
+
+  /*
+   * Whether cooked textures are used when loading textures
+   */
+  static bool enabled;
+
+  /*
+   * @param source The path of the source image
+   * @returns the path of the cooked texture for the source
+   */
+  static std::string Path(const std::string &source);
+
+  /*
+   * Loads the cooked texture for a source if it is still up to date
+   * @param source The path of the source image
+   * @param out The image to load into
+   * @returns true if the texture was loaded
+   */
+  static bool Load(const std::string &source, CompressedImage &out);
+
+  /*
+   * Stores a cooked texture
+   * @param source The path of the texture's source image
+   * @param image The compressed texture
+   * @returns true if the texture was written
+   */
+  static bool Store(const std::string &source, const CompressedImage &image);
+
+  /*
+   * Loads a source image, builds its mip chain and compresses it, regardless
+   * of whether it is already cooked
+   * @param source The path of the source image
+   * @returns true if the texture was compressed and written
+   */
+  static bool Bake(const std::string &source);
+
+  static void Report(std::ostream &os);
+};
+
+#endif // _BASE__TEXTURE_CACHE_H
@@ -59,6 +59,13 @@ enum class TextureEnlargeType : GLint {
   Linear = GL_LINEAR
 };
 
+/*
+ * How a texture's smaller mip levels are made. 'BoxFilter' builds them on the
+ * CPU with a gamma-correct filter, so streamed textures build them on a worker
+ * thread, while 'GPU' uses glGenerateMipmap after uploading
+ */
+enum class TextureMipmaps { None, GPU, BoxFilter };
+
 struct TextureSettings {
   TextureSettings() {}
   TextureSettings(TextureType tt, TextureShrinkType tst, TextureEnlargeType tet)
@@ -71,6 +78,35 @@ struct TextureSettings {
   TextureShrinkType shrinkFilter = TextureShrinkType::Linear;
   TextureEnlargeType enlargeFilter = TextureEnlargeType::Linear;
 
+  TextureMipmaps mipmaps = TextureMipmaps::None;
+
+  /*
+   * The maximum anisotropy used when sampling, which keeps textures viewed at
+   * a steep angle sharp. 1 disables anisotropic filtering, and values above
+   * what the driver supports are clamped
+   */
+  float anisotropy = 1.0f;
+
+  /*
+   * Whether Resources::PackTextures may make the texture a layer of a texture
+   * array shared with other textures of the same size and settings
+   */
+  bool pack = false;
+
+  /*
+   * Whether the active TextureStreamer manages which of the texture's mip
+   * levels are resident, uploading finer levels only while they are drawn
+   */
+  bool streaming = false;
+
+  /*
+   * @returns true if the shrink filter samples from mip levels
+   */
+  bool SamplesMipmaps() const {
+    return shrinkFilter != TextureShrinkType::Nearest &&
+           shrinkFilter != TextureShrinkType::Linear;
+  }
+
   static TextureSettings nearest, linear;
 };
 
@@ -0,0 +1,161 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__TEXTURE_STREAMER_H
+#define _BASE__TEXTURE_STREAMER_H
+
+#include <base/texture.h>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Keeps only the mip levels of textures which are needed resident. A streamed
+ * texture starts with just its smallest levels, and finer levels are uploaded
+ * a few at a time once it is drawn large enough on screen to use them. When
+ * the resident levels would exceed the budget, the finest levels no longer
+ * wanted by the textures used least recently are evicted first.
+ *
+ * Every level of a streamed texture is kept in RAM, so that evicted levels
+ * can be uploaded again without reading the file
+ */
+class TextureStreamer {
+public:
+  struct Settings {
+    // Bytes of levels which may be resident at once
+    std::size_t budget = 256 * 1024 * 1024;
+
+    // Levels no larger than this are uploaded straight away and never evicted
+    int residentSize = 64;
+
+    // Added to the level chosen for a texture's size on screen. Positive
+    // values keep textures blurrier in exchange for memory
+    float mipBias = 0.0f;
+
+    // Bytes of levels uploaded in each update
+    std::size_t uploadBytesPerFrame = 4 * 1024 * 1024;
+  };
+
+  struct Statistics {
+    std::size_t residentBytes = 0;
+    unsigned textures = 0;
+
+    // Levels which were requested in the last update but aren't resident
+    unsigned pendingRequests = 0;
+
+    unsigned levelsUploaded = 0, levelsEvicted = 0;
+  };
+
+private:
+  struct Entry {
+    std::weak_ptr<Texture> texture;
+
+    // Either the decoded levels or the cooked levels, from the base level down
+    std::vector<RawImage> levels;
+    CompressedImage cooked;
+    bool compressed = false;
+
+    unsigned levelCount = 0;
+
+    // The finest of the levels which are always resident
+    unsigned tail = 0;
+
+    // The finest resident level
+    unsigned resident = 0;
+
+    // The finest level requested since the last update, and in the last one
+    unsigned requested = 0, target = 0;
+
+    std::size_t bytes = 0;
+    unsigned long lastUsed = 0;
+  };
+
+  std::unordered_map<const Texture *, Entry> entries;
+  std::size_t residentBytes = 0;
+  unsigned long frame = 0;
+
+  static IVec2 LevelSize(const Entry &entry, unsigned level);
+  static std::size_t LevelBytes(const Entry &entry, unsigned level);
+
+  void Begin(const std::shared_ptr<Texture> &texture, Entry entry,
+             const TextureSettings &textureSettings);
+  bool Upload(Entry &entry, unsigned level);
+  void Evict(Entry &entry);
+
+  // @returns the least recently used texture with levels finer than it wants
+  Entry *FindEviction();
+
+public:
+  Settings settings;
+  Statistics statistics;
+
+  TextureStreamer() {}
+  TextureStreamer(const TextureStreamer &) = delete;
+  TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+  /*
+   * Loads a texture whose levels are streamed, preferring the texture cooked
+   * by TextureCache. It is decoded through the active AssetStreamer if there
+   * is one, which the TextureStreamer must outlive, and is a placeholder until
+   * its smallest levels are uploaded
+   */
+  void Load(const std::shared_ptr<Texture> &texture,
+            const TextureSettings &textureSettings);
+
+  /*
+   * Starts streaming a texture, uploading the levels no larger than the
+   * resident size straight away. Images without a full mip chain are loaded
+   * without streaming
+   * @param levels The base level followed by every smaller level
+   */
+  void Add(const std::shared_ptr<Texture> &texture,
+           std::vector<RawImage> levels,
+           const TextureSettings &textureSettings);
+  void Add(const std::shared_ptr<Texture> &texture, CompressedImage image,
+           const TextureSettings &textureSettings);
+
+  /*
+   * Records that a texture is drawn this frame. Has no effect on textures
+   * which aren't streamed
+   * @param pixels The size of the texture on screen, as taken by
+   * Mipmaps::LevelForSize
+   */
+  void Request(const Texture &texture, float pixels);
+
+  /*
+   * Uploads and evicts levels based on the requests since the last update,
+   * and updates the statistics. Call once per frame
+   */
+  void Update();
+
+  static TextureStreamer *active;
+};
+
+std::ostream &operator<<(std::ostream &os,
+                         const TextureStreamer::Statistics &stats);
+
+#endif // _BASE__TEXTURE_STREAMER_H
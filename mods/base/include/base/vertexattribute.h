@@ -29,6 +29,8 @@ SOFTWARE.
 
 #include <base/buffer.h>
 #include <base/gl.h>
+#include <base/vertexlayout.h>
+#include <cstdint>
 #include <math/mat.h>
 #include <memory>
 #include <type_traits>
@@ -36,8 +38,11 @@ SOFTWARE.
 
 class VertexAttribute {
   struct Base {
-    virtual void Setup(unsigned index, unsigned columns,
-                       unsigned instanceDivisor) = 0;
+    virtual bool Upload(unsigned instanceDivisor) = 0;
+    virtual void Point(unsigned index, unsigned columns,
+                       unsigned instanceDivisor) const = 0;
+    virtual void KeepData(bool keep) = 0;
+    virtual Residency GetResidency() const = 0;
     virtual ~Base() {}
   };
 
@@ -51,13 +56,23 @@ class VertexAttribute {
                   "GLfloat, GLuint, GLint or Mat4");
 
     Buffer<T> buf;
-    std::vector<T> data;
 
-    virtual void Setup(unsigned index, unsigned columns,
-                       unsigned instanceDivisor) override {
-      buf.Generate();
-      data.clear();
+    virtual void KeepData(bool keep) override { buf.KeepData(keep); }
+    virtual Residency GetResidency() const override {
+      return buf.GetResidency();
+    }
+
+    virtual bool Upload(unsigned instanceDivisor) override {
+      // Per-instance data is accounted for separately from mesh vertices
+      return buf.Generate(instanceDivisor || std::is_same<T, Mat4>::value
+                       ? MemoryCategory::Instance
+                       : MemoryCategory::Vertex);
+    }
 
+    virtual void Point(unsigned index, unsigned columns,
+                       unsigned instanceDivisor) const override {
+      buf.Use();
+      auto offset = buf.Offset();
       GLenum type;
       if (std::is_same<T, GLfloat>::value)
         type = GL_FLOAT;
@@ -70,7 +85,7 @@ class VertexAttribute {
         for (auto i = 0; i < 4; i++) {
           glEnableVertexAttribArray(index + i);
           glVertexAttribPointer(index + i, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4),
-                                (GLvoid *)(i * rowSize));
+                                (GLvoid *)(offset + i * rowSize));
           
           if (instanceDivisor)
             glVertexAttribDivisor(index + i, instanceDivisor);
@@ -79,29 +94,123 @@ class VertexAttribute {
       }
 
       glEnableVertexAttribArray(index);
-      glVertexAttribPointer(index, columns, type, GL_FALSE, 0, (GLvoid *)0);
+      glVertexAttribPointer(index, columns, type, GL_FALSE, 0,
+                            (GLvoid *)offset);
 
       if (instanceDivisor)
         glVertexAttribDivisor(index, instanceDivisor);
     }
   };
 
+  /*
+   * Several attributes stored in one buffer
+   */
+  struct Interleaved : Base {
+    Buffer<unsigned char> buf;
+    GLsizei stride;
+    std::vector<InterleavedAttribute> attributes;
+
+    virtual void KeepData(bool keep) override { buf.KeepData(keep); }
+    virtual Residency GetResidency() const override {
+      return buf.GetResidency();
+    }
+
+    virtual bool Upload(unsigned instanceDivisor) override {
+      return buf.Generate(instanceDivisor ? MemoryCategory::Instance
+                                   : MemoryCategory::Vertex);
+    }
+
+    virtual void Point(unsigned /* index */, unsigned /* columns */,
+                       unsigned instanceDivisor) const override {
+      buf.Use();
+      for (const auto &attribute : attributes) {
+        glEnableVertexAttribArray(attribute.index);
+        glVertexAttribPointer(
+            attribute.index, attribute.components, attribute.type,
+            attribute.normalized, stride,
+            reinterpret_cast<GLvoid *>(static_cast<std::uintptr_t>(
+                buf.Offset() + attribute.offset)));
+
+        if (instanceDivisor)
+          glVertexAttribDivisor(attribute.index, instanceDivisor);
+      }
+    }
+  };
+
   unsigned index, columns, instanceDivisor;
   std::unique_ptr<Base> data;
+  bool uploaded = false, failed = false;
 
 public:
   template <typename T>
   VertexAttribute(unsigned attrIndex, unsigned _columns, unsigned divisor,
-                  const std::vector<T> &_data) {
+                  std::vector<T> _data) {
     index = attrIndex;
     columns = _columns;
     instanceDivisor = divisor;
     auto d = std::make_unique<Data<T>>();
-    d->buf.Data(_data);
+    d->buf.Data(std::move(_data));
     data = std::move(d);
   }
 
-  void Setup() { data->Setup(index, columns, instanceDivisor); }
+  /*
+   * Creates an attribute which sets up every attribute of interleaved vertex
+   * data from a single buffer
+   */
+  VertexAttribute(InterleavedVertices vertices, unsigned divisor = 0) {
+    index = vertices.attributes.empty() ? 0 : vertices.attributes[0].index;
+    columns = 0;
+    instanceDivisor = divisor;
+    auto d = std::make_unique<Interleaved>();
+    d->buf.Data(std::move(vertices.data));
+    d->stride = vertices.stride;
+    d->attributes = std::move(vertices.attributes);
+    data = std::move(d);
+  }
+
+  /*
+   * Uploads the data if it hasn't been already, and points the attribute of
+   * the bound vertex array at it
+   * @returns false if the data could not be uploaded
+   */
+  bool Setup() {
+    if (!Upload()) return false;
+    Point();
+    return true;
+  }
+
+  /*
+   * @returns false if the memory budget refused the data
+   */
+  bool Upload() {
+    if (!uploaded) {
+      failed = !data->Upload(instanceDivisor);
+      uploaded = true;
+    }
+    return !failed;
+  }
+
+  /*
+   * Points the attribute of the bound vertex array at the uploaded data. Lets
+   * several vertex arrays share the same buffer
+   */
+  void Point() const { data->Point(index, columns, instanceDivisor); }
+
+  /*
+   * Must be called before uploading to keep the data in RAM afterwards
+   */
+  void KeepData(bool keep) { data->KeepData(keep); }
+  Residency GetResidency() const { return data->GetResidency(); }
+
+  /*
+   * @returns the data kept in RAM, or nullptr if the attribute does not hold
+   * separate data of type T
+   */
+  template <typename T>
+  const std::vector<T> *GetData() const {
+    auto d = dynamic_cast<const Data<T> *>(data.get());
+    return d ? &d->buf.GetData() : nullptr;
+  }
 
   unsigned GetIndex() const { return index; }
   unsigned GetColumns() const { return columns; }
@@ -0,0 +1,370 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _BASE__VERTEX_LAYOUT_H
+#define _BASE__VERTEX_LAYOUT_H
+
+#include <algorithm>
+#include <array>
+#include <base/gl.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+/*
+ * Formats vertex attributes can be stored in inside an interleaved vertex
+ * buffer. Each format converts 'inputs' floats per vertex into 'size' bytes,
+ * which the shader sees as 'components' values of GL type 'type'
+ */
+namespace VertexFormats {
+/*
+ * Converts a float to a half precision float, rounding to nearest even
+ */
+inline std::uint16_t ToHalf(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  std::uint32_t sign = (bits >> 16) & 0x8000;
+  std::uint32_t exponent = (bits >> 23) & 0xff;
+  std::uint32_t mantissa = bits & 0x7fffff;
+
+  // Infinity and NaN
+  if (exponent == 0xff)
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+  int halfExponent = static_cast<int>(exponent) - 127 + 15;
+  // Too large - becomes infinity
+  if (halfExponent >= 31) return sign | 0x7c00;
+
+  if (halfExponent <= 0) {
+    // Too small to be represented, even as a subnormal
+    if (halfExponent < -10) return sign;
+    // Subnormal
+    mantissa |= 0x800000;
+    auto shift = static_cast<std::uint32_t>(14 - halfExponent);
+    std::uint32_t half = mantissa >> shift;
+    std::uint32_t remainder = mantissa & ((1u << shift) - 1);
+    std::uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1))) half++;
+    return sign | half;
+  }
+
+  std::uint32_t half = (halfExponent << 10) | (mantissa >> 13);
+  std::uint32_t remainder = mantissa & 0x1fff;
+  // Rounding may carry into the exponent, which is still correct
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) half++;
+  return sign | half;
+}
+
+/*
+ * Converts a half precision float to a float
+ */
+inline float FromHalf(std::uint16_t value) {
+  std::uint32_t sign = (value & 0x8000u) << 16;
+  std::uint32_t exponent = (value >> 10) & 0x1f;
+  std::uint32_t mantissa = value & 0x3ff;
+
+  std::uint32_t bits;
+  if (exponent == 0x1f)
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  else if (exponent != 0)
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  else if (mantissa == 0)
+    bits = sign;
+  else {
+    // Subnormal - normalize it
+    exponent = 127 - 15 + 1;
+    while (!(mantissa & 0x400)) {
+      mantissa <<= 1;
+      exponent--;
+    }
+    bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+  }
+
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+/*
+ * Encodes a unit vector as a point on an octahedron unfolded onto a square,
+ * giving two values in the range [-1, 1]
+ */
+inline void OctEncode(const float *in, float *out) {
+  auto sign = [](float v) { return v >= 0.0f ? 1.0f : -1.0f; };
+  float length = std::abs(in[0]) + std::abs(in[1]) + std::abs(in[2]);
+  if (length == 0.0f) {
+    out[0] = out[1] = 0.0f;
+    return;
+  }
+
+  float x = in[0] / length, y = in[1] / length;
+  if (in[2] < 0.0f) {
+    // Fold the lower half of the octahedron over the upper half
+    float foldedX = (1.0f - std::abs(y)) * sign(x);
+    float foldedY = (1.0f - std::abs(x)) * sign(y);
+    x = foldedX;
+    y = foldedY;
+  }
+  out[0] = x;
+  out[1] = y;
+}
+
+/*
+ * Decodes a unit vector encoded with OctEncode
+ */
+inline void OctDecode(const float *in, float *out) {
+  float x = in[0], y = in[1], z = 1.0f - std::abs(x) - std::abs(y);
+  float t = std::max(-z, 0.0f);
+  x += x >= 0.0f ? -t : t;
+  y += y >= 0.0f ? -t : t;
+
+  float length = std::sqrt(x * x + y * y + z * z);
+  out[0] = x / length;
+  out[1] = y / length;
+  out[2] = z / length;
+}
+
+/*
+ * Packs a value in the range [-1, 1] into a signed normalized integer with
+ * the given number of bits
+ */
+inline std::int32_t ToSNorm(float value, unsigned bits) {
+  auto max = static_cast<float>((1 << (bits - 1)) - 1);
+  return static_cast<std::int32_t>(
+      std::round(std::min(std::max(value, -1.0f), 1.0f) * max));
+}
+
+/*
+ * Packs a value in the range [0, 1] into an unsigned normalized integer with
+ * the given number of bits
+ */
+inline std::uint32_t ToUNorm(float value, unsigned bits) {
+  auto max = static_cast<float>((1u << bits) - 1);
+  return static_cast<std::uint32_t>(
+      std::round(std::min(std::max(value, 0.0f), 1.0f) * max));
+}
+
+template <unsigned Count>
+struct Float {
+  static constexpr unsigned inputs = Count, size = Count * sizeof(GLfloat);
+  static constexpr GLint components = Count;
+  static constexpr GLenum type = GL_FLOAT;
+  static constexpr GLboolean normalized = GL_FALSE;
+
+  static void Pack(const GLfloat *in, unsigned char *out) {
+    std::memcpy(out, in, size);
+  }
+};
+
+using Float2 = Float<2>;
+using Float3 = Float<3>;
+
+/*
+ * Two half precision floats. Suitable for texture coordinates
+ */
+struct Half2 {
+  static constexpr unsigned inputs = 2, size = 2 * sizeof(std::uint16_t);
+  static constexpr GLint components = 2;
+  static constexpr GLenum type = GL_HALF_FLOAT;
+  static constexpr GLboolean normalized = GL_FALSE;
+
+  static void Pack(const GLfloat *in, unsigned char *out) {
+    std::uint16_t values[] = {ToHalf(in[0]), ToHalf(in[1])};
+    std::memcpy(out, values, size);
+  }
+};
+
+/*
+ * Three signed normalized 10 bit values and an unused 2 bit value packed into
+ * 32 bits. Suitable for normals and tangents, which the shader can read as a
+ * vec3
+ */
+struct Int2101010 {
+  static constexpr unsigned inputs = 3, size = sizeof(std::uint32_t);
+  static constexpr GLint components = 4;
+  static constexpr GLenum type = GL_INT_2_10_10_10_REV;
+  static constexpr GLboolean normalized = GL_TRUE;
+
+  static std::uint32_t Encode(const GLfloat *in) {
+    std::uint32_t packed = 0;
+    for (unsigned i = 0; i < 3; i++)
+      packed |= (static_cast<std::uint32_t>(ToSNorm(in[i], 10)) & 0x3ff)
+                << (i * 10);
+    return packed;
+  }
+
+  static void Pack(const GLfloat *in, unsigned char *out) {
+    auto packed = Encode(in);
+    std::memcpy(out, &packed, size);
+  }
+};
+/*
+ * Three unsigned normalized 16 bit values, padded to 8 bytes. Suitable for
+ * positions which have been scaled to the range [0, 1]
+ */
+struct UNorm16x3 {
+  static constexpr unsigned inputs = 3, size = 4 * sizeof(std::uint16_t);
+  static constexpr GLint components = 3;
+  static constexpr GLenum type = GL_UNSIGNED_SHORT;
+  static constexpr GLboolean normalized = GL_TRUE;
+
+  static void Pack(const GLfloat *in, unsigned char *out) {
+    std::uint16_t values[] = {static_cast<std::uint16_t>(ToUNorm(in[0], 16)),
+                              static_cast<std::uint16_t>(ToUNorm(in[1], 16)),
+                              static_cast<std::uint16_t>(ToUNorm(in[2], 16)),
+                              0};
+    std::memcpy(out, values, size);
+  }
+};
+
+/*
+ * A unit vector stored as two signed normalized 16 bit values with OctEncode.
+ * The shader must decode it
+ */
+struct Oct16 {
+  static constexpr unsigned inputs = 3, size = 2 * sizeof(std::int16_t);
+  static constexpr GLint components = 2;
+  static constexpr GLenum type = GL_SHORT;
+  static constexpr GLboolean normalized = GL_TRUE;
+
+  static void Pack(const GLfloat *in, unsigned char *out) {
+    float encoded[2];
+    OctEncode(in, encoded);
+    std::int16_t values[] = {static_cast<std::int16_t>(ToSNorm(encoded[0], 16)),
+                             static_cast<std::int16_t>(ToSNorm(encoded[1], 16))};
+    std::memcpy(out, values, size);
+  }
+};
+} // namespace VertexFormats
+
+/*
+ * Description of a single attribute inside an interleaved vertex buffer
+ */
+struct InterleavedAttribute {
+  GLuint index;
+  GLint components;
+  GLenum type;
+  GLboolean normalized;
+  GLsizei offset;
+};
+
+/*
+ * Vertex data for every attribute of a mesh, stored in a single buffer
+ */
+struct InterleavedVertices {
+  std::vector<unsigned char> data;
+  GLsizei stride = 0;
+  std::vector<InterleavedAttribute> attributes;
+};
+
+/*
+ * An attribute of a vertex layout
+ * @tparam Index The attribute's location in the vertex shader
+ * @tparam Format The format it is stored in, from VertexFormats
+ */
+template <unsigned Index, typename Format_>
+struct VertexLayoutAttribute {
+  static constexpr unsigned index = Index;
+  using Format = Format_;
+};
+
+/*
+ * Compile-time description of an interleaved vertex. Attributes are stored one
+ * after the other in the order given
+ * @tparam Attributes VertexLayoutAttribute types
+ */
+template <typename... Attributes>
+struct VertexLayout {
+  static constexpr std::size_t attributeCount = sizeof...(Attributes);
+
+  static constexpr GLsizei stride = (0 + ... + Attributes::Format::size);
+
+  static constexpr std::array<GLsizei, attributeCount> offsets = [] {
+    std::array<GLsizei, attributeCount> result{};
+    GLsizei offset = 0, i = 0;
+    ((result[i++] = offset, offset += Attributes::Format::size), ...);
+    return result;
+  }();
+
+  /*
+   * Describes the layout's attributes for setting up vertex attribute pointers
+   */
+  static std::vector<InterleavedAttribute> Describe() {
+    return Describe(std::make_index_sequence<attributeCount>{});
+  }
+
+  /*
+   * Packs separate attribute streams into an interleaved buffer
+   * @param sources The data for each attribute, in the order of the layout,
+   * with the number of floats per vertex each format expects. An empty source
+   * is stored as zeros
+   * @param vertexCount The number of vertices
+   * @returns the interleaved vertices
+   */
+  static InterleavedVertices
+  Pack(const std::array<const std::vector<GLfloat> *, attributeCount> &sources,
+       std::size_t vertexCount) {
+    InterleavedVertices result;
+    result.stride = stride;
+    result.attributes = Describe();
+    result.data.resize(vertexCount * stride);
+    PackAll(sources, vertexCount, result.data,
+            std::make_index_sequence<attributeCount>{});
+    return result;
+  }
+
+private:
+  template <std::size_t... I>
+  static std::vector<InterleavedAttribute> Describe(std::index_sequence<I...>) {
+    return {{Attributes::index, Attributes::Format::components,
+             Attributes::Format::type, Attributes::Format::normalized,
+             offsets[I]}...};
+  }
+
+  template <std::size_t... I>
+  static void
+  PackAll(const std::array<const std::vector<GLfloat> *, attributeCount> &sources,
+          std::size_t vertexCount, std::vector<unsigned char> &out,
+          std::index_sequence<I...>) {
+    (PackAttribute<typename Attributes::Format>(*sources[I], offsets[I],
+                                                vertexCount, out),
+     ...);
+  }
+
+  template <typename Format>
+  static void PackAttribute(const std::vector<GLfloat> &source, GLsizei offset,
+                            std::size_t vertexCount,
+                            std::vector<unsigned char> &out) {
+    if (source.size() < vertexCount * Format::inputs) return;
+    for (std::size_t v = 0; v < vertexCount; v++)
+      Format::Pack(&source[v * Format::inputs], &out[v * stride + offset]);
+  }
+};
+
+#endif // _BASE__VERTEX_LAYOUT_H
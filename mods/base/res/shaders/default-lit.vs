@@ -1,6 +1,22 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec2 vertexUV;
+
+#ifdef QUANTIZED_VERTICES
+// Positions are relative to the mesh bounds. MVP already includes the
+// dequantization matrix, but model does not, so that normals are not scaled
+layout(location = 2) in vec2 vertexNormal; // Oct-encoded
+uniform mat4 dequantize;
+
+vec3 OctDecode(vec2 e) {
+  vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0f);
+  n.x += n.x >= 0.0f ? -t : t;
+  n.y += n.y >= 0.0f ? -t : t;
+  return normalize(n);
+}
+#else
 layout(location = 2) in vec3 vertexNormal;
+#endif
 
 out vec3 fragPos;
 out vec2 UV;
@@ -10,7 +26,12 @@ uniform mat4 model;
 
 void main() {
   gl_Position = MVP * vec4(position, 1.0f);
-  fragPos = vec3(model * vec4(position, 1.0f));
   UV = vertexUV;
+#ifdef QUANTIZED_VERTICES
+  fragPos = vec3(model * dequantize * vec4(position, 1.0f));
+  normal = mat3(transpose(inverse(model))) * OctDecode(vertexNormal);
+#else
+  fragPos = vec3(model * vec4(position, 1.0f));
   normal = mat3(transpose(inverse(model))) * vertexNormal;
+#endif
 }
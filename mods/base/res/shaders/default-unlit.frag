@@ -1,12 +1,28 @@
+// Define TEXTURE_ARRAY when the diffuse texture is a layer of a texture array,
+// and INSTANCE_LAYERS as well when each instance chooses its own layer
 in vec2 UV;
+#ifdef INSTANCE_LAYERS
+flat in float layer;
+#endif
 out vec3 color;
 
 struct Material {
+#ifdef TEXTURE_ARRAY
+  sampler2DArray diffuse;
+  float diffuseLayer;
+#else
   sampler2D diffuse;
+#endif
 };
 
 uniform Material material;
 
 void main() {
+#if defined(INSTANCE_LAYERS)
+  color = texture(material.diffuse, vec3(UV, layer)).rgb;
+#elif defined(TEXTURE_ARRAY)
+  color = texture(material.diffuse, vec3(UV, material.diffuseLayer)).rgb;
+#else
   color = texture(material.diffuse, UV).rgb;
+#endif
 }
@@ -1,6 +1,10 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec2 vertexUV;
 layout(location = 3) in mat4 offset;
+#ifdef INSTANCE_LAYERS
+layout(location = 7) in float instanceLayer;
+flat out float layer;
+#endif
 
 out vec2 UV;
 uniform mat4 VP;
@@ -8,4 +12,7 @@ uniform mat4 VP;
 void main() {
   gl_Position = VP * offset * vec4(position, 1);
   UV = vertexUV;
+#ifdef INSTANCE_LAYERS
+  layer = instanceLayer;
+#endif
 }
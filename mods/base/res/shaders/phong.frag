@@ -1,4 +1,5 @@
-// Constants MAX_DIR_LIGHTS and MAX_POINT_LIGHTS must be defined
+// Constants MAX_DIR_LIGHTS and MAX_POINT_LIGHTS must be defined. Define
+// TEXTURE_ARRAY when the diffuse texture is a layer of a texture array
 
 out vec4 color;
 
@@ -31,13 +32,24 @@ struct PointLight {
 #endif
 
 struct Material {
+#ifdef TEXTURE_ARRAY
+  sampler2DArray diffuse;
+  float diffuseLayer;
+#else
   sampler2D diffuse;
+#endif
   vec3 specular;
   float shininess;
 };
 
 uniform Material material;
 
+#ifdef TEXTURE_ARRAY
+  #define DIFFUSE texture(material.diffuse, vec3(UV, material.diffuseLayer))
+#else
+  #define DIFFUSE texture(material.diffuse, UV)
+#endif
+
 uniform vec3 cameraLocation;
 #if MAX_DIR_LIGHTS != 0
   uniform DirectionalLight[MAX_DIR_LIGHTS] directionalLights;
@@ -81,7 +93,7 @@ vec3 CalculateDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir
   vec3 reflectDir = reflect(-lightDir, normal);
   float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
 
-  vec3 color = vec3(texture(material.diffuse, UV));
+  vec3 color = vec3(DIFFUSE);
   vec3 ambient = light.ambient * color;
   vec3 diffuse = light.diffuse * diff * color;
   vec3 specular = light.specular * spec;
@@ -102,7 +114,7 @@ vec3 CalculatePointLight(PointLight light, vec3 normal, vec3 pos, vec3 viewDir)
   float attenuation = 1.0f / (light.constant + light.linear * distance
                               + light.quadratic * (distance * distance));
 
-  vec3 color = vec3(texture(material.diffuse, UV));
+  vec3 color = vec3(DIFFUSE);
   vec3 ambient = light.ambient * color;
   vec3 diffuse = light.diffuse * diff * color;
   vec3 specular = light.specular * spec;
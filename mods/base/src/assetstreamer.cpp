@@ -0,0 +1,107 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <assetstreamer.h>
+
+#include <exception>
+#include <iostream>
+
+AssetStreamer *AssetStreamer::active = nullptr;
+
+AssetStreamer::~AssetStreamer() {
+  for (auto &job : jobs) {
+    job.decoded.wait();
+    for (auto &finish : job.finishes) finish(false);
+  }
+}
+
+AssetStreamer::Job *AssetStreamer::FindJob(const std::string &key) {
+  for (auto &job : jobs)
+    if (job.key == key) return &job;
+  return nullptr;
+}
+
+std::size_t AssetStreamer::Upload(Job &job) {
+  bool decoded = false;
+  try {
+    job.decoded.get();
+    decoded = true;
+  } catch (const std::exception &e) {
+    std::cerr << "AssetStreamer: Failed to decode '" << job.key
+              << "': " << e.what() << '\n';
+    statistics.failed++;
+  } catch (...) {
+    std::cerr << "AssetStreamer: Failed to decode '" << job.key << "'\n";
+    statistics.failed++;
+  }
+
+  std::size_t bytes = 0;
+  for (auto &upload : job.uploads) bytes += upload();
+  for (auto &finish : job.finishes) finish(true);
+  if (decoded) statistics.uploaded++;
+  return bytes;
+}
+
+void AssetStreamer::Pump() {
+  using Clock = std::chrono::steady_clock;
+  auto start = Clock::now();
+  std::size_t bytes = 0;
+
+  // Jobs are accessed by index, as uploads may submit more assets
+  for (std::size_t i = 0; i < jobs.size();) {
+    if (bytes >= budget.bytes || Clock::now() - start >= budget.time) {
+      statistics.framesAtBudget++;
+      break;
+    }
+
+    if (jobs[i].decoded.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      i++;
+      continue;
+    }
+
+    auto job = std::move(jobs[i]);
+    jobs.erase(jobs.begin() + i);
+    bytes += Upload(job);
+  }
+  statistics.bytesUploaded += bytes;
+}
+
+void AssetStreamer::Finish() {
+  while (!jobs.empty()) {
+    auto job = std::move(jobs.front());
+    jobs.pop_front();
+    statistics.bytesUploaded += Upload(job);
+  }
+}
+
+std::ostream &operator<<(std::ostream &os,
+                         const AssetStreamer::Statistics &stats) {
+  os << stats.uploaded << " of " << stats.submitted << " assets uploaded, "
+     << stats.failed << " failed to decode, " << stats.bytesUploaded
+     << " bytes, " << stats.framesAtBudget << " frames at the upload budget";
+  return os;
+}
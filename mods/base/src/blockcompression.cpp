@@ -0,0 +1,283 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <blockcompression.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <math/vec.h>
+
+std::size_t CompressedImage::Bytes() const {
+  std::size_t bytes = 0;
+  for (const auto &level : levels) bytes += level.data.size();
+  return bytes;
+}
+
+std::size_t BlockCompression::LevelBytes(BlockFormat format, IVec2 size) {
+  std::size_t blocks = static_cast<std::size_t>((size.x + 3) / 4) *
+                       static_cast<std::size_t>((size.y + 3) / 4);
+  return blocks * (format == BlockFormat::BC1 ? 8 : 16);
+}
+
+BlockFormat BlockCompression::ChooseFormat(const RawImage &image) {
+  for (std::size_t i = 3; i < image.data.size(); i += 4)
+    if (image.data[i] != 255) return BlockFormat::BC3;
+  return BlockFormat::BC1;
+}
+
+namespace {
+using Block = unsigned char[16][4];
+
+// Copies a 4x4 block, repeating the last row and column past the image's edge
+void ReadBlock(const RawImage &image, int blockX, int blockY, Block &out) {
+  for (int y = 0; y < 4; y++)
+    for (int x = 0; x < 4; x++) {
+      int sx = std::min(blockX * 4 + x, image.size.x - 1);
+      int sy = std::min(blockY * 4 + y, image.size.y - 1);
+      const auto *texel =
+          &image.data[(static_cast<std::size_t>(sy) * image.size.x + sx) * 4];
+      std::copy(texel, texel + 4, out[y * 4 + x]);
+    }
+}
+
+void WriteBlock(const Block &block, int blockX, int blockY, RawImage &image) {
+  for (int y = 0; y < 4; y++)
+    for (int x = 0; x < 4; x++) {
+      int dx = blockX * 4 + x, dy = blockY * 4 + y;
+      if (dx >= image.size.x || dy >= image.size.y) continue;
+      auto *texel =
+          &image.data[(static_cast<std::size_t>(dy) * image.size.x + dx) * 4];
+      std::copy(block[y * 4 + x], block[y * 4 + x] + 4, texel);
+    }
+}
+
+std::uint16_t To565(Vec3 c) {
+  auto channel = [](float v, int max) {
+    return static_cast<unsigned>(
+        std::lround(std::min(std::max(v, 0.0f), 255.0f) * max / 255.0f));
+  };
+  return static_cast<std::uint16_t>(channel(c.x, 31) << 11 |
+                                    channel(c.y, 63) << 5 | channel(c.z, 31));
+}
+
+Vec3 From565(std::uint16_t c) {
+  unsigned r = c >> 11 & 31, g = c >> 5 & 63, b = c & 31;
+  return Vec3(float(r << 3 | r >> 2), float(g << 2 | g >> 4),
+              float(b << 3 | b >> 2));
+}
+
+// The four colours a BC1 block's indices select between
+void ColourPalette(std::uint16_t c0, std::uint16_t c1, Vec3 (&out)[4]) {
+  out[0] = From565(c0);
+  out[1] = From565(c1);
+  out[2] = (out[0] * 2.0f + out[1]) / 3.0f;
+  out[3] = (out[0] + out[1] * 2.0f) / 3.0f;
+}
+
+void CompressColour(const Block &block, unsigned char *out) {
+  Vec3 colours[16], mean;
+  for (int i = 0; i < 16; i++) {
+    colours[i] = Vec3(block[i][0], block[i][1], block[i][2]);
+    mean += colours[i] / 16.0f;
+  }
+
+  // The principal axis of the colours, found by power iteration on their
+  // covariance
+  float cov[6] = {};
+  for (const auto &c : colours) {
+    auto d = c - mean;
+    cov[0] += d.x * d.x, cov[1] += d.x * d.y, cov[2] += d.x * d.z;
+    cov[3] += d.y * d.y, cov[4] += d.y * d.z, cov[5] += d.z * d.z;
+  }
+  Vec3 axis(1.0f, 1.0f, 1.0f);
+  for (int i = 0; i < 8; i++) {
+    axis = Vec3(cov[0] * axis.x + cov[1] * axis.y + cov[2] * axis.z,
+                cov[1] * axis.x + cov[3] * axis.y + cov[4] * axis.z,
+                cov[2] * axis.x + cov[4] * axis.y + cov[5] * axis.z);
+    float largest = std::max({std::abs(axis.x), std::abs(axis.y),
+                              std::abs(axis.z)});
+    if (largest == 0.0f) break;
+    axis /= largest;
+  }
+
+  // The colours furthest along the axis, pulled in slightly since the ends of
+  // the line are rarely the best fit
+  float minProj = Vec3::Dot(colours[0], axis), maxProj = minProj;
+  Vec3 minColour = colours[0], maxColour = colours[0];
+  for (const auto &c : colours) {
+    float proj = Vec3::Dot(c, axis);
+    if (proj < minProj) minProj = proj, minColour = c;
+    if (proj > maxProj) maxProj = proj, maxColour = c;
+  }
+  auto inset = (maxColour - minColour) / 32.0f;
+  auto c0 = To565(maxColour - inset), c1 = To565(minColour + inset);
+
+  // c0 > c1 selects four colour mode
+  if (c0 < c1) std::swap(c0, c1);
+
+  std::uint32_t indices = 0;
+  if (c0 != c1) {
+    Vec3 palette[4];
+    ColourPalette(c0, c1, palette);
+    for (int i = 0; i < 16; i++) {
+      unsigned best = 0;
+      float bestError = (colours[i] - palette[0]).SqrLength();
+      for (unsigned p = 1; p < 4; p++) {
+        float error = (colours[i] - palette[p]).SqrLength();
+        if (error < bestError) best = p, bestError = error;
+      }
+      indices |= best << (i * 2);
+    }
+  }
+
+  out[0] = c0 & 0xFF, out[1] = c0 >> 8;
+  out[2] = c1 & 0xFF, out[3] = c1 >> 8;
+  for (int i = 0; i < 4; i++) out[4 + i] = indices >> (i * 8) & 0xFF;
+}
+
+// The eight alphas a BC3 block's alpha indices select between, when a0 > a1
+void AlphaPalette(unsigned a0, unsigned a1, unsigned (&out)[8]) {
+  out[0] = a0;
+  out[1] = a1;
+  if (a0 > a1) {
+    for (unsigned i = 1; i < 7; i++)
+      out[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+  } else {
+    for (unsigned i = 1; i < 5; i++)
+      out[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+    out[6] = 0;
+    out[7] = 255;
+  }
+}
+
+void CompressAlpha(const Block &block, unsigned char *out) {
+  unsigned a0 = block[0][3], a1 = a0;
+  for (int i = 1; i < 16; i++) {
+    a0 = std::max<unsigned>(a0, block[i][3]);
+    a1 = std::min<unsigned>(a1, block[i][3]);
+  }
+
+  std::uint64_t indices = 0;
+  if (a0 != a1) {
+    unsigned palette[8];
+    AlphaPalette(a0, a1, palette);
+    for (int i = 0; i < 16; i++) {
+      unsigned best = 0, bestError = 256;
+      for (unsigned p = 0; p < 8; p++) {
+        unsigned error = palette[p] > block[i][3] ? palette[p] - block[i][3]
+                                                  : block[i][3] - palette[p];
+        if (error < bestError) best = p, bestError = error;
+      }
+      indices |= std::uint64_t{best} << (i * 3);
+    }
+  }
+
+  out[0] = static_cast<unsigned char>(a0);
+  out[1] = static_cast<unsigned char>(a1);
+  for (int i = 0; i < 6; i++) out[2 + i] = indices >> (i * 8) & 0xFF;
+}
+
+void DecompressColour(const unsigned char *in, Block &out) {
+  std::uint16_t c0 = in[0] | in[1] << 8, c1 = in[2] | in[3] << 8;
+  Vec3 palette[4];
+  ColourPalette(c0, c1, palette);
+  std::uint32_t indices = in[4] | in[5] << 8 | in[6] << 16 |
+                          static_cast<std::uint32_t>(in[7]) << 24;
+  for (int i = 0; i < 16; i++) {
+    auto c = palette[indices >> (i * 2) & 3];
+    out[i][0] = static_cast<unsigned char>(std::lround(c.x));
+    out[i][1] = static_cast<unsigned char>(std::lround(c.y));
+    out[i][2] = static_cast<unsigned char>(std::lround(c.z));
+    out[i][3] = 255;
+  }
+}
+
+void DecompressAlpha(const unsigned char *in, Block &out) {
+  unsigned palette[8];
+  AlphaPalette(in[0], in[1], palette);
+  std::uint64_t indices = 0;
+  for (int i = 0; i < 6; i++) indices |= std::uint64_t{in[2 + i]} << (i * 8);
+  for (int i = 0; i < 16; i++)
+    out[i][3] = static_cast<unsigned char>(palette[indices >> (i * 3) & 7]);
+}
+} // namespace
+
+CompressedLevel BlockCompression::Compress(const RawImage &image,
+                                           BlockFormat format) {
+  CompressedLevel level;
+  level.size = image.size;
+  level.data.resize(LevelBytes(format, image.size));
+
+  auto *out = level.data.data();
+  Block block;
+  for (int y = 0; y < (image.size.y + 3) / 4; y++)
+    for (int x = 0; x < (image.size.x + 3) / 4; x++) {
+      ReadBlock(image, x, y, block);
+      if (format == BlockFormat::BC3) {
+        CompressAlpha(block, out);
+        out += 8;
+      }
+      CompressColour(block, out);
+      out += 8;
+    }
+  return level;
+}
+
+CompressedImage BlockCompression::Compress(const RawImage &image,
+                                           const std::vector<RawImage> &mipmaps,
+                                           BlockFormat format) {
+  CompressedImage compressed;
+  compressed.format = format;
+  compressed.levels.reserve(mipmaps.size() + 1);
+  compressed.levels.push_back(Compress(image, format));
+  for (const auto &mipmap : mipmaps)
+    compressed.levels.push_back(Compress(mipmap, format));
+  return compressed;
+}
+
+RawImage BlockCompression::Decompress(const CompressedLevel &level,
+                                      BlockFormat format) {
+  RawImage image;
+  image.size = level.size;
+  image.data.resize(static_cast<std::size_t>(level.size.x) * level.size.y * 4);
+  if (level.data.size() < LevelBytes(format, level.size)) return image;
+
+  const auto *in = level.data.data();
+  Block block;
+  for (int y = 0; y < (level.size.y + 3) / 4; y++)
+    for (int x = 0; x < (level.size.x + 3) / 4; x++) {
+      if (format == BlockFormat::BC3) {
+        DecompressColour(in + 8, block);
+        DecompressAlpha(in, block);
+        in += 16;
+      } else {
+        DecompressColour(in, block);
+        in += 8;
+      }
+      WriteBlock(block, x, y, image);
+    }
+  return image;
+}
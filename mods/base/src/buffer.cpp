@@ -1,8 +1,27 @@
 #include <buffer.h>
+#include <iterator>
 
-void ElementBuffer::Generate() {
-  glGenBuffers(1, &ID);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ID);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(GLuint),
-               data.data(), GL_STATIC_DRAW);
+GLenum ElementBuffer::IndexType(const std::vector<GLuint> &indices) {
+  for (auto index : indices)
+    if (index > 0xffff) return GL_UNSIGNED_INT;
+  return GL_UNSIGNED_SHORT;
+}
+
+bool ElementBuffer::Upload() {
+  if (uploaded) return allocation || count == 0;
+  uploaded = true;
+  count = data.size();
+  type = IndexType(data);
+
+  auto &arena = BufferArena::Get(MemoryCategory::Index);
+  if (type == GL_UNSIGNED_SHORT) {
+    std::vector<GLushort> shortData(std::begin(data), std::end(data));
+    allocation =
+        arena.Allocate(shortData.data(), shortData.size() * sizeof(GLushort));
+  } else {
+    allocation = arena.Allocate(data.data(), data.size() * sizeof(GLuint));
+  }
+  if (!allocation && count) return false;
+  if (!keepData) std::vector<GLuint>().swap(data);
+  return true;
 }
@@ -0,0 +1,135 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <algorithm>
+#include <bufferarena.h>
+#include <cassert>
+#include <iostream>
+
+BufferArena::Allocation &BufferArena::Allocation::
+operator=(Allocation &&other) {
+  if (this == &other) return *this;
+  Reset();
+  arena = other.arena;
+  block = other.block;
+  offset = other.offset;
+  size = other.size;
+  other.arena = nullptr;
+  other.block = nullptr;
+  return *this;
+}
+
+void BufferArena::Allocation::Reset() {
+  if (block) arena->Free(block, offset, size);
+  arena = nullptr;
+  block = nullptr;
+  offset = size = 0;
+}
+
+BufferArena::~BufferArena() {
+  while (!blocks.empty()) ReleaseBlock(blocks.size() - 1);
+}
+
+BufferArena::Block *BufferArena::AddBlock(std::size_t size) {
+  if (!GPUMemory::Reserve(category, size)) return nullptr;
+
+  auto block = std::make_unique<Block>(size);
+  glGenBuffers(1, &block->ID);
+  // Avoid disturbing the buffers bound to the current vertex array
+  glBindBuffer(GL_COPY_WRITE_BUFFER, block->ID);
+  glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+
+  blocks.push_back(std::move(block));
+  return blocks.back().get();
+}
+
+void BufferArena::ReleaseBlock(std::size_t index) {
+  auto &block = blocks[index];
+  GPUMemory::Release(category, block->allocator.Capacity());
+  // The context is gone if GLFW has been terminated
+  if (GLFW::IsSetup()) glDeleteBuffers(1, &block->ID);
+  blocks.erase(blocks.begin() + index);
+}
+
+void BufferArena::Free(Block *block, std::size_t offset, std::size_t size) {
+  auto freed = block->allocator.Free(offset);
+  assert(freed);
+  (void)freed;
+  GPUMemory::RemoveUsed(category, size);
+
+  // Keep one block around so that meshes loaded one after another don't keep
+  // recreating it
+  if (!block->allocator.Empty() || blocks.size() == 1) return;
+  auto it = std::find_if(std::begin(blocks), std::end(blocks),
+                         [block](const auto &b) { return b.get() == block; });
+  assert(it != std::end(blocks));
+  ReleaseBlock(it - std::begin(blocks));
+}
+
+BufferArena::Allocation BufferArena::Allocate(const void *data,
+                                              std::size_t bytes,
+                                              std::size_t alignment) {
+  Block *block = nullptr;
+  std::size_t offset = 0;
+
+  for (auto &b : blocks) {
+    if (auto o = b->allocator.Allocate(bytes, alignment)) {
+      block = b.get();
+      offset = *o;
+      break;
+    }
+  }
+
+  if (!block) {
+    block = AddBlock(std::max(bytes, blockSize));
+    if (!block) return {};
+    offset = *block->allocator.Allocate(bytes, alignment);
+  }
+
+  GPUMemory::AddUsed(category, bytes);
+  if (data) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, block->ID);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, bytes, data);
+  }
+  return {this, block, offset, bytes};
+}
+
+BufferArenas *BufferArenas::active = nullptr;
+
+BufferArena &BufferArena::Get(MemoryCategory category) {
+  assert(BufferArenas::active);
+  return BufferArenas::active->Get(category);
+}
+
+BufferArena &BufferArenas::Get(MemoryCategory category) {
+  switch (category) {
+  case MemoryCategory::Index: return indices;
+  case MemoryCategory::Instance: return instances;
+  default:
+    assert(category == MemoryCategory::Vertex);
+    return vertices;
+  }
+}
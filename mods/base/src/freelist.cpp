@@ -0,0 +1,96 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <freelist.h>
+
+FreeListAllocator::FreeListAllocator(std::size_t _capacity)
+    : capacity(_capacity) {
+  if (capacity) freeRanges.emplace(0, capacity);
+}
+
+std::optional<std::size_t> FreeListAllocator::Allocate(std::size_t size,
+                                                       std::size_t alignment) {
+  assert(alignment != 0);
+  if (size == 0) size = 1;
+
+  for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+    auto [start, rangeSize] = *it;
+    auto aligned = (start + alignment - 1) / alignment * alignment;
+    auto padding = aligned - start;
+    if (rangeSize < padding + size) continue;
+
+    freeRanges.erase(it);
+    // Padding before the aligned offset stays free
+    if (padding) freeRanges.emplace(start, padding);
+    if (rangeSize > padding + size)
+      freeRanges.emplace(aligned + size, rangeSize - padding - size);
+
+    allocations.emplace(aligned, size);
+    used += size;
+    return aligned;
+  }
+
+  return std::nullopt;
+}
+
+bool FreeListAllocator::Free(std::size_t offset) {
+  auto allocation = allocations.find(offset);
+  if (allocation == allocations.end()) return false;
+
+  auto size = allocation->second;
+  allocations.erase(allocation);
+  used -= size;
+
+  auto inserted = freeRanges.emplace(offset, size).first;
+
+  // Merge with the following range
+  auto next = std::next(inserted);
+  if (next != freeRanges.end() &&
+      inserted->first + inserted->second == next->first) {
+    inserted->second += next->second;
+    freeRanges.erase(next);
+  }
+
+  // Merge with the preceding range
+  if (inserted != freeRanges.begin()) {
+    auto previous = std::prev(inserted);
+    if (previous->first + previous->second == inserted->first) {
+      previous->second += inserted->second;
+      freeRanges.erase(inserted);
+    }
+  }
+
+  return true;
+}
+
+std::size_t FreeListAllocator::LargestFreeRange() const {
+  std::size_t largest = 0;
+  for (const auto &range : freeRanges)
+    largest = std::max(largest, range.second);
+  return largest;
+}
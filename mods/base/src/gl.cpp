@@ -40,7 +40,11 @@ bool GLFW::Setup() {
 GLenum GLEW::Setup() {
   glewExperimental = GL_TRUE; // Needed in core profile
   GLenum error = glewInit();
-  if (error == GLEW_OK) Detail::setup = true;
+  if (error != GLEW_OK) return error;
+  Detail::setup = true;
+
+  // Let the driver use as many threads as it likes for compiling shaders
+  if (GLEW_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
   return error;
 }
 
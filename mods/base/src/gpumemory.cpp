@@ -0,0 +1,86 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <gpumemory.h>
+#include <iomanip>
+#include <iostream>
+
+std::array<GPUMemory::Usage, GPUMemory::categoryCount> GPUMemory::usage;
+
+const char *GPUMemory::Name(MemoryCategory category) {
+  switch (category) {
+  case MemoryCategory::Vertex: return "vertex";
+  case MemoryCategory::Index: return "index";
+  case MemoryCategory::Instance: return "instance";
+  case MemoryCategory::Texture: return "texture";
+  }
+  return "unknown";
+}
+
+bool GPUMemory::Reserve(MemoryCategory category, std::size_t bytes) {
+  auto &u = usage[static_cast<std::size_t>(category)];
+  if (!u.Allows(bytes)) {
+    std::cerr << "Allocating " << bytes << " bytes of " << Name(category)
+              << " memory would exceed the budget of " << u.budget
+              << " bytes\n";
+    return false;
+  }
+
+  u.reserved += bytes;
+  return true;
+}
+
+void GPUMemory::Record(MemoryCategory category, std::size_t bytes) {
+  auto &u = usage[static_cast<std::size_t>(category)];
+  if (!u.Allows(bytes))
+    std::cerr << "Allocating " << bytes << " bytes of " << Name(category)
+              << " memory exceeds the budget of " << u.budget << " bytes\n";
+  u.reserved += bytes;
+}
+
+void GPUMemory::Release(MemoryCategory category, std::size_t bytes) {
+  usage[static_cast<std::size_t>(category)].reserved -= bytes;
+}
+
+std::size_t GPUMemory::TotalReserved() {
+  std::size_t total = 0;
+  for (const auto &u : usage) total += u.reserved;
+  return total;
+}
+
+void GPUMemory::Report(std::ostream &os) {
+  constexpr const double mebibyte = 1024.0 * 1024.0;
+  os << "GPU memory:\n" << std::fixed << std::setprecision(2);
+  for (std::size_t i = 0; i < categoryCount; i++) {
+    const auto &u = usage[i];
+    os << "  " << std::left << std::setw(9)
+       << Name(static_cast<MemoryCategory>(i)) << std::right
+       << u.used / mebibyte << " / " << u.reserved / mebibyte << " MiB used";
+    if (u.budget) os << " (budget " << u.budget / mebibyte << " MiB)";
+    os << '\n';
+  }
+  os << "  total    " << TotalReserved() / mebibyte << " MiB reserved\n";
+}
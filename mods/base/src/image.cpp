@@ -27,13 +27,16 @@ SOFTWARE.
 #include <image.h>
 
 #include <cstdio>
-#include <cstring>
 #include <iostream>
 
 #include <core/statics.h>
+#include <core/threadpool.h>
 #include <png.h>
 
 bool RawImage::Load(const std::string &path, bool flip) {
+  size = IVec2{0, 0};
+  data.clear();
+
   // We need to use c-style file reading as libpng accepts a c-style file
   // pointer
   FILE *fp = fopen((::buildPath + path).c_str(), "rb");
@@ -58,10 +61,16 @@ bool RawImage::Load(const std::string &path, bool flip) {
     return false;
   }
 
+  // Rows are decoded straight into 'data', so these are set up before libpng
+  // can jump back here
+  std::vector<png_bytep> rowPointers;
+
   if (setjmp(png_jmpbuf(png))) {
-    std::cerr << "Unable to set jump\n";
+    std::cerr << "Unable to decode image file: " << path << '\n';
     png_destroy_read_struct(&png, &info, NULL);
     fclose(fp);
+    size = IVec2{0, 0};
+    data.clear();
     return false;
   }
 
@@ -94,32 +103,44 @@ bool RawImage::Load(const std::string &path, bool flip) {
 
   png_read_update_info(png, info);
 
-  int rowBytes = png_get_rowbytes(png, info);
-  png_bytep rowPointers[size.y];
+  std::size_t rowBytes = png_get_rowbytes(png, info);
+  if (rowBytes != static_cast<std::size_t>(size.x) * 4) {
+    std::cerr << "Unsupported pixel format in image file: " << path << '\n';
+    png_destroy_read_struct(&png, &info, NULL);
+    fclose(fp);
+    size = IVec2{0, 0};
+    return false;
+  }
 
-  for (int y = 0; y < size.y; y++) rowPointers[y] = new png_byte[rowBytes];
+  // Flipping only changes where each row is written
+  data.resize(rowBytes * size.y);
+  rowPointers.resize(size.y);
+  for (int y = 0; y < size.y; y++) {
+    auto row = flip ? size.y - y - 1 : y;
+    rowPointers[y] = data.data() + rowBytes * row;
+  }
 
-  png_read_image(png, rowPointers);
+  png_read_image(png, rowPointers.data());
 
   png_destroy_read_struct(&png, &info, NULL);
   fclose(fp);
+  return true;
+}
 
-  data.reserve(rowBytes * size.y);
-
-  unsigned char *tmp = data.data();
-
-  if (flip) {
-    for (int i = 0; i < size.y; i++) {
-      auto row = size.y - i - 1;
-      memcpy(tmp + (rowBytes * row), rowPointers[i], rowBytes);
-      delete[] rowPointers[i];
-    }
-  } else {
-    for (int i = 0; i < size.y; i++) {
-      memcpy(tmp + (rowBytes * i), rowPointers[i], rowBytes);
-      delete[] rowPointers[i];
-    }
+std::vector<RawImage> RawImage::LoadMany(const std::vector<std::string> &paths,
+                                         bool flip, ThreadPool *pool) {
+  if (!pool) pool = &ThreadPool::Shared();
+
+  std::vector<RawImage> images(paths.size());
+  std::vector<std::future<void>> decodes;
+  decodes.reserve(paths.size());
+  for (std::size_t i = 0; i < paths.size(); i++) {
+    // Each task writes only to its own image
+    auto *image = &images[i];
+    const auto *path = &paths[i];
+    decodes.push_back(pool->Submit([=] { image->Load(*path, flip); }));
   }
 
-  return true;
+  for (auto &decode : decodes) decode.wait();
+  return images;
 }
@@ -27,32 +27,105 @@ SOFTWARE.
 #include <mesh.h>
 #include <shader.h>
 
-Mesh::Mesh(const std::vector<GLfloat> &verts,
-           const std::vector<GLuint> &indexData,
+void MeshGeometry::KeepData(bool keep) {
+  for (auto &attribute : attributes) attribute.KeepData(keep);
+  indices.KeepData(keep);
+}
+
+bool MeshGeometry::Bind() {
+  bool bound = true;
+  for (auto &attribute : attributes) bound = attribute.Setup() && bound;
+  return indices.Generate() && bound;
+}
+
+Residency MeshGeometry::GetResidency() const {
+  auto residency = indices.GetResidency();
+  for (const auto &attribute : attributes)
+    residency += attribute.GetResidency();
+  return residency;
+}
+
+Mesh::Mesh(std::vector<GLfloat> verts, std::vector<GLuint> indexData,
            unsigned _instanceCount)
-    : vertices(0, 3, 0, verts),
+    : geometry(std::make_shared<MeshGeometry>(std::move(indexData))),
       instanceCount(_instanceCount) {
-  indices.Data(indexData);
+  geometry->AddAttribute({0, 3, 0, std::move(verts)});
 }
 
-void Mesh::Setup(std::function<void()> setupFunc) {
+Mesh::Mesh(InterleavedVertices verts, std::vector<GLuint> indexData,
+           unsigned _instanceCount)
+    : geometry(std::make_shared<MeshGeometry>(std::move(indexData))),
+      instanceCount(_instanceCount) {
+  geometry->AddAttribute(VertexAttribute(std::move(verts)));
+}
+
+const std::vector<GLfloat> *Mesh::GetPositions() const {
+  const auto &attributes = geometry->GetAttributes();
+  for (const auto &attribute : attributes)
+    if (attribute.GetIndex() == 0) return attribute.GetData<GLfloat>();
+  return nullptr;
+}
+
+bool Mesh::Setup(std::function<bool()> setupFunc) {
   // Vertices, Element buffer and passing attribute to vertex shader
   vao.Generate();
   vao.Use();
 
-  vertices.Setup();
+  bool bound = geometry->Bind();
+  bound = setupFunc() && bound;
 
-  indices.Generate();
+  VertexArray::ClearUse();
 
-  setupFunc();
+  failed = !bound;
+  if (failed)
+    std::cerr << "Mesh: Out of GPU memory budget, the mesh won't be drawn\n";
+  return bound;
+}
 
+void Mesh::UpdateAttributes(std::function<void()> updateFunc) {
+  vao.Use();
+  updateFunc();
   VertexArray::ClearUse();
 }
 
+Meshlets::CullStatistics Mesh::cullStatistics;
+
+void Mesh::Cull(const Mat4 &mvp, Vec3 eye) {
+  // Instances are drawn with other transforms, which the clusters visible with
+  // this one say nothing about
+  culled = false;
+  if (!CanCull()) return;
+  const auto &meshlets = geometry->GetMeshlets();
+
+  cullStatistics += Meshlets::Cull(meshlets, mvp, eye, visible);
+  culled = true;
+
+  const auto &indices = geometry->GetIndexBuffer();
+  visibleCounts.clear();
+  visibleOffsets.clear();
+  for (const auto &r : visible) {
+    visibleCounts.push_back(r.count);
+    visibleOffsets.push_back(indices.Indices(r.first));
+  }
+}
+
 void Mesh::Draw() const {
+  // Culling only applies to meshes drawn once
+  bool drawCulled = culled && instanceCount == 1;
+  if (failed || instanceCount == 0 || (drawCulled && visible.empty())) return;
+
   vao.Use();
 
-  if (instanceCount == 1)
+  const auto &indices = geometry->GetIndexBuffer();
+  if (drawCulled) {
+    indices.DrawMulti(visibleCounts.data(), visibleOffsets.data(),
+                      visibleCounts.size());
+  } else if (hasRange) {
+    if (instanceCount == 1)
+      indices.DrawRange(range);
+    else
+      indices.DrawRangeInstanced(range, instanceCount);
+  } else if (instanceCount == 1)
     indices.Draw();
   else
     indices.DrawInstanced(instanceCount);
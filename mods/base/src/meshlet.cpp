@@ -0,0 +1,215 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <meshlet.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+Vec3 Position(const std::vector<GLfloat> &positions, GLuint index) {
+  return {positions[index * 3], positions[index * 3 + 1],
+          positions[index * 3 + 2]};
+}
+
+void ComputeBounds(Meshlet &meshlet, const std::vector<GLuint> &indices,
+                   const std::vector<GLfloat> &positions) {
+  auto begin = indices.begin() + meshlet.firstIndex;
+  auto end = begin + meshlet.indexCount;
+
+  Vec3 min = Position(positions, *begin), max = min;
+  for (auto it = begin; it != end; ++it) {
+    auto p = Position(positions, *it);
+    min = Vec3::Min(min, p);
+    max = Vec3::Max(max, p);
+  }
+  meshlet.center = (min + max) * 0.5f;
+  meshlet.radius = 0.0f;
+  for (auto it = begin; it != end; ++it)
+    meshlet.radius = std::max(
+        meshlet.radius,
+        Vec3::Distance(meshlet.center, Position(positions, *it)));
+
+  // Area weighted average of the triangle normals
+  std::vector<Vec3> normals;
+  normals.reserve(meshlet.indexCount / 3);
+  Vec3 sum;
+  for (auto it = begin; it != end; it += 3) {
+    auto a = Position(positions, it[0]), b = Position(positions, it[1]),
+         c = Position(positions, it[2]);
+    auto normal = Vec3::Cross(b - a, c - a);
+    if (normal.SqrLength() == 0.0f) continue;
+    sum += normal;
+    normals.push_back(normal.Normalized());
+  }
+
+  meshlet.coneAxis = sum.Normalized();
+  meshlet.coneCutoff = 1.0f;
+  if (meshlet.coneAxis.SqrLength() == 0.0f) return;
+
+  float minDot = 1.0f;
+  for (const auto &normal : normals)
+    minDot = std::min(minDot, Vec3::Dot(normal, meshlet.coneAxis));
+  // Cones of 90 degrees or more always contain a normal facing the camera
+  if (minDot > 0.0f) meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+} // namespace
+
+std::vector<Meshlet> Meshlets::Build(const std::vector<GLuint> &indices,
+                                     const std::vector<GLfloat> &positions,
+                                     std::size_t vertexCount,
+                                     unsigned maxTriangles,
+                                     unsigned maxVertices) {
+  std::vector<Meshlet> meshlets;
+  if (indices.empty()) return meshlets;
+
+  // The meshlet each vertex was last added to, plus one
+  std::vector<unsigned> lastMeshlet(vertexCount, 0);
+  Meshlet current;
+  unsigned vertices = 0;
+
+  auto finish = [&] {
+    ComputeBounds(current, indices, positions);
+    meshlets.push_back(current);
+    current = Meshlet{};
+    current.firstIndex =
+        meshlets.back().firstIndex + meshlets.back().indexCount;
+    vertices = 0;
+  };
+
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    auto id = meshlets.size() + 1;
+    unsigned newVertices = 0;
+    for (std::size_t j = 0; j < 3; j++)
+      if (lastMeshlet[indices[i + j]] != id) newVertices++;
+
+    if (current.indexCount / 3 == maxTriangles ||
+        vertices + newVertices > maxVertices) {
+      finish();
+      id = meshlets.size() + 1;
+    }
+
+    for (std::size_t j = 0; j < 3; j++) {
+      if (lastMeshlet[indices[i + j]] != id) {
+        lastMeshlet[indices[i + j]] = id;
+        vertices++;
+      }
+    }
+    current.indexCount += 3;
+  }
+  if (current.indexCount) finish();
+  return meshlets;
+}
+
+Meshlets::Frustum Meshlets::Frustum::FromMatrix(const Mat4 &mvp) {
+  // Matrices are column major, so row r of the matrix is mvp[0..3][r]. Each
+  // plane is the last row plus or minus one of the others (Gribb and
+  // Hartmann, 2001)
+  Frustum frustum;
+  for (int plane = 0; plane < 6; plane++) {
+    int row = plane / 2;
+    float sign = plane % 2 ? -1.0f : 1.0f;
+    for (int column = 0; column < 4; column++)
+      frustum.planes[plane][column] =
+          mvp[column][3] + sign * mvp[column][row];
+
+    auto length = Vec3(frustum.planes[plane][0], frustum.planes[plane][1],
+                       frustum.planes[plane][2])
+                      .Length();
+    if (length == 0.0f) continue;
+    for (auto &value : frustum.planes[plane]) value /= length;
+  }
+  return frustum;
+}
+
+bool Meshlets::Frustum::Intersects(Vec3 center, float radius) const {
+  for (const auto &plane : planes) {
+    auto distance = plane[0] * center.x + plane[1] * center.y +
+                    plane[2] * center.z + plane[3];
+    if (distance < -radius) return false;
+  }
+  return true;
+}
+
+bool Meshlets::IsBackFacing(const Meshlet &meshlet, Vec3 eye) {
+  // Every point of the cluster is within the bounding sphere, so the cluster
+  // faces away if the direction to anywhere in the sphere is within
+  // 90 degrees minus the cone's half angle of the axis
+  auto toCenter = meshlet.center - eye;
+  return Vec3::Dot(toCenter, meshlet.coneAxis) >
+         meshlet.coneCutoff * toCenter.Length() +
+             meshlet.radius * (1.0f + meshlet.coneCutoff);
+}
+
+Meshlets::CullStatistics &Meshlets::CullStatistics::
+operator+=(const CullStatistics &other) {
+  clusters += other.clusters;
+  frustumCulled += other.frustumCulled;
+  backFacing += other.backFacing;
+  triangles += other.triangles;
+  trianglesDrawn += other.trianglesDrawn;
+  return *this;
+}
+
+std::ostream &Meshlets::operator<<(std::ostream &os,
+                                   const CullStatistics &stats) {
+  os << stats.clusters << " clusters (" << stats.frustumCulled
+     << " outside the frustum, " << stats.backFacing << " back-facing), "
+     << stats.trianglesDrawn << " of " << stats.triangles
+     << " triangles drawn";
+  return os;
+}
+
+Meshlets::CullStatistics Meshlets::Cull(const std::vector<Meshlet> &meshlets,
+                                        const Mat4 &mvp, Vec3 eye,
+                                        std::vector<IndexRange> &visible) {
+  CullStatistics stats;
+  stats.clusters = meshlets.size();
+  visible.clear();
+
+  auto frustum = Frustum::FromMatrix(mvp);
+  for (const auto &meshlet : meshlets) {
+    stats.triangles += meshlet.indexCount / 3;
+    if (!frustum.Intersects(meshlet.center, meshlet.radius)) {
+      stats.frustumCulled++;
+      continue;
+    }
+    if (IsBackFacing(meshlet, eye)) {
+      stats.backFacing++;
+      continue;
+    }
+
+    stats.trianglesDrawn += meshlet.indexCount / 3;
+    auto first = static_cast<GLsizei>(meshlet.firstIndex);
+    auto count = static_cast<GLsizei>(meshlet.indexCount);
+    if (!visible.empty() &&
+        visible.back().first + visible.back().count == first)
+      visible.back().count += count;
+    else
+      visible.push_back({first, count, 0});
+  }
+  return stats;
+}
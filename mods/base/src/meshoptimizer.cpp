@@ -0,0 +1,271 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <meshoptimizer.h>
+#include <numeric>
+
+std::ostream &MeshOptimizer::operator<<(std::ostream &os,
+                                        const VertexCacheStatistics &stats) {
+  os << "ACMR " << stats.acmr << ", ATVR " << stats.atvr;
+  return os;
+}
+
+namespace {
+// A FIFO vertex cache, as used by most hardware
+class FIFOCache {
+  std::vector<unsigned> timestamps;
+  unsigned time, cacheSize;
+
+public:
+  FIFOCache(std::size_t vertexCount, unsigned _cacheSize)
+      : timestamps(vertexCount, 0), time(_cacheSize + 1),
+        cacheSize(_cacheSize) {}
+
+  // @returns whether the vertex had to be transformed
+  bool Access(GLuint vertex) {
+    if (time - timestamps[vertex] <= cacheSize) return false;
+    timestamps[vertex] = time++;
+    return true;
+  }
+};
+
+// Triangles each vertex is part of, stored in one array
+struct Adjacency {
+  std::vector<GLuint> offsets, triangles;
+
+  Adjacency(const std::vector<GLuint> &indices, std::size_t vertexCount)
+      : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+    for (auto index : indices) offsets[index + 1]++;
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    auto next = offsets;
+    for (std::size_t i = 0; i < indices.size(); i++)
+      triangles[next[indices[i]]++] = static_cast<GLuint>(i / 3);
+  }
+
+  unsigned Count(GLuint vertex) const {
+    return offsets[vertex + 1] - offsets[vertex];
+  }
+};
+} // namespace
+
+MeshOptimizer::VertexCacheStatistics
+MeshOptimizer::AnalyzeVertexCache(const std::vector<GLuint> &indices,
+                                  std::size_t vertexCount, unsigned cacheSize) {
+  VertexCacheStatistics stats;
+  if (indices.empty() || vertexCount == 0) return stats;
+
+  FIFOCache cache(vertexCount, cacheSize);
+  std::size_t misses = 0;
+  for (auto index : indices)
+    if (cache.Access(index)) misses++;
+
+  stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+  stats.atvr = static_cast<float>(misses) / vertexCount;
+  return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<GLuint> &indices,
+                                        std::size_t vertexCount,
+                                        unsigned cacheSize) {
+  if (indices.empty() || vertexCount == 0) return;
+
+  const auto triangleCount = indices.size() / 3;
+  Adjacency adjacency(indices, vertexCount);
+
+  std::vector<unsigned> liveTriangles(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; v++)
+    liveTriangles[v] = adjacency.Count(static_cast<GLuint>(v));
+
+  std::vector<unsigned> timestamps(vertexCount, 0);
+  unsigned time = cacheSize + 1;
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<GLuint> deadEnds, candidates, result;
+  result.reserve(indices.size());
+
+  // Finds a vertex to continue from when none of the candidates will do
+  std::size_t cursor = 0;
+  auto skipDeadEnd = [&]() -> long {
+    while (!deadEnds.empty()) {
+      auto vertex = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveTriangles[vertex] > 0) return vertex;
+    }
+    for (; cursor < vertexCount; cursor++)
+      if (liveTriangles[cursor] > 0) return static_cast<long>(cursor);
+    return -1;
+  };
+
+  long fanning = skipDeadEnd();
+  while (fanning >= 0) {
+    candidates.clear();
+
+    // Emit every remaining triangle around the fanning vertex
+    auto begin = adjacency.offsets[fanning];
+    auto end = adjacency.offsets[fanning + 1];
+    for (auto i = begin; i < end; i++) {
+      auto triangle = adjacency.triangles[i];
+      if (emitted[triangle]) continue;
+      emitted[triangle] = true;
+
+      for (int corner = 0; corner < 3; corner++) {
+        auto vertex = indices[triangle * 3 + corner];
+        result.push_back(vertex);
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        liveTriangles[vertex]--;
+        if (time - timestamps[vertex] > cacheSize) timestamps[vertex] = time++;
+      }
+    }
+
+    // Prefer the candidate which will stay in the cache the longest while its
+    // remaining triangles are emitted
+    long next = -1;
+    int bestPriority = -1;
+    for (auto vertex : candidates) {
+      if (liveTriangles[vertex] == 0) continue;
+
+      int priority = 0;
+      int age = static_cast<int>(time - timestamps[vertex]);
+      if (age + 2 * static_cast<int>(liveTriangles[vertex]) <=
+          static_cast<int>(cacheSize))
+        priority = age;
+      if (priority > bestPriority) {
+        bestPriority = priority;
+        next = vertex;
+      }
+    }
+
+    fanning = next >= 0 ? next : skipDeadEnd();
+  }
+
+  assert(result.size() == indices.size());
+  indices = std::move(result);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<GLuint> &indices,
+                                     const std::vector<GLfloat> &positions,
+                                     std::size_t vertexCount, float threshold,
+                                     unsigned cacheSize) {
+  const auto triangleCount = indices.size() / 3;
+  if (triangleCount == 0 || positions.size() < vertexCount * 3) return;
+
+  // Start a new cluster wherever a triangle misses the cache for all three of
+  // its vertices, so reordering clusters barely affects cache efficiency
+  std::vector<std::size_t> clusterStarts;
+  FIFOCache cache(vertexCount, cacheSize);
+  for (std::size_t t = 0; t < triangleCount; t++) {
+    int misses = 0;
+    for (int corner = 0; corner < 3; corner++)
+      if (cache.Access(indices[t * 3 + corner])) misses++;
+    if (misses == 3 || t == 0) clusterStarts.push_back(t);
+  }
+  if (clusterStarts.size() < 2) return;
+  clusterStarts.push_back(triangleCount);
+
+  struct Cluster {
+    std::size_t first, last;
+    float centroid[3] = {}, normal[3] = {}, area = 0.0f;
+    float sortKey = 0.0f;
+  };
+
+  std::vector<Cluster> clusters;
+  float meshCentroid[3] = {}, meshArea = 0.0f;
+  for (std::size_t c = 0; c + 1 < clusterStarts.size(); c++) {
+    Cluster cluster;
+    cluster.first = clusterStarts[c];
+    cluster.last = clusterStarts[c + 1];
+
+    for (auto t = cluster.first; t < cluster.last; t++) {
+      const float *p[3];
+      for (int corner = 0; corner < 3; corner++)
+        p[corner] = &positions[indices[t * 3 + corner] * 3];
+
+      float e1[3], e2[3];
+      for (int i = 0; i < 3; i++) {
+        e1[i] = p[1][i] - p[0][i];
+        e2[i] = p[2][i] - p[0][i];
+      }
+      // Twice the area, pointing along the face normal
+      float n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                    e1[2] * e2[0] - e1[0] * e2[2],
+                    e1[0] * e2[1] - e1[1] * e2[0]};
+      float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+      for (int i = 0; i < 3; i++) {
+        cluster.normal[i] += n[i];
+        cluster.centroid[i] += area * (p[0][i] + p[1][i] + p[2][i]) / 3.0f;
+      }
+      cluster.area += area;
+    }
+
+    for (int i = 0; i < 3; i++) meshCentroid[i] += cluster.centroid[i];
+    meshArea += cluster.area;
+    if (cluster.area > 0.0f)
+      for (auto &value : cluster.centroid) value /= cluster.area;
+    clusters.push_back(cluster);
+  }
+  if (meshArea > 0.0f)
+    for (auto &value : meshCentroid) value /= meshArea;
+
+  for (auto &cluster : clusters) {
+    const auto *n = cluster.normal;
+    float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length == 0.0f) continue;
+    for (int i = 0; i < 3; i++)
+      cluster.sortKey +=
+          (cluster.centroid[i] - meshCentroid[i]) * n[i] / length;
+  }
+
+  std::stable_sort(clusters.begin(), clusters.end(),
+                   [](const Cluster &a, const Cluster &b) {
+                     return a.sortKey > b.sortKey;
+                   });
+
+  std::vector<GLuint> reordered;
+  reordered.reserve(indices.size());
+  for (const auto &cluster : clusters)
+    reordered.insert(reordered.end(), indices.begin() + cluster.first * 3,
+                     indices.begin() + cluster.last * 3);
+
+  auto before = AnalyzeVertexCache(indices, vertexCount, cacheSize);
+  auto after = AnalyzeVertexCache(reordered, vertexCount, cacheSize);
+  if (after.acmr <= before.acmr * threshold) indices = std::move(reordered);
+}
+
+std::vector<GLuint> MeshOptimizer::OptimizeVertexFetch(
+    std::vector<GLuint> &indices, std::size_t vertexCount) {
+  std::vector<GLuint> remap(vertexCount, ~0u);
+  GLuint next = 0;
+  for (auto &index : indices) {
+    if (remap[index] == ~0u) remap[index] = next++;
+    index = remap[index];
+  }
+  return remap;
+}
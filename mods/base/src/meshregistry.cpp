@@ -0,0 +1,50 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <meshregistry.h>
+
+std::shared_ptr<MeshGeometry>
+MeshRegistry::Find(const std::string &key) const {
+  auto it = meshes.find(key);
+  if (it == meshes.end()) return nullptr;
+  return it->second.lock();
+}
+
+void MeshRegistry::Prune() {
+  for (auto it = meshes.begin(); it != meshes.end();) {
+    if (it->second.expired())
+      it = meshes.erase(it);
+    else
+      ++it;
+  }
+}
+
+std::size_t MeshRegistry::Size() const {
+  std::size_t size = 0;
+  for (const auto &pair : meshes)
+    if (!pair.second.expired()) size++;
+  return size;
+}
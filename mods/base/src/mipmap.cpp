@@ -0,0 +1,127 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mipmap.h>
+
+unsigned Mipmaps::LevelCount(IVec2 size) {
+  unsigned levels = 1;
+  for (auto largest = std::max(size.x, size.y); largest > 1; largest /= 2)
+    levels++;
+  return levels;
+}
+
+std::size_t Mipmaps::ChainBytes(IVec2 size) {
+  std::size_t bytes = 0;
+  auto levels = LevelCount(size);
+  for (unsigned level = 0; level < levels; level++) {
+    bytes += static_cast<std::size_t>(size.x) * size.y * 4;
+    size = IVec2{std::max(size.x / 2, 1), std::max(size.y / 2, 1)};
+  }
+  return bytes;
+}
+
+IVec2 Mipmaps::LevelSize(IVec2 size, unsigned level) {
+  return IVec2{std::max(size.x >> level, 1), std::max(size.y >> level, 1)};
+}
+
+unsigned Mipmaps::LevelForSize(IVec2 size, float pixels, float bias) {
+  float level = bias;
+  if (pixels > 0.0f)
+    level += std::log2(static_cast<float>(std::max(size.x, size.y)) / pixels);
+  if (level <= 0.0f) return 0;
+  return std::min(static_cast<unsigned>(level), LevelCount(size) - 1);
+}
+
+namespace {
+// sRGB to linear for each byte value, scaled to 16 bits so four texels can be
+// summed without losing precision
+struct LinearTable {
+  std::array<unsigned, 256> toLinear;
+
+  LinearTable() {
+    for (unsigned i = 0; i < 256; i++) {
+      float c = i / 255.0f;
+      c = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+      toLinear[i] = static_cast<unsigned>(std::lround(c * 65535.0f));
+    }
+  }
+
+  unsigned char ToSRGB(unsigned linear) const {
+    // Finds the byte whose linear value is closest
+    auto it = std::lower_bound(toLinear.begin(), toLinear.end(), linear);
+    if (it == toLinear.end()) return 255;
+    if (it != toLinear.begin() && linear - *(it - 1) < *it - linear) --it;
+    return static_cast<unsigned char>(it - toLinear.begin());
+  }
+};
+} // namespace
+
+RawImage Mipmaps::Downsample(const RawImage &image) {
+  static const LinearTable table;
+
+  RawImage out;
+  out.size =
+      IVec2{std::max(image.size.x / 2, 1), std::max(image.size.y / 2, 1)};
+  out.data.resize(static_cast<std::size_t>(out.size.x) * out.size.y * 4);
+
+  auto texel = [&](int x, int y) {
+    x = std::min(x, image.size.x - 1);
+    y = std::min(y, image.size.y - 1);
+    return &image.data[(static_cast<std::size_t>(y) * image.size.x + x) * 4];
+  };
+
+  auto *dest = out.data.data();
+  for (int y = 0; y < out.size.y; y++)
+    for (int x = 0; x < out.size.x; x++, dest += 4) {
+      const unsigned char *samples[] = {texel(x * 2, y * 2),
+                                        texel(x * 2 + 1, y * 2),
+                                        texel(x * 2, y * 2 + 1),
+                                        texel(x * 2 + 1, y * 2 + 1)};
+      for (int c = 0; c < 3; c++) {
+        unsigned sum = 0;
+        for (auto *s : samples) sum += table.toLinear[s[c]];
+        dest[c] = table.ToSRGB((sum + 2) / 4);
+      }
+      unsigned alpha = 0;
+      for (auto *s : samples) alpha += s[3];
+      dest[3] = static_cast<unsigned char>((alpha + 2) / 4);
+    }
+  return out;
+}
+
+std::vector<RawImage> Mipmaps::BuildChain(const RawImage &image) {
+  std::vector<RawImage> chain;
+  auto levels = LevelCount(image.size);
+  if (levels < 2) return chain;
+
+  chain.reserve(levels - 1);
+  chain.push_back(Downsample(image));
+  while (chain.size() < levels - 1) chain.push_back(Downsample(chain.back()));
+  return chain;
+}
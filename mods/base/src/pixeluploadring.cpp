@@ -0,0 +1,141 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <gpumemory.h>
+#include <pixeluploadring.h>
+
+PixelUploadRing *PixelUploadRing::active = nullptr;
+
+PixelUploadRing::PixelUploadRing(std::size_t _capacity) {
+  if (!GLEW_ARB_buffer_storage) return;
+
+  const GLbitfield flags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  glGenBuffers(1, &ID);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+  glBufferStorage(GL_PIXEL_UNPACK_BUFFER, _capacity, nullptr, flags);
+  data = static_cast<unsigned char *>(
+      glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, _capacity, flags));
+  Unbind();
+
+  if (!data) {
+    glDeleteBuffers(1, &ID);
+    ID = 0;
+    return;
+  }
+  capacity = _capacity;
+
+  // Like other streaming memory, the ring is kept even if it goes over budget
+  GPUMemory::Record(MemoryCategory::Texture, capacity);
+  GPUMemory::AddUsed(MemoryCategory::Texture, capacity);
+}
+
+PixelUploadRing::~PixelUploadRing() {
+  for (auto &block : blocks)
+    if (block.fence) glDeleteSync(block.fence);
+  if (!ID) return;
+
+  GPUMemory::RemoveUsed(MemoryCategory::Texture, capacity);
+  GPUMemory::Release(MemoryCategory::Texture, capacity);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  Unbind();
+  glDeleteBuffers(1, &ID);
+}
+
+PixelUploadRing::Allocation PixelUploadRing::Allocate(std::size_t bytes) {
+  if (!data) return {};
+
+  // Keeps every allocation aligned for any pixel format
+  constexpr std::size_t alignment = 16;
+  bytes = (bytes + alignment - 1) / alignment * alignment;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::size_t offset = 0;
+  if (!blocks.empty()) {
+    // Blocks occupy the space from the oldest block to the head, which wraps
+    // around to the start once the newest block is before the oldest
+    auto tail = blocks.front().offset;
+    bool wrapped = blocks.back().offset < tail;
+    if (!wrapped && head + bytes <= capacity)
+      offset = head;
+    else if (!wrapped && bytes <= tail)
+      offset = 0;
+    else if (wrapped && head + bytes <= tail)
+      offset = head;
+    else
+      bytes = 0;
+  } else if (bytes > capacity) {
+    bytes = 0;
+  }
+
+  if (!bytes) {
+    statistics.full++;
+    return {};
+  }
+
+  head = offset + bytes;
+  auto id = nextID++;
+  blocks.push_back({id, offset, bytes});
+  statistics.staged++;
+  statistics.bytesStaged += bytes;
+  return {id, offset, bytes, data + offset};
+}
+
+void PixelUploadRing::Finish(const Allocation &allocation, GLsync fence) {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &block : blocks)
+    if (block.id == allocation.id) {
+      block.fence = fence;
+      block.done = true;
+      return;
+    }
+  if (fence) glDeleteSync(fence);
+}
+
+void PixelUploadRing::Submit(const Allocation &allocation) {
+  Finish(allocation, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+  Reclaim();
+}
+
+void PixelUploadRing::Reclaim() {
+  std::lock_guard<std::mutex> lock(mutex);
+  while (!blocks.empty() && blocks.front().done) {
+    auto &block = blocks.front();
+    if (block.fence) {
+      if (glClientWaitSync(block.fence, 0, 0) == GL_TIMEOUT_EXPIRED) break;
+      glDeleteSync(block.fence);
+    }
+    blocks.pop_front();
+  }
+}
+
+std::ostream &operator<<(std::ostream &os,
+                         const PixelUploadRing::Statistics &stats) {
+  os << stats.staged << " uploads staged, " << stats.bytesStaged
+     << " bytes, " << stats.full << " uploads with the ring full";
+  return os;
+}
@@ -26,4 +26,124 @@ SOFTWARE.
 
 #include <resources.h>
 
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <tuple>
+
 Resources *Resources::active = nullptr;
+
+void ShaderVariantLoader::Load(std::shared_ptr<Shader> &value,
+                               const Shader::Settings &settings) {
+  assert(Resources::active);
+  value = Resources::active->shaderVariants.Get(settings);
+}
+
+void TextureStreamLoader::Load(std::shared_ptr<Texture> &value,
+                               const TextureSettings &settings) {
+  value = std::make_shared<Texture>();
+  if (settings.streaming && TextureStreamer::active)
+    TextureStreamer::active->Load(value, settings);
+  else if (AssetStreamer::active)
+    Texture::Stream(*AssetStreamer::active, value, settings);
+  else
+    value->Load(settings);
+}
+
+std::shared_ptr<Shader>
+Resources::GetShaderVariant(const std::string &name,
+                            const Shader::Definitions &definitions) {
+  // Use the base shader's settings without compiling it if it hasn't been
+  // loaded
+  auto &deferred = shaders.GetDeferred();
+  auto it = deferred.find(name);
+  if (it != deferred.end()) return shaderVariants.Get(it->second, definitions);
+
+  auto base = shaders.Get(name);
+  return shaderVariants.Get(base->GetSettings(), definitions);
+}
+
+void Resources::WarmUpShaderVariants(
+    const std::vector<ShaderVariantRequest> &requests) {
+  for (const auto &request : requests)
+    GetShaderVariant(request.shader, request.definitions);
+}
+
+bool Resources::SubmitShaders() {
+  bool submitted = true;
+  auto &deferred = shaders.GetDeferred();
+  for (const auto &pair : deferred) {
+    auto shader = shaderVariants.Get(pair.second);
+    // A shader whose files couldn't be read is never given a program
+    if (!shader->ID()) {
+      std::cerr << "Resources: Failed to submit shader '" << pair.first
+                << "'\n";
+      submitted = false;
+    }
+    shaders.Register(pair.first, std::move(shader));
+  }
+  deferred.clear();
+  return submitted;
+}
+
+void Resources::ResolveShaders() {
+  for (auto &pair : shaders.GetLoaded()) pair.second->Resolve();
+}
+
+unsigned Resources::PackTextures() {
+  std::vector<std::string> names, paths;
+  for (const auto &pair : textures.GetDeferred())
+    if (pair.second.pack) {
+      names.push_back(pair.first);
+      paths.push_back(pair.second.path);
+    }
+  if (names.empty()) return 0;
+
+  auto images = RawImage::LoadMany(paths, true);
+
+  // Textures can only share an array if they are sampled in the same way
+  using GroupKey = std::tuple<int, int, GLint, GLint, TextureMipmaps, float>;
+  std::map<GroupKey, std::vector<std::size_t>> groups;
+  auto &deferred = textures.GetDeferred();
+  for (std::size_t i = 0; i < names.size(); i++) {
+    // Textures which failed to decode report their error when loaded alone
+    if (images[i].data.empty()) continue;
+    const auto &settings = deferred.at(names[i]);
+    groups[{images[i].size.x, images[i].size.y, (GLint)settings.shrinkFilter,
+            (GLint)settings.enlargeFilter, settings.mipmaps,
+            settings.anisotropy}]
+        .push_back(i);
+  }
+
+  unsigned arrays = 0;
+  for (const auto &group : groups) {
+    const auto &members = group.second;
+    for (std::size_t first = 0; first < members.size();
+         first += TextureArray::MaxLayers()) {
+      auto count = std::min<std::size_t>(members.size() - first,
+                                         TextureArray::MaxLayers());
+      std::vector<const RawImage *> layers;
+      for (std::size_t i = first; i < first + count; i++)
+        layers.push_back(&images[members[i]]);
+
+      const auto &settings = deferred.at(names[members[first]]);
+      auto array = std::make_shared<TextureArray>();
+      if (!array->Load(layers, settings)) {
+        std::cerr << "Failed to pack " << count << " textures with size "
+                  << layers[0]->size << " into an array\n";
+        continue;
+      }
+
+      for (std::size_t i = 0; i < count; i++) {
+        const auto &name = names[members[first + i]];
+        auto texture = std::make_shared<Texture>();
+        texture->SetLayer(array, i);
+        textures.Register(name, texture);
+        deferred.erase(name);
+      }
+      arrays++;
+    }
+  }
+  return arrays;
+}
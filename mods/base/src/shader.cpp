@@ -24,6 +24,8 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <algorithm>
+#include <base/shadercache.h>
 #include <core/file.h>
 #include <core/statics.h>
 #include <cstring>
@@ -33,12 +35,20 @@ SOFTWARE.
 #include <sstream>
 
 Shader *Shader::current;
+Shader::UniformStatistics Shader::uniformStatistics;
+
+std::ostream &operator<<(std::ostream &os,
+                         const Shader::UniformStatistics &stats) {
+  os << stats.uploads << " uniform uploads, " << stats.skipped
+     << " skipped as unchanged";
+  return os;
+}
 
 void JSONImpl<Shader::Settings>::Write(const Shader::Settings &value,
                                        JSON::Writer &writer) {
   auto obj = JSON::ObjectEncloser{writer};
   JSON::WritePair("vertex", value.vertexFilePath, writer);
-  JSON::WritePair("vertex", value.fragmentFilePath, writer);
+  JSON::WritePair("fragment", value.fragmentFilePath, writer);
   JSON::WritePair("definitions", value.definitions, writer);
 }
 
@@ -54,16 +64,15 @@ void JSONImpl<Shader::Settings>::Read(Shader::Settings &out,
 }
 
 static void CompileShader(GLuint shaderID, const std::string &source) {
-  GLint result = GL_FALSE;
-  int infoLogLength;
-
-  // Compile the shader
+  // Only start compilation here. The status is checked when the shader is
+  // resolved, so that the driver is free to compile in the background
   const char *c_str = source.c_str();
   glShaderSource(shaderID, 1, &c_str, NULL);
   glCompileShader(shaderID);
+}
 
-  // Check compilation
-  glGetShaderiv(shaderID, GL_COMPILE_STATUS, &result);
+static void CheckCompilation(GLuint shaderID) {
+  int infoLogLength;
   glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
   if (infoLogLength > 0) {
     std::vector<char> errorMessage(infoLogLength + 1);
@@ -74,12 +83,25 @@ static void CompileShader(GLuint shaderID, const std::string &source) {
   }
 }
 
-bool Shader::Load(const Settings &settings) {
+Shader::~Shader() {
+  if (compiling) {
+    glDeleteShader(pending.vertexShaderID);
+    glDeleteShader(pending.fragmentShaderID);
+  }
   if (id) glDeleteProgram(id);
+}
+
+bool Shader::Load(const Settings &settings) {
+  return Submit(settings) && Resolve();
+}
 
-  // Create the shaders
-  GLuint vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-  GLuint fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+bool Shader::Submit(const Settings &newSettings) {
+  // Finish any earlier submission so its shader objects are cleaned up
+  if (compiling) Resolve();
+  settings = newSettings;
+  if (id) glDeleteProgram(id);
+  id = 0;
+  uniformLocations.clear();
 
   // Read the shader code from the files
   std::string vertexShaderCode, fragmentShaderCode;
@@ -99,20 +121,54 @@ bool Shader::Load(const Settings &settings) {
   vertexShaderCode = versionText + defs + vertexShaderCode;
   fragmentShaderCode = versionText + defs + fragmentShaderCode;
 
-  // Compile the shaders
-  CompileShader(vertexShaderID, vertexShaderCode);
-  CompileShader(fragmentShaderID, fragmentShaderCode);
+  id = glCreateProgram();
+
+  pending.cacheKey = ShaderBinaryCache::Key(
+      vertexShaderCode, fragmentShaderCode, settings.definitions);
+  if (ShaderBinaryCache::Load(id, pending.cacheKey)) {
+    CacheUniformLocations();
+    return true;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  // Create and compile the shaders
+  pending.vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+  pending.fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+  CompileShader(pending.vertexShaderID, vertexShaderCode);
+  CompileShader(pending.fragmentShaderID, fragmentShaderCode);
 
   // Link the program
-  id = glCreateProgram();
-  glAttachShader(id, vertexShaderID);
-  glAttachShader(id, fragmentShaderID);
+  glAttachShader(id, pending.vertexShaderID);
+  glAttachShader(id, pending.fragmentShaderID);
+  if (ShaderBinaryCache::Supported())
+    glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram(id);
 
-  // Check the program
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  pending.seconds = elapsed.count();
+  compiling = true;
+  return true;
+}
+
+bool Shader::Resolve() {
+  if (!compiling) return id != 0;
+  compiling = false;
+
+  // Querying the status blocks until the driver has finished compiling and
+  // linking, so only this wait counts towards the time a cache miss costs
+  auto start = std::chrono::steady_clock::now();
   GLint result = GL_FALSE;
-  int infoLogLength;
   glGetProgramiv(id, GL_LINK_STATUS, &result);
+  std::chrono::duration<double> waited =
+      std::chrono::steady_clock::now() - start;
+
+  CheckCompilation(pending.vertexShaderID);
+  CheckCompilation(pending.fragmentShaderID);
+
+  // Check the program
+  int infoLogLength;
   glGetProgramiv(id, GL_INFO_LOG_LENGTH, &infoLogLength);
   if (infoLogLength > 0) {
     std::vector<char> programErrorMessage(infoLogLength + 1);
@@ -122,11 +178,83 @@ bool Shader::Load(const Settings &settings) {
                 << "'\n";
   }
 
-  glDetachShader(id, vertexShaderID);
-  glDetachShader(id, vertexShaderID);
+  glDetachShader(id, pending.vertexShaderID);
+  glDetachShader(id, pending.fragmentShaderID);
 
-  glDeleteShader(vertexShaderID);
-  glDeleteShader(fragmentShaderID);
+  glDeleteShader(pending.vertexShaderID);
+  glDeleteShader(pending.fragmentShaderID);
 
-  return true;
+  if (result == GL_TRUE) ShaderBinaryCache::Store(id, pending.cacheKey);
+
+  ShaderBinaryCache::statistics.misses++;
+  ShaderBinaryCache::statistics.missSeconds += pending.seconds + waited.count();
+
+  CacheUniformLocations();
+
+  return result == GL_TRUE;
+}
+
+void Shader::CacheUniformLocations() {
+  uniformLocations.clear();
+#if SHADER_SHADOW_UNIFORMS
+  shadows.clear();
+#endif
+
+  GLint count = 0, maxLength = 0;
+  glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  if (count <= 0) return;
+
+#ifndef NDEBUG
+  // Used to detect two names hashing to the same value
+  std::unordered_map<StringHash, std::string> names;
+  auto add = [this, &names](const std::string &name, GLint location) {
+    auto hash = HashString(name);
+    auto result = names.emplace(hash, name);
+    if (!result.second && result.first->second != name)
+      std::cerr << "Shader: Uniform names '" << result.first->second
+                << "' and '" << name << "' have the same hash\n";
+    uniformLocations[hash] = location;
+  };
+#else
+  auto add = [this](const std::string &name, GLint location) {
+    uniformLocations[HashString(name)] = location;
+  };
+#endif
+
+  std::vector<char> buffer(maxLength + 1);
+  for (GLint i = 0; i < count; i++) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type;
+    glGetActiveUniform(id, i, maxLength, &length, &size, &type, &buffer[0]);
+    std::string name(&buffer[0], length);
+
+    // Uniforms in uniform blocks have no location
+    auto loc = glGetUniformLocation(id, name.c_str());
+    if (loc == -1) continue;
+    add(name, loc);
+
+    // Arrays of basic types are reported once as 'name[0]'. Register the bare
+    // name and each element so they can be looked up individually
+    const std::string suffix = "[0]";
+    if (name.size() <= suffix.size() ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+      continue;
+    auto base = name.substr(0, name.size() - suffix.size());
+    add(base, loc);
+    for (GLint element = 1; element < size; element++) {
+      auto elementName = base + '[' + std::to_string(element) + ']';
+      auto elementLoc = glGetUniformLocation(id, elementName.c_str());
+      if (elementLoc != -1) add(elementName, elementLoc);
+    }
+  }
+
+#if SHADER_SHADOW_UNIFORMS
+  // A freshly linked program's uniform values are not tracked yet
+  GLint maxLocation = -1;
+  for (const auto &pair : uniformLocations)
+    maxLocation = std::max(maxLocation, pair.second);
+  shadows.assign(maxLocation + 1, UniformShadow{});
+#endif
 }
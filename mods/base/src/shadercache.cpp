@@ -0,0 +1,183 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <shadercache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <core/file.h>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+ShaderBinaryCache::Statistics ShaderBinaryCache::statistics;
+bool ShaderBinaryCache::enabled = true;
+std::string ShaderBinaryCache::directory = "cache/shaders/";
+
+namespace {
+constexpr char magic[4] = {'E', 'R', 'S', 'B'};
+constexpr std::uint32_t version = 1;
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t format;
+  std::uint32_t length;
+};
+
+std::string CachePath(StringHash key) {
+  std::stringstream ss;
+  ss << ShaderBinaryCache::directory << std::hex << std::setw(16)
+     << std::setfill('0') << key << ".bin";
+  return ss.str();
+}
+
+std::string GLString(GLenum name) {
+  auto str = glGetString(name);
+  return str ? reinterpret_cast<const char *>(str) : "";
+}
+
+/*
+ * Hash of the vendor, renderer and version strings. Binaries are only valid for
+ * the driver that produced them
+ */
+StringHash DriverHash() {
+  static const auto hash = HashString(
+      GLString(GL_VERSION),
+      HashString(GLString(GL_RENDERER), HashString(GLString(GL_VENDOR))));
+  return hash;
+}
+} // namespace
+
+bool ShaderBinaryCache::Supported() {
+  static const bool supported = [] {
+    if (!GLEW_ARB_get_program_binary) return false;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+  }();
+  return supported;
+}
+
+StringHash ShaderBinaryCache::Key(
+    const std::string &vertexSource, const std::string &fragmentSource,
+    const std::unordered_map<std::string, std::string> &definitions) {
+  // Definitions are hashed in sorted order, so that the key doesn't depend on
+  // the map's iteration order
+  std::vector<std::pair<std::string, std::string>> sorted(definitions.begin(),
+                                                          definitions.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  auto key = HashString(fragmentSource, HashString(vertexSource, DriverHash()));
+  for (const auto &definition : sorted)
+    key = HashString(definition.second, HashString(definition.first, key));
+  return key;
+}
+
+bool ShaderBinaryCache::Load(GLuint program, StringHash key) {
+  if (!enabled || !Supported()) return false;
+
+  auto start = std::chrono::steady_clock::now();
+
+  auto path = CachePath(key);
+  if (!File::Exists(path)) return false;
+
+  std::string contents;
+  try {
+    File::Read(path, contents);
+  } catch (const FileAccessException &) {
+    return false;
+  }
+
+  Header header;
+  if (contents.size() < sizeof(header)) return false;
+  std::memcpy(&header, contents.data(), sizeof(header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+      header.version != version ||
+      contents.size() != sizeof(header) + header.length)
+    return false;
+
+  glProgramBinary(program, header.format, contents.data() + sizeof(header),
+                  header.length);
+
+  // The driver may reject binaries, for example after being updated
+  GLint result = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &result);
+  if (result != GL_TRUE) {
+    statistics.rejected++;
+    return false;
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  statistics.hits++;
+  statistics.hitSeconds += elapsed.count();
+  return true;
+}
+
+void ShaderBinaryCache::Store(GLuint program, StringHash key) {
+  if (!enabled || !Supported()) return;
+
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+
+  Header header;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+
+  std::string contents(sizeof(header) + length, '\0');
+  GLenum format;
+  GLsizei written = 0;
+  glGetProgramBinary(program, length, &written, &format,
+                     &contents[sizeof(header)]);
+  if (written <= 0) return;
+
+  header.format = format;
+  header.length = written;
+  contents.resize(sizeof(header) + written);
+  std::memcpy(&contents[0], &header, sizeof(header));
+
+  try {
+    if (!Directory::Exists(directory)) Directory::Create(directory);
+    File::Write(CachePath(key), contents);
+  } catch (const FileAccessException &e) {
+    std::cerr << "ShaderBinaryCache: " << e.what() << '\n';
+  }
+}
+
+void ShaderBinaryCache::Report(std::ostream &os) {
+  const auto &s = statistics;
+  os << "Shader binary cache: " << s.hits << " hits, " << s.misses
+     << " misses";
+  if (s.rejected) os << " (" << s.rejected << " rejected by the driver)";
+  os << ", hit rate " << std::fixed << std::setprecision(1)
+     << s.HitRate() * 100.0 << "%, about " << std::setprecision(3)
+     << s.SecondsSaved() << "s saved\n";
+}
@@ -0,0 +1,88 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <shadervariants.h>
+
+#include <algorithm>
+
+void JSONImpl<ShaderVariantRequest>::Read(ShaderVariantRequest &out,
+                                          const JSON::Value &value,
+                                          const JSON::ReadData &data) {
+  auto t = Trace::Pusher{data.trace, "ShaderVariantRequest"};
+  const auto &object = JSON::GetObject(value, data);
+
+  JSON::GetMember(out.shader, "shader", object, data);
+  JSON::TryGetMember(out.definitions, "definitions", object, {}, data);
+}
+
+void JSONImpl<ShaderVariantRequest>::Write(const ShaderVariantRequest &value,
+                                           JSON::Writer &writer) {
+  auto obj = JSON::ObjectEncloser{writer};
+  JSON::WritePair("shader", value.shader, writer);
+  JSON::WritePair("definitions", value.definitions, writer);
+}
+
+StringHash ShaderVariants::Key(const Shader::Settings &settings) {
+  std::vector<std::pair<std::string, std::string>> sorted(
+      settings.definitions.begin(), settings.definitions.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  // Strings are separated with a null character, so that different splits of
+  // the same text don't produce the same key
+  constexpr std::string_view separator{"", 1};
+  auto key = HashString(settings.vertexFilePath);
+  key = HashString(settings.fragmentFilePath, HashString(separator, key));
+  for (const auto &definition : sorted) {
+    key = HashString(definition.first, HashString(separator, key));
+    key = HashString(definition.second, HashString(separator, key));
+  }
+  return key;
+}
+
+std::shared_ptr<Shader> ShaderVariants::Get(const Shader::Settings &settings) {
+  requests++;
+
+  auto &variant = variants[Key(settings)];
+  if (!variant) {
+    variant = std::make_shared<Shader>();
+    variant->Submit(settings);
+  }
+  return variant;
+}
+
+std::shared_ptr<Shader>
+ShaderVariants::Get(const Shader::Settings &base,
+                    const Shader::Definitions &definitions) {
+  auto settings = base;
+  for (const auto &definition : definitions)
+    settings.definitions[definition.first] = definition.second;
+  return Get(settings);
+}
+
+void ShaderVariants::Report(std::ostream &os) const {
+  os << "Shader variants: " << Size() << " compiled, " << Deduplicated()
+     << " requests deduplicated\n";
+}
@@ -0,0 +1,173 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <streamingbuffer.h>
+
+// Upper bound on how long to wait for the GPU to release a region
+static constexpr const GLuint64 fenceTimeout = 1000000000;
+
+void StreamingBuffer::Allocate(std::size_t bytes) {
+  Release();
+
+  persistent = GLEW_ARB_buffer_storage;
+  regionSize = bytes;
+  region = 0;
+
+  glGenBuffers(1, &ID);
+  glBindBuffer(GL_ARRAY_BUFFER, ID);
+  if (persistent) {
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_ARRAY_BUFFER, regionSize * regionCount, nullptr, flags);
+    persistentData = static_cast<unsigned char *>(glMapBufferRange(
+        GL_ARRAY_BUFFER, 0, regionSize * regionCount, flags));
+    if (!persistentData) {
+      // Fall back to orphaning if the driver refuses the mapping
+      glDeleteBuffers(1, &ID);
+      glGenBuffers(1, &ID);
+      glBindBuffer(GL_ARRAY_BUFFER, ID);
+      persistent = false;
+    }
+  }
+
+  if (!persistent)
+    glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW);
+
+  // Streamed data can't be dropped, so the buffer is kept even if it goes over
+  // budget
+  reserved = persistent ? regionSize * regionCount : regionSize;
+  GPUMemory::Record(MemoryCategory::Instance, reserved);
+  GPUMemory::AddUsed(MemoryCategory::Instance, reserved);
+}
+
+void StreamingBuffer::Release() {
+  for (auto &fence : fences) {
+    if (fence) glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+  if (!ID) return;
+  GPUMemory::RemoveUsed(MemoryCategory::Instance, reserved);
+  GPUMemory::Release(MemoryCategory::Instance, reserved);
+  reserved = 0;
+
+  if (persistentData) {
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    persistentData = nullptr;
+  }
+  glDeleteBuffers(1, &ID);
+  ID = 0;
+}
+
+void StreamingBuffer::WaitForRegion(unsigned r) {
+  auto &fence = fences[r];
+  if (!fence) return;
+
+  // Flushes on the first wait, as the fence may not have reached the GPU yet if
+  // the region was reused before the next swap
+  while (true) {
+    auto result =
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout);
+    if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED ||
+        result == GL_WAIT_FAILED)
+      break;
+  }
+
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+void *StreamingBuffer::Map(std::size_t bytes) {
+  assert(!mapped);
+  if (bytes == 0) bytes = 1;
+
+  if (!ID || bytes > regionSize) {
+    // Grow geometrically so a slowly increasing instance count doesn't
+    // reallocate every frame
+    Allocate(std::max(bytes, regionSize + regionSize / 2));
+  } else if (persistent) {
+    // Everything drawn from the current region has been submitted by now
+    Fence();
+    region = (region + 1) % regionCount;
+  }
+
+  mapped = true;
+  if (persistent) {
+    WaitForRegion(region);
+    return persistentData + region * regionSize;
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, ID);
+  // Invalidating the whole buffer orphans the old storage, so the GPU can keep
+  // reading from it
+  auto data = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (!data) {
+    std::cerr << "StreamingBuffer: Failed to map " << bytes << " bytes\n";
+    mapped = false;
+  }
+  return data;
+}
+
+void StreamingBuffer::Unmap() {
+  // Nothing is mapped if Map failed
+  if (!mapped) return;
+  mapped = false;
+  if (persistent) return;
+
+  glBindBuffer(GL_ARRAY_BUFFER, ID);
+  glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+void StreamingBuffer::Fence() {
+  if (!persistent) return;
+
+  auto &fence = fences[region];
+  if (fence) glDeleteSync(fence);
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamingBuffer::PointAttributes(
+    const std::vector<InterleavedAttribute> &attributes, GLsizei stride,
+    unsigned instanceDivisor) const {
+  Use();
+  auto base = Offset();
+  for (const auto &attribute : attributes) {
+    glEnableVertexAttribArray(attribute.index);
+    auto offset = static_cast<std::uintptr_t>(base + attribute.offset);
+    glVertexAttribPointer(attribute.index, attribute.components,
+                          attribute.type, attribute.normalized, stride,
+                          reinterpret_cast<GLvoid *>(offset));
+
+    if (instanceDivisor)
+      glVertexAttribDivisor(attribute.index, instanceDivisor);
+  }
+}
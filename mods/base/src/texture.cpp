@@ -24,26 +24,111 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <mipmap.h>
 #include <texture.h>
+#include <texturecache.h>
 
 bool Texture::Load(const TextureSettings &settings) {
+  CompressedImage cooked;
+  if (TextureCache::Load(settings.path, cooked)) return Load(cooked, settings);
+
   RawImage r;
   if (!r.Load(settings.path, true)) {
     std::cerr << "Failed to load texture with path: " << settings.path << '\n';
     return false;
   }
 
-  Load(r, settings);
+  return Load(r, settings);
+}
+
+bool Texture::Reserve(std::size_t amount) {
+  if (!GPUMemory::Reserve(MemoryCategory::Texture, amount)) return false;
+  GPUMemory::AddUsed(MemoryCategory::Texture, amount);
+  bytes = amount;
   return true;
 }
 
+namespace {
+struct Binding {
+  GLenum target = 0;
+  GLuint id = 0;
+};
+
+// What each texture unit was last bound to, so repeated binds can be skipped
+constexpr unsigned cachedUnits = 32;
+Binding bindings[cachedUnits];
+unsigned activeUnit = 0;
+
+// Binds a texture to the active unit in order to upload to it
+void BindForUpload(GLenum target, GLuint id) {
+  glBindTexture(target, id);
+  if (activeUnit < cachedUnits) bindings[activeUnit] = {target, id};
+}
+
+// Deleted textures are unbound, and their names may be reused
+void ForgetBindings(GLuint id) {
+  for (auto &binding : bindings)
+    if (binding.id == id) binding = {};
+}
+} // namespace
+
+void Texture::Bind(unsigned unit, GLenum target, GLuint id) {
+  if (unit < cachedUnits && bindings[unit].target == target &&
+      bindings[unit].id == id)
+    return;
+
+  if (unit != activeUnit) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    activeUnit = unit;
+  }
+  glBindTexture(target, id);
+  if (unit < cachedUnits) bindings[unit] = {target, id};
+}
+
+void Texture::Free() {
+  array.reset();
+  layer = 0;
+  streamed = false;
+  if (!id) return;
+  ForgetBindings(id);
+  glDeleteTextures(1, &id);
+  GPUMemory::RemoveUsed(MemoryCategory::Texture, bytes);
+  GPUMemory::Release(MemoryCategory::Texture, bytes);
+  id = 0;
+  bytes = 0;
+}
+
+Texture::~Texture() { Free(); }
+
+static void SetAnisotropy(GLenum target, float anisotropy) {
+  if (anisotropy <= 1.0f || !GLEW_EXT_texture_filter_anisotropic) return;
+
+  static const GLfloat supported = [] {
+    GLfloat max = 1.0f;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max);
+    return max;
+  }();
+  glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT,
+                  std::min(anisotropy, supported));
+}
+
+static void SetFilters(const TextureSettings &settings) {
+  glTexParameteri((GLenum)settings.type, GL_TEXTURE_MAG_FILTER,
+                  (GLint)settings.enlargeFilter);
+  glTexParameteri((GLenum)settings.type, GL_TEXTURE_MIN_FILTER,
+                  (GLint)settings.shrinkFilter);
+  SetAnisotropy((GLenum)settings.type, settings.anisotropy);
+}
+
 static GLuint Generate(const TextureSettings &settings, GLint internalFormat,
                        IVec2 size, GLenum format, GLenum type,
                        const GLvoid *data) {
   GLuint id;
   glGenTextures(1, &id);
-  glBindTexture((GLenum)settings.type, id);
+  BindForUpload((GLenum)settings.type, id);
 
   // Map the image to the texture
   glTexImage2D(GL_TEXTURE_2D, 0,
@@ -54,24 +139,437 @@ static GLuint Generate(const TextureSettings &settings, GLint internalFormat,
                type, // Pixels stored as unsigned numbers
                data); // The pixel data
 
-  glTexParameteri((GLenum)settings.type, GL_TEXTURE_MAG_FILTER,
-                  (GLint)settings.enlargeFilter);
-  glTexParameteri((GLenum)settings.type, GL_TEXTURE_MIN_FILTER,
-                  (GLint)settings.shrinkFilter);
+  SetFilters(settings);
   return id;
 }
 
+// Fills in the levels below the base level of the bound texture
+static void GenerateMipmaps(const TextureSettings &settings,
+                            const std::vector<RawImage> &mipmaps,
+                            IVec2 size) {
+  auto target = (GLenum)settings.type;
+  if (settings.mipmaps == TextureMipmaps::None) {
+    // Without this the texture would be incomplete, and sample as black
+    if (settings.SamplesMipmaps())
+      glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
+    return;
+  }
+
+  if (settings.mipmaps == TextureMipmaps::GPU ||
+      mipmaps.size() + 1 != Mipmaps::LevelCount(size)) {
+    glGenerateMipmap(target);
+    return;
+  }
+
+  GLint level = 1;
+  for (const auto &mipmap : mipmaps)
+    glTexImage2D(GL_TEXTURE_2D, level++, GL_RGBA, mipmap.size.x,
+                 mipmap.size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 mipmap.data.data());
+}
+
+bool Texture::Load(const RawImage &raw, const TextureSettings &settings) {
+  if (settings.mipmaps == TextureMipmaps::BoxFilter)
+    return Load(raw, Mipmaps::BuildChain(raw), settings);
+  return Load(raw, {}, settings);
+}
+
 // TODO: Add more options and make this more versatile
-void Texture::Load(const RawImage &raw, const TextureSettings &settings) {
+bool Texture::Load(const RawImage &raw, const std::vector<RawImage> &mipmaps,
+                   const TextureSettings &settings) {
+  Free();
   size = raw.size;
+  auto amount = settings.mipmaps == TextureMipmaps::None
+                    ? static_cast<std::size_t>(size.x) * size.y * 4
+                    : Mipmaps::ChainBytes(size);
+  if (!Reserve(amount)) {
+    state = AssetState::Failed;
+    return false;
+  }
+
   id = Generate(settings, GL_RGBA, size, GL_RGBA, GL_UNSIGNED_BYTE,
                 raw.data.data());
+  GenerateMipmaps(settings, mipmaps, size);
+  state = AssetState::Ready;
+  return true;
+}
+
+bool Texture::Load(const CompressedImage &image,
+                   const TextureSettings &settings) {
+  if (image.levels.empty()) return false;
+
+  if (!GLEW_EXT_texture_compression_s3tc) {
+    RawImage raw = BlockCompression::Decompress(image.levels[0], image.format);
+    std::vector<RawImage> mipmaps;
+    for (std::size_t i = 1; i < image.levels.size(); i++)
+      mipmaps.push_back(
+          BlockCompression::Decompress(image.levels[i], image.format));
+    return Load(raw, mipmaps, settings);
+  }
+
+  // The cooked levels replace generated ones
+  std::size_t levelCount =
+      settings.mipmaps == TextureMipmaps::None ? 1 : image.levels.size();
+  std::size_t amount = 0;
+  for (std::size_t i = 0; i < levelCount; i++)
+    amount += image.levels[i].data.size();
+
+  Free();
+  size = image.levels[0].size;
+  if (!Reserve(amount)) {
+    state = AssetState::Failed;
+    return false;
+  }
+
+  auto target = (GLenum)settings.type;
+  glGenTextures(1, &id);
+  BindForUpload(target, id);
+  for (std::size_t i = 0; i < levelCount; i++) {
+    const auto &level = image.levels[i];
+    glCompressedTexImage2D(GL_TEXTURE_2D, i, (GLenum)image.format,
+                           level.size.x, level.size.y, 0, level.data.size(),
+                           level.data.data());
+  }
+  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+  SetFilters(settings);
+
+  state = AssetState::Ready;
+  return true;
+}
+
+template <typename Level>
+Texture::Staged Texture::Stage(PixelUploadRing &ring,
+                               const std::vector<Level *> &levels,
+                               GLenum format) {
+  Staged staged;
+  staged.format = format;
+  std::size_t bytes = 0;
+  for (const auto *level : levels) bytes += level->data.size();
+  staged.allocation = ring.Allocate(bytes);
+  if (!staged.allocation) return staged;
+
+  std::size_t offset = 0;
+  for (auto *level : levels) {
+    auto levelBytes = level->data.size();
+    std::memcpy(staged.allocation.data + offset, level->data.data(),
+                levelBytes);
+    staged.levels.push_back({level->size, offset, levelBytes});
+    offset += levelBytes;
+    std::vector<unsigned char>().swap(level->data);
+  }
+  return staged;
+}
+
+bool Texture::Load(PixelUploadRing &ring, const Staged &staged,
+                   const TextureSettings &settings) {
+  Free();
+  size = staged.levels[0].size;
+  std::size_t amount = 0;
+  if (staged.format)
+    for (const auto &level : staged.levels) amount += level.bytes;
+  else
+    amount = settings.mipmaps == TextureMipmaps::None
+                 ? static_cast<std::size_t>(size.x) * size.y * 4
+                 : Mipmaps::ChainBytes(size);
+  if (!Reserve(amount)) {
+    state = AssetState::Failed;
+    return false;
+  }
+
+  auto target = (GLenum)settings.type;
+  glGenTextures(1, &id);
+  BindForUpload(target, id);
+
+  // With the ring bound, the driver copies from it rather than from client
+  // memory, so these return without waiting for the copy
+  ring.Bind();
+  GLint index = 0;
+  for (const auto &level : staged.levels) {
+    auto *source = staged.allocation.Source(level.offset);
+    if (staged.format)
+      glCompressedTexImage2D(GL_TEXTURE_2D, index++, staged.format,
+                             level.size.x, level.size.y, 0, level.bytes,
+                             source);
+    else
+      glTexImage2D(GL_TEXTURE_2D, index++, GL_RGBA, level.size.x,
+                   level.size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, source);
+  }
+  PixelUploadRing::Unbind();
+
+  if (staged.format)
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, staged.levels.size() - 1);
+  else if (staged.levels.size() == 1)
+    GenerateMipmaps(settings, {}, size);
+  SetFilters(settings);
+
+  state = AssetState::Ready;
+  return true;
+}
+
+void Texture::LoadPlaceholder(const TextureSettings &settings) {
+  RawImage grey;
+  grey.size = IVec2{1, 1};
+  grey.data = {128, 128, 128, 255};
+  Load(grey, settings);
+  state = AssetState::Loading;
+}
+
+void Texture::Stream(AssetStreamer &streamer,
+                     const std::shared_ptr<Texture> &texture,
+                     const TextureSettings &settings) {
+  texture->LoadPlaceholder(settings);
+
+  // Cooked textures are read on the worker, and box filtered mip levels are
+  // built there along with the image otherwise
+  struct Decoded {
+    CompressedImage cooked;
+    RawImage image;
+    std::vector<RawImage> mipmaps;
+
+    // Set when the levels were copied into the upload ring
+    Staged staged;
+  };
+
+  // The levels are staged in the ring when it has room, and otherwise
+  // uploaded from the decoded images
+  auto *ring = PixelUploadRing::active;
+  streamer.Submit(
+      "texture:" + settings.path,
+      [settings, ring] {
+        auto decoded = std::make_unique<Decoded>();
+        if (TextureCache::Load(settings.path, decoded->cooked)) {
+          auto &levels = decoded->cooked.levels;
+          auto count = settings.mipmaps == TextureMipmaps::None
+                           ? std::size_t{1}
+                           : levels.size();
+          if (ring && GLEW_EXT_texture_compression_s3tc) {
+            std::vector<CompressedLevel *> staged;
+            for (std::size_t i = 0; i < count; i++)
+              staged.push_back(&levels[i]);
+            decoded->staged =
+                Stage(*ring, staged, (GLenum)decoded->cooked.format);
+          }
+          return decoded;
+        }
+
+        if (!decoded->image.Load(settings.path, true)) {
+          decoded.reset();
+          return decoded;
+        }
+        if (settings.mipmaps == TextureMipmaps::BoxFilter)
+          decoded->mipmaps = Mipmaps::BuildChain(decoded->image);
+        if (ring) {
+          std::vector<RawImage *> staged{&decoded->image};
+          for (auto &mipmap : decoded->mipmaps) staged.push_back(&mipmap);
+          decoded->staged = Stage(*ring, staged, 0);
+        }
+        return decoded;
+      },
+      [texture, settings, ring](std::unique_ptr<Decoded> &decoded)
+          -> std::size_t {
+        if (!decoded) {
+          std::cerr << "Failed to load texture with path: " << settings.path
+                    << '\n';
+          texture->state = AssetState::Failed;
+          return 0;
+        }
+
+        // Textures sharing the decoded levels all upload the staged copy,
+        // whose allocation is kept until the last of them has been loaded
+        bool loaded;
+        if (decoded->staged.allocation)
+          loaded = texture->Load(*ring, decoded->staged, settings);
+        else
+          loaded =
+              decoded->cooked.levels.empty()
+                  ? texture->Load(decoded->image, decoded->mipmaps, settings)
+                  : texture->Load(decoded->cooked, settings);
+        return loaded ? texture->bytes : 0;
+      },
+      [ring](std::unique_ptr<Decoded> &decoded, bool uploaded) {
+        if (!decoded || !decoded->staged.allocation) return;
+        if (uploaded)
+          ring->Submit(decoded->staged.allocation);
+        else
+          ring->Release(decoded->staged.allocation);
+        decoded->staged.allocation = {};
+      });
+}
+
+void Texture::BeginStreaming(const TextureSettings &settings, IVec2 _size,
+                             unsigned levelCount) {
+  Free();
+  size = _size;
+  streamed = true;
+  state = AssetState::Loading;
+
+  glGenTextures(1, &id);
+  BindForUpload(GL_TEXTURE_2D, id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levelCount - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+  SetFilters(settings);
+}
+
+PixelUploadRing::Allocation
+Texture::StageLevel(PixelUploadRing *ring,
+                    const std::vector<unsigned char> &data) {
+  if (!ring) return {};
+  auto allocation = ring->Allocate(data.size());
+  if (!allocation) return allocation;
+  std::memcpy(allocation.data, data.data(), data.size());
+  ring->Bind();
+  return allocation;
+}
+
+bool Texture::StreamLevel(unsigned level, const RawImage &image,
+                          PixelUploadRing *ring) {
+  auto amount = image.data.size();
+  if (!GPUMemory::Reserve(MemoryCategory::Texture, amount)) return false;
+  GPUMemory::AddUsed(MemoryCategory::Texture, amount);
+  bytes += amount;
+
+  BindForUpload(GL_TEXTURE_2D, id);
+  // The driver copies from the ring after the call returns, rather than from
+  // the image before it returns
+  auto staged = StageLevel(ring, image.data);
+  glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, image.size.x, image.size.y, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE,
+               staged ? staged.Source() : image.data.data());
+  if (staged) {
+    PixelUploadRing::Unbind();
+    ring->Submit(staged);
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+  state = AssetState::Ready;
+  return true;
+}
+
+bool Texture::StreamLevel(unsigned level, const CompressedLevel &image,
+                          BlockFormat format, PixelUploadRing *ring) {
+  auto amount = image.data.size();
+  if (!GPUMemory::Reserve(MemoryCategory::Texture, amount)) return false;
+  GPUMemory::AddUsed(MemoryCategory::Texture, amount);
+  bytes += amount;
+
+  BindForUpload(GL_TEXTURE_2D, id);
+  auto staged = StageLevel(ring, image.data);
+  glCompressedTexImage2D(GL_TEXTURE_2D, level, (GLenum)format, image.size.x,
+                         image.size.y, 0, amount,
+                         staged ? staged.Source() : image.data.data());
+  if (staged) {
+    PixelUploadRing::Unbind();
+    ring->Submit(staged);
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+  state = AssetState::Ready;
+  return true;
+}
+
+void Texture::EvictLevel(unsigned level, std::size_t levelBytes) {
+  // Levels below the base level aren't sampled, so redefining the level as
+  // empty frees its storage without making the texture incomplete
+  BindForUpload(GL_TEXTURE_2D, id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+  glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+
+  GPUMemory::RemoveUsed(MemoryCategory::Texture, levelBytes);
+  GPUMemory::Release(MemoryCategory::Texture, levelBytes);
+  bytes -= levelBytes;
 }
 
 void Texture::CreateForFramebuffer(IVec2 _size) {
+  Free();
   size = _size;
+  // Render targets are needed regardless of the budget
+  bytes = static_cast<std::size_t>(size.x) * size.y * 3;
+  GPUMemory::Record(MemoryCategory::Texture, bytes);
+  GPUMemory::AddUsed(MemoryCategory::Texture, bytes);
   auto settings =
       TextureSettings{TextureType::Tex2D, TextureShrinkType::Nearest,
                       TextureEnlargeType::Nearest};
   id = Generate(settings, GL_RGB, size, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
 }
+
+void Texture::SetLayer(std::shared_ptr<TextureArray> _array, unsigned _layer) {
+  Free();
+  array = std::move(_array);
+  layer = _layer;
+  size = array->Size();
+  state = AssetState::Ready;
+}
+
+TextureArray::~TextureArray() {
+  if (!id) return;
+  ForgetBindings(id);
+  glDeleteTextures(1, &id);
+  GPUMemory::RemoveUsed(MemoryCategory::Texture, bytes);
+  GPUMemory::Release(MemoryCategory::Texture, bytes);
+}
+
+unsigned TextureArray::MaxLayers() {
+  static const unsigned maxLayers = [] {
+    GLint max = 256; // The least OpenGL 3.3 allows
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max);
+    return static_cast<unsigned>(max);
+  }();
+  return maxLayers;
+}
+
+bool TextureArray::Load(const std::vector<const RawImage *> &layers,
+                        const TextureSettings &settings) {
+  if (id || layers.empty() || layers.size() > MaxLayers()) return false;
+  auto layerSize = layers[0]->size;
+  for (const auto *image : layers)
+    if (image->size.x != layerSize.x || image->size.y != layerSize.y)
+      return false;
+
+  auto levelCount = settings.mipmaps == TextureMipmaps::None
+                        ? 1u
+                        : Mipmaps::LevelCount(layerSize);
+  auto amount = (settings.mipmaps == TextureMipmaps::None
+                     ? static_cast<std::size_t>(layerSize.x) * layerSize.y * 4
+                     : Mipmaps::ChainBytes(layerSize)) *
+                layers.size();
+  if (!GPUMemory::Reserve(MemoryCategory::Texture, amount)) return false;
+  GPUMemory::AddUsed(MemoryCategory::Texture, amount);
+  bytes = amount;
+  size = layerSize;
+  layerCount = layers.size();
+
+  auto arraySettings = settings;
+  arraySettings.type = TextureType::Tex2DArray;
+  glGenTextures(1, &id);
+  BindForUpload(GL_TEXTURE_2D_ARRAY, id);
+
+  // Only levels filled in here are allocated, so the GPU generates the rest
+  auto uploadedLevels =
+      settings.mipmaps == TextureMipmaps::BoxFilter ? levelCount : 1u;
+  IVec2 levelSize = size;
+  for (unsigned level = 0; level < uploadedLevels; level++) {
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, levelSize.x, levelSize.y,
+                 layerCount, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    levelSize =
+        IVec2{std::max(levelSize.x / 2, 1), std::max(levelSize.y / 2, 1)};
+  }
+
+  for (unsigned i = 0; i < layerCount; i++) {
+    const auto &image = *layers[i];
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, size.x, size.y, 1,
+                    GL_RGBA, GL_UNSIGNED_BYTE, image.data.data());
+    if (uploadedLevels == 1) continue;
+
+    GLint level = 1;
+    for (const auto &mipmap : Mipmaps::BuildChain(image))
+      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level++, 0, 0, i, mipmap.size.x,
+                      mipmap.size.y, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                      mipmap.data.data());
+  }
+
+  if (settings.mipmaps == TextureMipmaps::GPU)
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  else if (settings.mipmaps == TextureMipmaps::None)
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+  SetFilters(arraySettings);
+  return true;
+}
@@ -0,0 +1,215 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <texturecache.h>
+
+#include <algorithm>
+#include <core/file.h>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mipmap.h>
+
+TextureCache::Statistics TextureCache::statistics;
+bool TextureCache::enabled = true;
+
+namespace {
+constexpr unsigned char identifier[12] = {0xAB, 'K',  'T',  'X', ' ',  '1',
+                                          '1',  0xBB, '\r', '\n', 0x1A, '\n'};
+constexpr std::uint32_t endianness = 0x04030201;
+constexpr char sourceKey[] = "Eris.source";
+
+struct Header {
+  unsigned char identifier[12];
+  std::uint32_t endianness;
+  std::uint32_t glType, glTypeSize, glFormat, glInternalFormat,
+      glBaseInternalFormat;
+  std::uint32_t pixelWidth, pixelHeight, pixelDepth;
+  std::uint32_t numberOfArrayElements, numberOfFaces, numberOfMipmapLevels;
+  std::uint32_t bytesOfKeyValueData;
+};
+
+template <typename T>
+void Append(std::string &contents, const T &value) {
+  contents.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+std::size_t Pad4(std::size_t size) { return (size + 3) / 4 * 4; }
+
+// Finds the source key among the key/value pairs, whose value is the source's
+// stamp
+bool ReadSource(const char *data, std::size_t size, File::Stamp &out) {
+  std::size_t offset = 0;
+  while (offset + 4 <= size) {
+    std::uint32_t pairSize;
+    std::memcpy(&pairSize, data + offset, 4);
+    offset += 4;
+    if (pairSize > size - offset) return false;
+
+    const auto *pair = data + offset;
+    if (pairSize == sizeof(sourceKey) + sizeof(File::Stamp) &&
+        std::memcmp(pair, sourceKey, sizeof(sourceKey)) == 0) {
+      std::memcpy(&out, pair + sizeof(sourceKey), sizeof(File::Stamp));
+      return true;
+    }
+    offset += Pad4(pairSize);
+  }
+  return false;
+}
+} // namespace
+
+std::string TextureCache::Path(const std::string &source) {
+  return source + ".ktx";
+}
+
+bool TextureCache::Load(const std::string &source, CompressedImage &out) {
+  if (!enabled) return false;
+
+  MappedFile file;
+  if (!file.Open(Path(source))) {
+    statistics.misses++;
+    return false;
+  }
+
+  Header header;
+  if (file.Size() < sizeof(header)) return false;
+  std::memcpy(&header, file.Data(), sizeof(header));
+  auto format = static_cast<BlockFormat>(header.glInternalFormat);
+  if (std::memcmp(header.identifier, identifier, sizeof(identifier)) != 0 ||
+      header.endianness != endianness ||
+      (format != BlockFormat::BC1 && format != BlockFormat::BC3) ||
+      header.pixelDepth != 0 || header.numberOfArrayElements != 0 ||
+      header.numberOfFaces != 1 || header.numberOfMipmapLevels == 0 ||
+      header.bytesOfKeyValueData > file.Size() - sizeof(header)) {
+    statistics.stale++;
+    return false;
+  }
+
+  File::Stamp cooked;
+  if (!ReadSource(file.Data() + sizeof(header), header.bytesOfKeyValueData,
+                  cooked) ||
+      !File::Matches(source, cooked)) {
+    statistics.stale++;
+    return false;
+  }
+
+  CompressedImage image;
+  image.format = format;
+  IVec2 size{static_cast<int>(header.pixelWidth),
+             static_cast<int>(header.pixelHeight)};
+  std::size_t offset = sizeof(header) + header.bytesOfKeyValueData;
+  for (std::uint32_t i = 0; i < header.numberOfMipmapLevels; i++) {
+    std::uint32_t imageSize = 0;
+    if (offset + 4 <= file.Size())
+      std::memcpy(&imageSize, file.Data() + offset, 4);
+    offset += 4;
+    if (imageSize != BlockCompression::LevelBytes(format, size) ||
+        offset + imageSize > file.Size()) {
+      std::cerr << "TextureCache: '" << Path(source) << "' is truncated\n";
+      statistics.stale++;
+      return false;
+    }
+
+    const auto *begin =
+        reinterpret_cast<const unsigned char *>(file.Data() + offset);
+    image.levels.push_back({size, {begin, begin + imageSize}});
+    offset += Pad4(imageSize);
+    size = IVec2{std::max(size.x / 2, 1), std::max(size.y / 2, 1)};
+  }
+
+  statistics.compressedBytes += image.Bytes();
+  for (const auto &level : image.levels)
+    statistics.uncompressedBytes +=
+        static_cast<std::size_t>(level.size.x) * level.size.y * 4;
+  out = std::move(image);
+  statistics.hits++;
+  return true;
+}
+
+bool TextureCache::Store(const std::string &source,
+                         const CompressedImage &image) {
+  if (image.levels.empty()) return false;
+
+  File::Stamp cooked;
+  if (!File::GetStamp(source, cooked)) return false;
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.identifier, identifier, sizeof(identifier));
+  header.endianness = endianness;
+  header.glTypeSize = 1;
+  header.glInternalFormat = static_cast<std::uint32_t>(image.format);
+  header.glBaseInternalFormat =
+      image.format == BlockFormat::BC1 ? GL_RGB : GL_RGBA;
+  header.pixelWidth = image.levels[0].size.x;
+  header.pixelHeight = image.levels[0].size.y;
+  header.numberOfFaces = 1;
+  header.numberOfMipmapLevels = image.levels.size();
+
+  std::uint32_t pairSize = sizeof(sourceKey) + sizeof(cooked);
+  header.bytesOfKeyValueData = 4 + Pad4(pairSize);
+
+  std::string contents;
+  Append(contents, header);
+  Append(contents, pairSize);
+  contents.append(sourceKey, sizeof(sourceKey));
+  Append(contents, cooked);
+  contents.resize(sizeof(header) + header.bytesOfKeyValueData, '\0');
+
+  for (const auto &level : image.levels) {
+    Append(contents, static_cast<std::uint32_t>(level.data.size()));
+    contents.append(reinterpret_cast<const char *>(level.data.data()),
+                    level.data.size());
+    contents.resize(Pad4(contents.size()), '\0');
+  }
+
+  try {
+    File::Write(Path(source), contents);
+  } catch (const FileAccessException &e) {
+    std::cerr << "TextureCache: " << e.what() << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool TextureCache::Bake(const std::string &source) {
+  RawImage image;
+  // Flipped in the same way as textures loaded directly
+  if (!image.Load(source, true)) return false;
+
+  auto format = BlockCompression::ChooseFormat(image);
+  return Store(source,
+               BlockCompression::Compress(image, Mipmaps::BuildChain(image),
+                                          format));
+}
+
+void TextureCache::Report(std::ostream &os) {
+  const auto &s = statistics;
+  os << "Texture cache: " << s.hits << " hits, " << s.misses << " misses";
+  if (s.stale) os << ", " << s.stale << " stale";
+  os << ", " << s.compressedBytes << " bytes loaded in place of "
+     << s.uncompressedBytes << '\n';
+}
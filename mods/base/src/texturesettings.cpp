@@ -68,6 +68,17 @@ void JSONImpl<TextureSettings>::Write(const TextureSettings &value, JSON::Writer
   };
 
   JSON::WritePair("enlarge-filter", enlargeTypes.at(value.enlargeFilter), writer);
+
+  const std::unordered_map<TextureMipmaps, std::string> mipmapTypes = {
+    {TextureMipmaps::None, "none"},
+    {TextureMipmaps::GPU, "gpu"},
+    {TextureMipmaps::BoxFilter, "box-filter"}
+  };
+
+  JSON::WritePair("mipmaps", mipmapTypes.at(value.mipmaps), writer);
+  JSON::WritePair("anisotropy", value.anisotropy, writer);
+  JSON::WritePair("pack", value.pack, writer);
+  JSON::WritePair("streaming", value.streaming, writer);
 }
 
 void JSONImpl<TextureSettings>::Read(TextureSettings &out, const JSON::Value &value, const JSON::ReadData &data) {
@@ -113,4 +124,30 @@ void JSONImpl<TextureSettings>::Read(TextureSettings &out, const JSON::Value &va
 
   auto enlarge = JSON::GetMember<std::string>("enlarge-filter", object, data);
   JSON::GetAssociated(out.enlargeFilter, enlargeTypes, enlarge, data);
+
+  const std::unordered_map<std::string, TextureMipmaps> mipmapTypes = {
+    {"none", TextureMipmaps::None},
+    {"gpu", TextureMipmaps::GPU},
+    {"box-filter", TextureMipmaps::BoxFilter}
+  };
+
+  // Mipmapped shrink filters need mip levels, so generate them by default
+  auto mipmaps = JSON::TryGetMember<std::string>(
+      "mipmaps", object, out.SamplesMipmaps() ? "gpu" : "none", data);
+  JSON::GetAssociated(out.mipmaps, mipmapTypes, mipmaps, data);
+
+  JSON::TryGetMember(out.anisotropy, "anisotropy", object, 1.0f, data);
+  JSON::ParseFailIf(out.anisotropy < 1.0f, data,
+                    "Anisotropy must be at least 1");
+
+  JSON::TryGetMember(out.pack, "pack", object, false, data);
+  JSON::ParseFailIf(out.pack && out.type != TextureType::Tex2D, data,
+                    "Only 'tex-2d' textures can be packed");
+
+  JSON::TryGetMember(out.streaming, "streaming", object, false, data);
+  JSON::ParseFailIf(out.streaming && (out.type != TextureType::Tex2D ||
+                                      out.mipmaps == TextureMipmaps::None),
+                    data, "Only mipmapped 'tex-2d' textures can be streamed");
+  JSON::ParseFailIf(out.streaming && out.pack, data,
+                    "Streamed textures cannot be packed");
 }
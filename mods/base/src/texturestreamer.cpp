@@ -0,0 +1,286 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <mipmap.h>
+#include <texturecache.h>
+#include <texturestreamer.h>
+
+TextureStreamer *TextureStreamer::active = nullptr;
+
+IVec2 TextureStreamer::LevelSize(const Entry &entry, unsigned level) {
+  return entry.compressed ? entry.cooked.levels[level].size
+                          : entry.levels[level].size;
+}
+
+std::size_t TextureStreamer::LevelBytes(const Entry &entry, unsigned level) {
+  return entry.compressed ? entry.cooked.levels[level].data.size()
+                          : entry.levels[level].data.size();
+}
+
+namespace {
+struct Decoded {
+  CompressedImage cooked;
+  std::vector<RawImage> levels;
+};
+} // namespace
+
+void TextureStreamer::Load(const std::shared_ptr<Texture> &texture,
+                           const TextureSettings &textureSettings) {
+  texture->LoadPlaceholder(textureSettings);
+
+  auto decode = [textureSettings] {
+    Decoded decoded;
+    if (TextureCache::Load(textureSettings.path, decoded.cooked))
+      return decoded;
+
+    RawImage image;
+    if (!image.Load(textureSettings.path, true)) return decoded;
+    auto chain = Mipmaps::BuildChain(image);
+    decoded.levels.reserve(chain.size() + 1);
+    decoded.levels.push_back(std::move(image));
+    std::move(chain.begin(), chain.end(), std::back_inserter(decoded.levels));
+    return decoded;
+  };
+
+  // The decoded levels are copied, as textures with the same path share them
+  auto add = [this, texture, textureSettings](Decoded &decoded) {
+    if (decoded.cooked.levels.empty() && decoded.levels.empty()) {
+      std::cerr << "Failed to load texture with path: " << textureSettings.path
+                << '\n';
+      texture->state = AssetState::Failed;
+      return std::size_t{0};
+    }
+
+    if (decoded.cooked.levels.empty())
+      Add(texture, decoded.levels, textureSettings);
+    else
+      Add(texture, decoded.cooked, textureSettings);
+    return texture->bytes;
+  };
+
+  if (AssetStreamer::active) {
+    AssetStreamer::active->Submit("streamed-texture:" + textureSettings.path,
+                                  decode, add);
+  } else {
+    auto decoded = decode();
+    add(decoded);
+  }
+}
+
+void TextureStreamer::Add(const std::shared_ptr<Texture> &texture,
+                          std::vector<RawImage> levels,
+                          const TextureSettings &textureSettings) {
+  if (levels.empty()) return;
+  if (levels.size() != Mipmaps::LevelCount(levels[0].size)) {
+    std::vector<RawImage> mipmaps(std::make_move_iterator(levels.begin() + 1),
+                                  std::make_move_iterator(levels.end()));
+    texture->Load(levels[0], mipmaps, textureSettings);
+    return;
+  }
+
+  Entry entry;
+  entry.levels = std::move(levels);
+  Begin(texture, std::move(entry), textureSettings);
+}
+
+void TextureStreamer::Add(const std::shared_ptr<Texture> &texture,
+                          CompressedImage image,
+                          const TextureSettings &textureSettings) {
+  if (image.levels.empty()) return;
+  if (image.levels.size() != Mipmaps::LevelCount(image.levels[0].size)) {
+    texture->Load(image, textureSettings);
+    return;
+  }
+
+  if (!GLEW_EXT_texture_compression_s3tc) {
+    std::vector<RawImage> levels;
+    for (const auto &level : image.levels)
+      levels.push_back(BlockCompression::Decompress(level, image.format));
+    Add(texture, std::move(levels), textureSettings);
+    return;
+  }
+
+  Entry entry;
+  entry.cooked = std::move(image);
+  entry.compressed = true;
+  Begin(texture, std::move(entry), textureSettings);
+}
+
+void TextureStreamer::Begin(const std::shared_ptr<Texture> &texture,
+                            Entry entry,
+                            const TextureSettings &textureSettings) {
+  entry.texture = texture;
+  entry.levelCount = Mipmaps::LevelCount(LevelSize(entry, 0));
+  entry.tail = entry.levelCount - 1;
+  while (entry.tail > 0) {
+    auto size = LevelSize(entry, entry.tail - 1);
+    if (std::max(size.x, size.y) > settings.residentSize) break;
+    entry.tail--;
+  }
+  entry.resident = entry.levelCount;
+  entry.requested = entry.target = entry.tail;
+  entry.lastUsed = frame;
+
+  // Streaming the texture again frees the levels it had
+  auto it = entries.find(texture.get());
+  if (it != entries.end()) {
+    residentBytes -= it->second.bytes;
+    entries.erase(it);
+  }
+
+  texture->BeginStreaming(textureSettings, LevelSize(entry, 0),
+                          entry.levelCount);
+  auto &added = entries[texture.get()] = std::move(entry);
+  for (auto level = added.levelCount; level-- > added.tail;)
+    if (!Upload(added, level)) {
+      std::cerr << "Failed to stream texture with path: "
+                << textureSettings.path << " within the memory budget\n";
+      if (added.resident == added.levelCount)
+        texture->state = AssetState::Failed;
+      break;
+    }
+}
+
+bool TextureStreamer::Upload(Entry &entry, unsigned level) {
+  auto texture = entry.texture.lock();
+  bool uploaded =
+      entry.compressed
+          ? texture->StreamLevel(level, entry.cooked.levels[level],
+                                 entry.cooked.format, PixelUploadRing::active)
+          : texture->StreamLevel(level, entry.levels[level],
+                                 PixelUploadRing::active);
+  if (!uploaded) return false;
+
+  auto bytes = LevelBytes(entry, level);
+  entry.resident = level;
+  entry.bytes += bytes;
+  residentBytes += bytes;
+  statistics.levelsUploaded++;
+  return true;
+}
+
+void TextureStreamer::Evict(Entry &entry) {
+  auto bytes = LevelBytes(entry, entry.resident);
+  entry.texture.lock()->EvictLevel(entry.resident, bytes);
+  entry.resident++;
+  entry.bytes -= bytes;
+  residentBytes -= bytes;
+  statistics.levelsEvicted++;
+}
+
+TextureStreamer::Entry *TextureStreamer::FindEviction() {
+  Entry *found = nullptr;
+  for (auto &pair : entries) {
+    auto &entry = pair.second;
+    if (entry.resident < entry.target &&
+        (!found || entry.lastUsed < found->lastUsed))
+      found = &entry;
+  }
+  return found;
+}
+
+void TextureStreamer::Request(const Texture &texture, float pixels) {
+  if (!texture.IsStreamed()) return;
+  auto it = entries.find(&texture);
+  if (it == entries.end()) return;
+
+  auto &entry = it->second;
+  auto level = Mipmaps::LevelForSize(texture.Size(), pixels, settings.mipBias);
+  entry.requested = std::min(entry.requested, level);
+  entry.lastUsed = frame;
+}
+
+void TextureStreamer::Update() {
+  // Forget textures which were destroyed or loaded again without streaming
+  for (auto it = entries.begin(); it != entries.end();) {
+    auto texture = it->second.texture.lock();
+    if (texture && texture->IsStreamed()) {
+      ++it;
+      continue;
+    }
+    residentBytes -= it->second.bytes;
+    it = entries.erase(it);
+  }
+
+  // Textures which weren't drawn since the last update only want their tail
+  for (auto &pair : entries) {
+    auto &entry = pair.second;
+    entry.target = entry.requested;
+    entry.requested = entry.tail;
+  }
+
+  while (residentBytes > settings.budget) {
+    auto *entry = FindEviction();
+    if (!entry) break;
+    Evict(*entry);
+  }
+
+  std::size_t uploaded = 0;
+  while (uploaded < settings.uploadBytesPerFrame) {
+    // Sharpen the texture furthest from the level it wants first
+    Entry *entry = nullptr;
+    for (auto &pair : entries) {
+      auto &candidate = pair.second;
+      if (candidate.resident > candidate.target &&
+          (!entry || candidate.resident - candidate.target >
+                         entry->resident - entry->target))
+        entry = &candidate;
+    }
+    if (!entry) break;
+
+    auto level = entry->resident - 1;
+    auto bytes = LevelBytes(*entry, level);
+    while (residentBytes + bytes > settings.budget) {
+      auto *victim = FindEviction();
+      if (!victim) break;
+      Evict(*victim);
+    }
+    if (residentBytes + bytes > settings.budget || !Upload(*entry, level))
+      break;
+    uploaded += bytes;
+  }
+
+  statistics.residentBytes = residentBytes;
+  statistics.textures = entries.size();
+  statistics.pendingRequests = 0;
+  for (const auto &pair : entries)
+    if (pair.second.resident > pair.second.target)
+      statistics.pendingRequests +=
+          pair.second.resident - pair.second.target;
+  frame++;
+}
+
+std::ostream &operator<<(std::ostream &os,
+                         const TextureStreamer::Statistics &stats) {
+  os << stats.residentBytes << " bytes resident for " << stats.textures
+     << " streamed textures, " << stats.pendingRequests
+     << " levels pending, " << stats.levelsUploaded << " levels uploaded, "
+     << stats.levelsEvicted << " evicted";
+  return os;
+}
@@ -0,0 +1,128 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <assetstreamer.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("Streaming assets", "[AssetStreamer]") {
+  ThreadPool pool(2);
+  AssetStreamer streamer(pool);
+
+  std::atomic<int> decodes{0};
+  std::vector<int> uploaded;
+  auto decode = [&] {
+    decodes++;
+    return 42;
+  };
+  auto upload = [&](int &value) -> std::size_t {
+    uploaded.push_back(value);
+    return 100;
+  };
+
+  // Pending assets with the same key are only decoded once
+  streamer.Submit("a", decode, upload);
+  streamer.Submit("a", decode, upload);
+  streamer.Submit("b", decode, upload);
+  REQUIRE(streamer.Pending() == 2);
+
+  streamer.Finish();
+  REQUIRE(decodes == 2);
+  REQUIRE(uploaded == std::vector<int>{42, 42, 42});
+  REQUIRE(streamer.Pending() == 0);
+  REQUIRE(streamer.statistics.submitted == 2);
+  REQUIRE(streamer.statistics.uploaded == 2);
+  REQUIRE(streamer.statistics.bytesUploaded == 300);
+}
+
+TEST_CASE("Streaming within a budget", "[AssetStreamer]") {
+  ThreadPool pool(1);
+  AssetStreamer streamer(pool);
+  streamer.budget.bytes = 250;
+
+  unsigned uploads = 0;
+  for (int i = 0; i < 5; i++)
+    streamer.Submit(std::to_string(i), [i] { return i; },
+                    [&](int &) -> std::size_t {
+                      uploads++;
+                      return 100;
+                    });
+
+  // Wait for every decode, so only the budget limits the uploads
+  pool.Submit([] {}).wait();
+
+  streamer.Pump();
+  REQUIRE(uploads == 3);
+  REQUIRE(streamer.Pending() == 2);
+  REQUIRE(streamer.statistics.framesAtBudget == 1);
+
+  streamer.Pump();
+  REQUIRE(uploads == 5);
+  REQUIRE(streamer.Pending() == 0);
+}
+
+TEST_CASE("Streaming assets which fail to decode", "[AssetStreamer]") {
+  ThreadPool pool(1);
+  AssetStreamer streamer(pool);
+
+  std::vector<std::string> uploaded;
+  auto upload = [&](std::string &value) -> std::size_t {
+    uploaded.push_back(value);
+    return value.size();
+  };
+  streamer.Submit("bad",
+                  []() -> std::string { throw std::runtime_error("corrupt"); },
+                  upload);
+  streamer.Submit("good", [] { return std::string("data"); }, upload);
+
+  // The failed asset is uploaded as an empty value rather than throwing
+  REQUIRE_NOTHROW(streamer.Finish());
+  REQUIRE(uploaded == std::vector<std::string>{"", "data"});
+  REQUIRE(streamer.statistics.failed == 1);
+  REQUIRE(streamer.statistics.uploaded == 1);
+}
+
+TEST_CASE("Finishing streamed assets", "[AssetStreamer]") {
+  ThreadPool pool(1);
+  std::vector<bool> finished;
+  auto upload = [](int &) -> std::size_t { return 0; };
+  auto finish = [&](int &, bool uploaded) { finished.push_back(uploaded); };
+
+  {
+    AssetStreamer streamer(pool);
+    streamer.Submit("a", [] { return 1; }, upload, finish);
+    streamer.Finish();
+    REQUIRE(finished == std::vector<bool>{true});
+
+    // Assets dropped with the streamer are finished without being uploaded
+    streamer.Submit("b", [] { return 2; }, upload, finish);
+  }
+  REQUIRE(finished == std::vector<bool>{true, false});
+}
@@ -0,0 +1,97 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <blockcompression.h>
+#include <cstdlib>
+
+// Colour changes along x, so each block's colours lie on a line
+static RawImage Gradient(IVec2 size, bool alpha) {
+  RawImage image;
+  image.size = size;
+  for (int y = 0; y < size.y; y++)
+    for (int x = 0; x < size.x; x++)
+      image.data.insert(
+          image.data.end(),
+          {static_cast<unsigned char>(x * 255 / (size.x - 1)),
+           static_cast<unsigned char>(255 - x * 127 / (size.x - 1)), 64,
+           static_cast<unsigned char>(alpha ? (x + y) * 8 % 256 : 255)});
+  return image;
+}
+
+// The largest difference between the channels of two images
+static int MaxError(const RawImage &a, const RawImage &b, int firstChannel,
+                    int channelCount) {
+  int error = 0;
+  for (std::size_t i = 0; i < a.data.size(); i += 4)
+    for (int c = firstChannel; c < firstChannel + channelCount; c++)
+      error = std::max(error, std::abs(a.data[i + c] - b.data[i + c]));
+  return error;
+}
+
+TEST_CASE("Block compressed sizes", "[BlockCompression]") {
+  REQUIRE(BlockCompression::LevelBytes(BlockFormat::BC1, IVec2{8, 8}) == 32);
+  REQUIRE(BlockCompression::LevelBytes(BlockFormat::BC3, IVec2{8, 8}) == 64);
+  REQUIRE(BlockCompression::LevelBytes(BlockFormat::BC1, IVec2{5, 3}) == 16);
+  REQUIRE(BlockCompression::LevelBytes(BlockFormat::BC1, IVec2{1, 1}) == 8);
+
+  REQUIRE(BlockCompression::ChooseFormat(Gradient(IVec2{4, 4}, false)) ==
+          BlockFormat::BC1);
+  REQUIRE(BlockCompression::ChooseFormat(Gradient(IVec2{4, 4}, true)) ==
+          BlockFormat::BC3);
+}
+
+TEST_CASE("Block compression round trip", "[BlockCompression]") {
+  SECTION("Solid colours which fit in 5:6:5 are exact") {
+    RawImage red;
+    red.size = IVec2{4, 4};
+    for (int i = 0; i < 16; i++)
+      red.data.insert(red.data.end(), {255, 0, 0, 255});
+    auto level = BlockCompression::Compress(red, BlockFormat::BC1);
+    auto back = BlockCompression::Decompress(level, BlockFormat::BC1);
+    REQUIRE(MaxError(red, back, 0, 4) == 0);
+  }
+
+  SECTION("BC1 gradients") {
+    auto image = Gradient(IVec2{30, 18}, false);
+    auto level = BlockCompression::Compress(image, BlockFormat::BC1);
+    REQUIRE(level.data.size() == 8 * 8 * 5);
+    auto back = BlockCompression::Decompress(level, BlockFormat::BC1);
+    REQUIRE(back.size.x == 30);
+    REQUIRE(back.size.y == 18);
+    REQUIRE(MaxError(image, back, 0, 3) <= 8);
+    REQUIRE(MaxError(image, back, 3, 1) == 0);
+  }
+
+  SECTION("BC3 keeps alpha") {
+    auto image = Gradient(IVec2{16, 16}, true);
+    auto level = BlockCompression::Compress(image, BlockFormat::BC3);
+    auto back = BlockCompression::Decompress(level, BlockFormat::BC3);
+    REQUIRE(MaxError(image, back, 0, 3) <= 8);
+    REQUIRE(MaxError(image, back, 3, 1) <= 8);
+  }
+}
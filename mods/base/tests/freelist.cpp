@@ -0,0 +1,78 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <freelist.h>
+
+TEST_CASE("Allocating from a free list", "[FreeListAllocator]") {
+  FreeListAllocator allocator(100);
+
+  auto a = allocator.Allocate(30);
+  auto b = allocator.Allocate(30);
+  REQUIRE(a);
+  REQUIRE(b);
+  REQUIRE(*a == 0);
+  REQUIRE(*b == 30);
+  REQUIRE(allocator.Used() == 60);
+
+  REQUIRE_FALSE(allocator.Allocate(50));
+  REQUIRE(allocator.Allocate(40));
+  REQUIRE_FALSE(allocator.Allocate(1));
+}
+
+TEST_CASE("Aligned allocations", "[FreeListAllocator]") {
+  FreeListAllocator allocator(64);
+
+  REQUIRE(*allocator.Allocate(3) == 0);
+  auto aligned = allocator.Allocate(8, 16);
+  REQUIRE(aligned);
+  REQUIRE(*aligned == 16);
+
+  // The padding before the aligned allocation can still be used
+  REQUIRE(*allocator.Allocate(4) == 3);
+}
+
+TEST_CASE("Freed ranges are merged", "[FreeListAllocator]") {
+  FreeListAllocator allocator(90);
+
+  auto a = *allocator.Allocate(30);
+  auto b = *allocator.Allocate(30);
+  auto c = *allocator.Allocate(30);
+
+  REQUIRE(allocator.Free(a));
+  REQUIRE(allocator.Free(c));
+  REQUIRE(allocator.FreeRangeCount() == 2);
+  REQUIRE_FALSE(allocator.Allocate(60));
+
+  REQUIRE(allocator.Free(b));
+  REQUIRE(allocator.FreeRangeCount() == 1);
+  REQUIRE(allocator.LargestFreeRange() == 90);
+  REQUIRE(allocator.Empty());
+  REQUIRE(allocator.Used() == 0);
+
+  REQUIRE_FALSE(allocator.Free(b));
+}
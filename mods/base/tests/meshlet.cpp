@@ -0,0 +1,130 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <meshlet.h>
+
+// A flat grid of quads in the XY plane, facing +Z
+static void FlatGrid(unsigned size, std::vector<GLuint> &indices,
+                     std::vector<GLfloat> &positions) {
+  for (unsigned y = 0; y <= size; y++)
+    for (unsigned x = 0; x <= size; x++)
+      positions.insert(positions.end(), {GLfloat(x), GLfloat(y), 0.0f});
+
+  for (unsigned y = 0; y < size; y++)
+    for (unsigned x = 0; x < size; x++) {
+      GLuint corner = y * (size + 1) + x;
+      indices.insert(indices.end(), {corner, corner + 1, corner + size + 2,
+                                     corner, corner + size + 2,
+                                     corner + size + 1});
+    }
+}
+
+TEST_CASE("Building meshlets", "[Meshlets]") {
+  std::vector<GLuint> indices;
+  std::vector<GLfloat> positions;
+  FlatGrid(32, indices, positions);
+  auto vertexCount = positions.size() / 3;
+
+  auto meshlets = Meshlets::Build(indices, positions, vertexCount, 64, 48);
+  REQUIRE(meshlets.size() > 1);
+
+  GLuint next = 0;
+  for (const auto &meshlet : meshlets) {
+    // Clusters cover the indices in order without gaps
+    REQUIRE(meshlet.firstIndex == next);
+    REQUIRE(meshlet.indexCount % 3 == 0);
+    REQUIRE(meshlet.indexCount / 3 <= 64);
+    next += meshlet.indexCount;
+
+    std::vector<GLuint> used(indices.begin() + meshlet.firstIndex,
+                             indices.begin() + next);
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+    REQUIRE(used.size() <= 48);
+
+    for (auto index : used) {
+      Vec3 p{positions[index * 3], positions[index * 3 + 1],
+             positions[index * 3 + 2]};
+      REQUIRE(Vec3::Distance(p, meshlet.center) <= meshlet.radius + 1e-4f);
+    }
+
+    // Flat clusters have a cone of zero width around +Z
+    REQUIRE(meshlet.coneAxis.z == Approx(1.0f));
+    REQUIRE(meshlet.coneCutoff == Approx(0.0f).margin(1e-3));
+  }
+  REQUIRE(next == indices.size());
+}
+
+TEST_CASE("Back-facing meshlets", "[Meshlets]") {
+  Meshlet meshlet;
+  meshlet.center = Vec3(0.0f, 0.0f, 0.0f);
+  meshlet.radius = 1.0f;
+  meshlet.coneAxis = Vec3(0.0f, 0.0f, 1.0f);
+  meshlet.coneCutoff = 0.0f;
+
+  REQUIRE(Meshlets::IsBackFacing(meshlet, Vec3(0.0f, 0.0f, -10.0f)));
+  REQUIRE_FALSE(Meshlets::IsBackFacing(meshlet, Vec3(0.0f, 0.0f, 10.0f)));
+  // Seen edge on, part of the cluster may face the camera
+  REQUIRE_FALSE(Meshlets::IsBackFacing(meshlet, Vec3(10.0f, 0.0f, -0.5f)));
+
+  // Wide cones are never culled
+  meshlet.coneCutoff = 1.0f;
+  REQUIRE_FALSE(Meshlets::IsBackFacing(meshlet, Vec3(0.0f, 0.0f, -10.0f)));
+}
+
+TEST_CASE("Culling meshlets", "[Meshlets]") {
+  // With the identity matrix the frustum is the cube from -1 to 1
+  auto frustum = Meshlets::Frustum::FromMatrix(Mat4::identity);
+  REQUIRE(frustum.Intersects(Vec3(0.0f, 0.0f, 0.0f), 0.1f));
+  REQUIRE(frustum.Intersects(Vec3(1.5f, 0.0f, 0.0f), 0.6f));
+  REQUIRE_FALSE(frustum.Intersects(Vec3(1.5f, 0.0f, 0.0f), 0.4f));
+  REQUIRE_FALSE(frustum.Intersects(Vec3(0.0f, 0.0f, -3.0f), 1.0f));
+
+  std::vector<Meshlet> meshlets(4);
+  for (std::size_t i = 0; i < meshlets.size(); i++) {
+    meshlets[i].firstIndex = i * 30;
+    meshlets[i].indexCount = 30;
+    meshlets[i].radius = 0.1f;
+  }
+  meshlets[2].center = Vec3(5.0f, 0.0f, 0.0f);
+
+  std::vector<IndexRange> visible;
+  auto stats =
+      Meshlets::Cull(meshlets, Mat4::identity, Vec3(0.0f, 0.0f, 5.0f), visible);
+  REQUIRE(stats.clusters == 4);
+  REQUIRE(stats.frustumCulled == 1);
+  REQUIRE(stats.triangles == 40);
+  REQUIRE(stats.trianglesDrawn == 30);
+
+  // Neighbouring clusters are merged
+  REQUIRE(visible.size() == 2);
+  REQUIRE(visible[0].first == 0);
+  REQUIRE(visible[0].count == 60);
+  REQUIRE(visible[1].first == 90);
+  REQUIRE(visible[1].count == 30);
+}
@@ -0,0 +1,121 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+// A grid of quads with its triangles in random order
+static std::vector<GLuint> ShuffledGrid(unsigned size) {
+  std::vector<std::array<GLuint, 3>> triangles;
+  for (unsigned y = 0; y < size; y++)
+    for (unsigned x = 0; x < size; x++) {
+      GLuint corner = y * (size + 1) + x;
+      triangles.push_back({corner, corner + 1, corner + size + 1});
+      triangles.push_back({corner + 1, corner + size + 2, corner + size + 1});
+    }
+
+  std::mt19937 random(42);
+  std::shuffle(triangles.begin(), triangles.end(), random);
+
+  std::vector<GLuint> indices;
+  for (const auto &t : triangles)
+    indices.insert(indices.end(), t.begin(), t.end());
+  return indices;
+}
+
+// Sorted list of triangles, ignoring winding-preserving rotations
+static std::vector<std::array<GLuint, 3>>
+Triangles(const std::vector<GLuint> &indices) {
+  std::vector<std::array<GLuint, 3>> triangles;
+  for (std::size_t i = 0; i < indices.size(); i += 3) {
+    std::array<GLuint, 3> t{indices[i], indices[i + 1], indices[i + 2]};
+    std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+    triangles.push_back(t);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+TEST_CASE("Analyzing the vertex cache", "[MeshOptimizer]") {
+  // Two triangles sharing an edge transform four vertices
+  std::vector<GLuint> quad{0, 1, 2, 1, 3, 2};
+  auto stats = MeshOptimizer::AnalyzeVertexCache(quad, 4);
+  REQUIRE(stats.acmr == Approx(2.0f));
+  REQUIRE(stats.atvr == Approx(1.0f));
+}
+
+TEST_CASE("Optimizing for the vertex cache", "[MeshOptimizer]") {
+  constexpr unsigned size = 32;
+  constexpr std::size_t vertexCount = (size + 1) * (size + 1);
+  auto indices = ShuffledGrid(size);
+  auto before = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount);
+
+  auto optimized = indices;
+  MeshOptimizer::OptimizeVertexCache(optimized, vertexCount);
+  auto after = MeshOptimizer::AnalyzeVertexCache(optimized, vertexCount);
+
+  REQUIRE(Triangles(optimized) == Triangles(indices));
+  REQUIRE(after.acmr < before.acmr);
+  REQUIRE(after.acmr < 1.0f);
+}
+
+TEST_CASE("Optimizing for overdraw keeps every triangle", "[MeshOptimizer]") {
+  constexpr unsigned size = 16;
+  constexpr std::size_t vertexCount = (size + 1) * (size + 1);
+  std::vector<GLfloat> positions;
+  for (unsigned y = 0; y <= size; y++)
+    for (unsigned x = 0; x <= size; x++)
+      positions.insert(positions.end(), {float(x), float(y), float(x * y)});
+
+  auto indices = ShuffledGrid(size);
+  MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
+  auto before = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount);
+
+  auto reordered = indices;
+  MeshOptimizer::OptimizeOverdraw(reordered, positions, vertexCount);
+  auto after = MeshOptimizer::AnalyzeVertexCache(reordered, vertexCount);
+
+  REQUIRE(Triangles(reordered) == Triangles(indices));
+  REQUIRE(after.acmr <= before.acmr * 1.05f);
+}
+
+TEST_CASE("Optimizing vertex fetch", "[MeshOptimizer]") {
+  std::vector<GLuint> indices{3, 1, 4, 4, 1, 0};
+  std::vector<GLfloat> values{0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+
+  auto remap = MeshOptimizer::OptimizeVertexFetch(indices, 6);
+  REQUIRE(indices == std::vector<GLuint>{0, 1, 2, 2, 1, 3});
+  REQUIRE(remap[2] == ~0u);
+  REQUIRE(remap[5] == ~0u);
+
+  MeshOptimizer::RemapVertices(values, 1, remap);
+  REQUIRE(values == std::vector<GLfloat>{3.0f, 1.0f, 4.0f, 0.0f});
+}
@@ -0,0 +1,97 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <mipmap.h>
+
+static RawImage Solid(IVec2 size, unsigned char r, unsigned char g,
+                      unsigned char b, unsigned char a) {
+  RawImage image;
+  image.size = size;
+  for (int i = 0; i < size.x * size.y; i++)
+    image.data.insert(image.data.end(), {r, g, b, a});
+  return image;
+}
+
+TEST_CASE("Mip chain sizes", "[Mipmaps]") {
+  REQUIRE(Mipmaps::LevelCount(IVec2{1, 1}) == 1);
+  REQUIRE(Mipmaps::LevelCount(IVec2{256, 256}) == 9);
+  REQUIRE(Mipmaps::LevelCount(IVec2{256, 3}) == 9);
+  REQUIRE(Mipmaps::ChainBytes(IVec2{4, 2}) == (8 + 2 + 1) * 4);
+
+  auto chain = Mipmaps::BuildChain(Solid(IVec2{5, 3}, 0, 0, 0, 0));
+  REQUIRE(chain.size() == 2);
+  REQUIRE(chain[0].size.x == 2);
+  REQUIRE(chain[0].size.y == 1);
+  REQUIRE(chain[1].size.x == 1);
+  REQUIRE(chain[1].size.y == 1);
+  REQUIRE(Mipmaps::BuildChain(Solid(IVec2{1, 1}, 0, 0, 0, 0)).empty());
+}
+
+TEST_CASE("Choosing levels for a size on screen", "[Mipmaps]") {
+  auto size = IVec2{256, 64};
+  REQUIRE(Mipmaps::LevelSize(size, 3).x == 32);
+  REQUIRE(Mipmaps::LevelSize(size, 7).y == 1);
+
+  REQUIRE(Mipmaps::LevelForSize(size, 0.0f) == 0);
+  REQUIRE(Mipmaps::LevelForSize(size, 512.0f) == 0);
+  REQUIRE(Mipmaps::LevelForSize(size, 256.0f) == 0);
+  REQUIRE(Mipmaps::LevelForSize(size, 100.0f) == 1);
+  REQUIRE(Mipmaps::LevelForSize(size, 64.0f) == 2);
+  REQUIRE(Mipmaps::LevelForSize(size, 0.01f) == 8);
+
+  REQUIRE(Mipmaps::LevelForSize(size, 64.0f, 1.0f) == 3);
+  REQUIRE(Mipmaps::LevelForSize(size, 64.0f, -1.0f) == 1);
+  REQUIRE(Mipmaps::LevelForSize(size, 0.0f, 1.5f) == 1);
+}
+
+TEST_CASE("Downsampling", "[Mipmaps]") {
+  SECTION("Solid colours are kept") {
+    auto level = Mipmaps::Downsample(Solid(IVec2{4, 4}, 12, 200, 255, 77));
+    for (int i = 0; i < 4; i++) {
+      REQUIRE(level.data[i * 4] == 12);
+      REQUIRE(level.data[i * 4 + 1] == 200);
+      REQUIRE(level.data[i * 4 + 2] == 255);
+      REQUIRE(level.data[i * 4 + 3] == 77);
+    }
+  }
+
+  SECTION("Colours are averaged in linear space") {
+    // A black and white checkerboard averages to linear grey, which is
+    // brighter than the sRGB midpoint
+    RawImage checker;
+    checker.size = IVec2{2, 2};
+    checker.data = {0,   0,   0,   255, 255, 255, 255, 255,
+                    255, 255, 255, 255, 0,   0,   0,   255};
+    auto level = Mipmaps::Downsample(checker);
+    REQUIRE(level.size.x == 1);
+    REQUIRE(level.size.y == 1);
+    REQUIRE(level.data[0] >= 187);
+    REQUIRE(level.data[0] <= 189);
+    REQUIRE(level.data[3] == 255);
+  }
+}
@@ -0,0 +1,56 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <stringhash.h>
+
+#include <string>
+
+TEST_CASE("Hashing strings at compile time", "[StringHash]") {
+  constexpr auto hash = HashString("pointLights");
+  static_assert(hash == HashString("pointLights"));
+  static_assert(hash != HashString("pointLight"));
+
+  // Known FNV-1a values
+  static_assert(HashString("") == 14695981039346656037ull);
+  static_assert(HashString("a") == 0xaf63dc4c8601ec8cull);
+
+  REQUIRE(HashString(std::string("pointLights")) == hash);
+}
+
+TEST_CASE("Continuing a hash", "[StringHash]") {
+  static_assert(HashString(".location", HashString("pointLights[0]")) ==
+                HashString("pointLights[0].location"));
+
+  constexpr auto arrayName = HashString("pointLights");
+  static_assert(HashIndexed(arrayName, 0) == HashString("pointLights[0]"));
+
+  for (unsigned i : {1u, 9u, 10u, 123u, 4294967295u}) {
+    auto name = "pointLights[" + std::to_string(i) + ']';
+    REQUIRE(HashIndexed(arrayName, i) == HashString(name));
+  }
+}
@@ -0,0 +1,114 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <vertexlayout.h>
+
+using Layout = VertexLayout<VertexLayoutAttribute<0, VertexFormats::Float3>,
+                            VertexLayoutAttribute<1, VertexFormats::Half2>,
+                            VertexLayoutAttribute<2, VertexFormats::Int2101010>>;
+
+TEST_CASE("Vertex layout offsets and stride", "[VertexLayout]") {
+  static_assert(Layout::stride == 20);
+  static_assert(Layout::offsets[0] == 0);
+  static_assert(Layout::offsets[1] == 12);
+  static_assert(Layout::offsets[2] == 16);
+
+  auto attributes = Layout::Describe();
+  REQUIRE(attributes.size() == 3);
+  REQUIRE(attributes[1].index == 1);
+  REQUIRE(attributes[1].type == GL_HALF_FLOAT);
+  REQUIRE(attributes[2].components == 4);
+  REQUIRE(attributes[2].normalized == GL_TRUE);
+}
+
+TEST_CASE("Half float conversion", "[VertexLayout]") {
+  using namespace VertexFormats;
+  REQUIRE(ToHalf(0.0f) == 0x0000);
+  REQUIRE(ToHalf(1.0f) == 0x3c00);
+  REQUIRE(ToHalf(-2.0f) == 0xc000);
+  REQUIRE(ToHalf(65504.0f) == 0x7bff);
+  REQUIRE(ToHalf(1e6f) == 0x7c00);
+
+  for (float f : {0.5f, 0.25f, 0.333f, 0.999f, 1e-4f, -0.75f}) {
+    auto roundTrip = FromHalf(ToHalf(f));
+    REQUIRE(roundTrip == Approx(f).epsilon(1e-3));
+  }
+
+  // Subnormal halves have a fixed precision of 2^-24
+  REQUIRE(FromHalf(ToHalf(1e-5f)) == Approx(1e-5f).margin(6e-8));
+}
+
+TEST_CASE("Packing interleaved vertices", "[VertexLayout]") {
+  std::vector<GLfloat> positions{1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f},
+      uvs{0.5f, 1.0f, 0.0f, 0.25f}, normals{0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f};
+
+  auto packed = Layout::Pack({&positions, &uvs, &normals}, 2);
+  REQUIRE(packed.stride == 20);
+  REQUIRE(packed.data.size() == 40);
+
+  GLfloat position[3];
+  std::memcpy(position, &packed.data[20], sizeof(position));
+  REQUIRE(position[0] == 4.0f);
+  REQUIRE(position[2] == 6.0f);
+
+  std::uint16_t uv[2];
+  std::memcpy(uv, &packed.data[12], sizeof(uv));
+  REQUIRE(uv[0] == VertexFormats::ToHalf(0.5f));
+  REQUIRE(uv[1] == VertexFormats::ToHalf(1.0f));
+
+  std::uint32_t normal;
+  std::memcpy(&normal, &packed.data[16], sizeof(normal));
+  // z = 511 in the third 10 bits
+  REQUIRE(normal == (511u << 20));
+
+  SECTION("Missing attributes are zeroed") {
+    std::vector<GLfloat> none;
+    auto noUVs = Layout::Pack({&positions, &none, &normals}, 2);
+    REQUIRE(noUVs.data[12] == 0);
+    REQUIRE(noUVs.data[13] == 0);
+  }
+}
+
+TEST_CASE("Oct-encoding normals", "[VertexLayout]") {
+  using namespace VertexFormats;
+  const float normals[][3] = {{0.0f, 0.0f, 1.0f},  {0.0f, 0.0f, -1.0f},
+                              {1.0f, 0.0f, 0.0f},  {0.0f, -1.0f, 0.0f},
+                              {0.6f, 0.0f, -0.8f}, {0.48f, -0.6f, 0.64f}};
+  for (const auto &n : normals) {
+    float encoded[2], decoded[3];
+    OctEncode(n, encoded);
+    REQUIRE(std::abs(encoded[0]) <= 1.0f);
+    REQUIRE(std::abs(encoded[1]) <= 1.0f);
+
+    // Through the 16 bit storage format
+    for (auto &e : encoded) e = ToSNorm(e, 16) / 32767.0f;
+    OctDecode(encoded, decoded);
+    for (int i = 0; i < 3; i++)
+      REQUIRE(decoded[i] == Approx(n[i]).margin(1e-4));
+  }
+}
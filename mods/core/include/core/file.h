@@ -27,6 +27,8 @@ SOFTWARE.
 #ifndef _CORE__FILE_H
 #define _CORE__FILE_H
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <stdexcept>
@@ -58,6 +60,91 @@ public:
    * @param out The string buffer to read the file into
    */
   static void Read(const std::string &path, std::string &out);
+
+  /*
+   * Writes a string to a file, replacing its contents. The file's directory
+   * must already exist
+   * @param path The path of the file
+   * @param data The data to write
+   */
+  static void Write(const std::string &path, const std::string &data);
+
+  struct Info {
+    std::uint64_t size;
+
+    /*
+     * Time of the last modification, in nanoseconds since the epoch
+     */
+    std::int64_t modified;
+  };
+
+  /*
+   * Gets the size and modification time of a file
+   * @param path The path of the file
+   * @param out The file's information
+   * @returns false if the file could not be accessed
+   */
+  static bool Stat(const std::string &path, Info &out);
+
+  /*
+   * Hashes a file's contents with 64-bit FNV-1a, like HashString does
+   * @param path The path of the file
+   * @returns the hash, or 0 if the file could not be mapped
+   */
+  static std::uint64_t Hash(const std::string &path);
+
+  /*
+   * Identifies the version of a file, such as the source of a cached file
+   */
+  struct Stamp {
+    std::uint64_t size;
+    std::int64_t modified;
+    std::uint64_t hash;
+  };
+
+  /*
+   * Gets the stamp of a file's current version
+   * @param path The path of the file
+   * @param out The file's stamp
+   * @returns false if the file could not be accessed
+   */
+  static bool GetStamp(const std::string &path, Stamp &out);
+
+  /*
+   * Checks whether a file is still the version a stamp was taken of. The
+   * contents are only hashed if the time changed, as version control and
+   * copying can change the time without changing the contents
+   * @param path The path of the file
+   * @param stamp The stamp to compare with
+   * @returns false if the file changed or could not be accessed
+   */
+  static bool Matches(const std::string &path, const Stamp &stamp);
+};
+
+/*
+ * A file mapped read-only into memory, which is unmapped when destroyed
+ */
+class MappedFile {
+  const char *data = nullptr;
+  std::size_t size = 0;
+
+public:
+  MappedFile() {}
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() { Close(); }
+
+  /*
+   * Maps a file, unmapping any file mapped before
+   * @param path The path of the file
+   * @returns false if the file could not be mapped
+   */
+  bool Open(const std::string &path);
+  void Close();
+
+  bool IsOpen() const { return data != nullptr; }
+  const char *Data() const { return data; }
+  std::size_t Size() const { return size; }
 };
 
 /*
@@ -87,6 +174,13 @@ public:
    */
   static bool Exists(const std::string &path);
 
+  /*
+   * Creates a directory, along with any missing parent directories
+   * @param path The path of the directory
+   * @returns true if the directory exists afterwards
+   */
+  static bool Create(const std::string &path);
+
   /*
    * Gets all the files inside the directory recursively
    * @param dir The path of the directory
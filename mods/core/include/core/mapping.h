@@ -58,7 +58,13 @@ struct LoadCallHelper<std::unique_ptr<ValueObj>, Data> {
   }
 };
 
-template <typename Value, typename Data, typename Hash = std::hash<std::string>>
+/*
+ * Maps names to values which are loaded from their data the first time they are
+ * requested. The Loader type may be replaced to change how values are created
+ * from their data
+ */
+template <typename Value, typename Data, typename Hash = std::hash<std::string>,
+          typename Loader = LoadCallHelper<Value, Data>>
 class JSONDeferredReadMapping {
   std::unordered_map<std::string, Value, Hash> values;
   std::unordered_map<std::string, Data, Hash> notLoaded;
@@ -77,8 +83,9 @@ public:
     auto dataIt = notLoaded.find(key);
     // We assume that dataIt is a valid iterator
     Value val;
-    // Value type may be a smart pointer. This helper class handles that correctly
-    LoadCallHelper<Value, Data>::Load(val, dataIt->second);
+    // Value type may be a smart pointer. The default loader handles that
+    // correctly
+    Loader::Load(val, dataIt->second);
 
     notLoaded.erase(dataIt);
     values[key] = val;
@@ -89,9 +96,9 @@ public:
   auto &GetDeferred() { return notLoaded; }
 };
 
-template <typename Value, typename Data, typename Hash>
-struct JSONImpl<JSONDeferredReadMapping<Value, Data, Hash>> {
-  static void Read(JSONDeferredReadMapping<Value, Data, Hash> &out, const JSON::Value &value, const JSON::ReadData &data) {
+template <typename Value, typename Data, typename Hash, typename Loader>
+struct JSONImpl<JSONDeferredReadMapping<Value, Data, Hash, Loader>> {
+  static void Read(JSONDeferredReadMapping<Value, Data, Hash, Loader> &out, const JSON::Value &value, const JSON::ReadData &data) {
     auto t = Trace::Pusher{data.trace, "JSONDeferredMapping"};
     JSON::Read(out.GetDeferred(), value, data);
   }
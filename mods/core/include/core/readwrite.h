@@ -84,13 +84,19 @@ struct ParseException : public std::exception {};
   throw ParseException{};
 }
 
+/*
+ * Messages are taken as they are given, such as string literals, so that a
+ * std::string is only made for them when the check fails
+ */
+template <typename Message>
 inline void ParseFailIf(bool expr, const ReadData &data,
-                        const std::string &message) {
+                        const Message &message) {
   if (expr) ParseError(data, message);
 }
 
+template <typename Message>
 inline void ParseAssert(bool expr, const ReadData &data,
-                        const std::string &message) {
+                        const Message &message) {
   if (!expr) ParseError(data, message);
 }
 
@@ -27,18 +27,44 @@ SOFTWARE.
 #ifndef _CORE__TRACE_H
 #define _CORE__TRACE_H
 
-#include <stack>
+#include <array>
+#include <cstddef>
 #include <string>
 
+/*
+ * The functions a JSON read is nested in, shown when it fails. Entries are
+ * kept as pointers in a fixed-size ring, so tracing never allocates. Once the
+ * trace is deeper than 'capacity', the innermost entries replace the outermost
+ * ones, which are then counted but not shown
+ */
 class Trace {
-  std::stack<std::string> trace;
+public:
+  static constexpr const std::size_t capacity = 64;
+
+private:
+  std::array<const char *, capacity> trace;
+  std::size_t depth = 0;
+
+  // The number of innermost entries still held, which is less than the depth
+  // once outer entries have been replaced
+  std::size_t known = 0;
 
 public:
-  void Push(const std::string &funcName)
-    { trace.push(funcName); }
+  /*
+   * @param funcName Must outlive the entry, such as a string literal
+   */
+  void Push(const char *funcName) {
+    trace[depth++ % capacity] = funcName;
+    if (known < capacity) known++;
+  }
 
-  void Pop()
-    { trace.pop(); }
+  void Pop() {
+    if (!depth) return;
+    depth--;
+    if (known) known--;
+  }
+
+  std::size_t Depth() const { return depth; }
 
   /*
    * Display the stack trace. The trace is empty once executed
@@ -52,7 +78,7 @@ public:
     Trace &trace;
 
   public:
-    Pusher(Trace &t, const std::string &funcName) : trace(t)
+    Pusher(Trace &t, const char *funcName) : trace(t)
       { trace.Push(funcName); }
     ~Pusher()
       { trace.Pop(); }
@@ -60,4 +86,3 @@ public:
 };
 
 #endif // _CORE__TRACE_H
-
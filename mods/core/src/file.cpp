@@ -28,9 +28,13 @@ SOFTWARE.
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <cerrno>
 #include <cstdlib>
 #if defined(__linux__) || defined(__CYGWIN__)
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #else
 #error Classes 'File' and 'Directory' only supported on linux and cygwin
@@ -55,6 +59,79 @@ void File::Read(const std::string &path, std::string &out) {
   }
 }
 
+void File::Write(const std::string &path, const std::string &data) {
+  std::string fullPath = ::buildPath + path;
+  std::ofstream file{fullPath, std::ios::out | std::ios::binary | std::ios::trunc};
+  if (!file.is_open())
+    throw FileAccessException("Unable to open file for writing: " + fullPath);
+  file.write(data.data(), data.size());
+  if (!file)
+    throw FileAccessException("Unable to write file: " + fullPath);
+}
+
+bool File::Stat(const std::string &path, Info &out) {
+  struct stat st;
+  if (stat((::buildPath + path).c_str(), &st) != 0) return false;
+  out.size = st.st_size;
+  out.modified =
+      static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+      st.st_mtim.tv_nsec;
+  return true;
+}
+
+std::uint64_t File::Hash(const std::string &path) {
+  MappedFile file;
+  if (!file.Open(path)) return 0;
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < file.Size(); i++) {
+    hash ^= static_cast<unsigned char>(file.Data()[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+bool File::GetStamp(const std::string &path, Stamp &out) {
+  Info info;
+  if (!Stat(path, info)) return false;
+  out = {info.size, info.modified, Hash(path)};
+  return true;
+}
+
+bool File::Matches(const std::string &path, const Stamp &stamp) {
+  Info info;
+  if (!Stat(path, info) || info.size != stamp.size) return false;
+  return info.modified == stamp.modified || Hash(path) == stamp.hash;
+}
+
+bool MappedFile::Open(const std::string &path) {
+  Close();
+
+  int fd = open((::buildPath + path).c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  // The mapping stays valid after the descriptor is closed
+  void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return false;
+
+  data = static_cast<const char *>(mapping);
+  size = st.st_size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (!data) return;
+  munmap(const_cast<char *>(data), size);
+  data = nullptr;
+  size = 0;
+}
+
 void Directory::_GetFilesRecursive(const std::string &dir, std::vector<std::string> &out) {
   std::vector<std::string> tmp;
   std::string d = ::buildPath + dir;
@@ -78,6 +155,16 @@ bool Directory::Exists(const std::string &path) {
   return access(tmp.c_str(), F_OK) == 0;
 }
 
+bool Directory::Create(const std::string &path) {
+  std::string fullPath{::buildPath + path};
+  for (size_t i = 1; i <= fullPath.size(); i++) {
+    if (i != fullPath.size() && fullPath[i] != '/') continue;
+    auto parent = fullPath.substr(0, i);
+    if (mkdir(parent.c_str(), 0755) != 0 && errno != EEXIST) return false;
+  }
+  return Exists(path);
+}
+
 void Directory::GetFilesRecursive(const std::string &dir, std::vector<std::string> &out) {
   std::string tmp{::buildPath + dir};
   if (tmp[tmp.size() - 1] == '/')
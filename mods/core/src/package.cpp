@@ -209,6 +209,7 @@ bool Package::Run(const RunOptions &options) {
   if (!options.quiet)
     std::clog << TermColor::FG_GREEN << "-- Running '" << name << '\'' << TermColor::FG_DEFAULT << '\n';
   bool ret = true;
+  args = options.args;
   do {
     restartOptions = RestartOptions();
     Library lib;
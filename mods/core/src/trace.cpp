@@ -29,13 +29,15 @@ SOFTWARE.
 
 void Trace::Unwind(const std::string &error) {
   std::cerr << "JSON: Error: " << error << '\n';
-  if (trace.size() == 0)
+  if (depth == 0)
     return;
-  std::cerr << "In: " << trace.top() << '\n';
-  trace.pop();
-  for (auto i = trace.size(); i > 0; i--) {
-    std::cerr << "  called by: " << trace.top() << '\n';
-    trace.pop();
-  }
+  // Entries below 'dropped' were replaced by deeper ones
+  auto i = depth, dropped = depth - known;
+  if (i > dropped)
+    std::cerr << "In: " << trace[--i % capacity] << '\n';
+  while (i > dropped)
+    std::cerr << "  called by: " << trace[--i % capacity] << '\n';
+  if (dropped)
+    std::cerr << "  ... " << dropped << " more\n";
+  depth = known = 0;
 }
-
@@ -0,0 +1,109 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <test/allocations.h>
+#include <trace.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Redirects std::cerr for as long as it exists
+class CaptureErrors {
+  std::ostringstream captured;
+  std::streambuf *original;
+
+public:
+  CaptureErrors() : original(std::cerr.rdbuf(captured.rdbuf())) {}
+  ~CaptureErrors() { std::cerr.rdbuf(original); }
+
+  std::string Text() const { return captured.str(); }
+};
+
+TEST_CASE("Tracing does not allocate", "[Trace]") {
+  Trace trace;
+  auto before = Allocations();
+  {
+    auto a = Trace::Pusher{trace, "JSON::GetMember"};
+    for (int i = 0; i < 100; i++) trace.Push("float");
+    REQUIRE(trace.Depth() == 101);
+    for (int i = 0; i < 100; i++) trace.Pop();
+  }
+  REQUIRE(Allocations() == before);
+  REQUIRE(trace.Depth() == 0);
+}
+
+TEST_CASE("Unwinding the trace", "[Trace]") {
+  Trace trace;
+  CaptureErrors errors;
+  {
+    auto a = Trace::Pusher{trace, "Scene"};
+    auto b = Trace::Pusher{trace, "Vec3"};
+    auto c = Trace::Pusher{trace, "float"};
+    trace.Unwind("Must be a number");
+    REQUIRE(trace.Depth() == 0);
+  }
+
+  // The pushers popping after the unwind leave the trace empty
+  REQUIRE(trace.Depth() == 0);
+  REQUIRE(errors.Text() == "JSON: Error: Must be a number\n"
+                           "In: float\n"
+                           "  called by: Vec3\n"
+                           "  called by: Scene\n");
+}
+
+TEST_CASE("Unwinding a trace deeper than its capacity", "[Trace]") {
+  Trace trace;
+  CaptureErrors errors;
+  trace.Push("Scene");
+  for (std::size_t i = 0; i < Trace::capacity; i++) trace.Push("NNode");
+  trace.Push("float");
+  trace.Unwind("Must be a number");
+
+  // The innermost entries are shown, and the outermost ones counted
+  std::string expected = "JSON: Error: Must be a number\n"
+                         "In: float\n";
+  for (std::size_t i = 0; i < Trace::capacity - 1; i++)
+    expected += "  called by: NNode\n";
+  expected += "  ... 2 more\n";
+  REQUIRE(errors.Text() == expected);
+}
+
+TEST_CASE("Unwinding after returning from past the capacity", "[Trace]") {
+  Trace trace;
+  CaptureErrors errors;
+  trace.Push("Scene");
+  for (std::size_t i = 0; i < Trace::capacity + 4; i++) trace.Push("NNode");
+  for (std::size_t i = 0; i < Trace::capacity; i++) trace.Pop();
+
+  // The entries the deeper ones replaced can't be shown
+  REQUIRE(trace.Depth() == 5);
+  trace.Unwind("Must be a number");
+  REQUIRE(errors.Text() == "JSON: Error: Must be a number\n"
+                           "  ... 5 more\n");
+}
@@ -24,8 +24,11 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <base/assetstreamer.h>
 #include <base/input.h>
 #include <base/mesh.h>
+#include <base/pixeluploadring.h>
+#include <base/texturestreamer.h>
 #include <cstdlib>
 #include <game.h>
 #include <iostream>
@@ -55,6 +58,9 @@ void Game::Start() {
     glfwSetTime(0.0);
 
     glfwPollEvents();
+    if (PixelUploadRing::active) PixelUploadRing::active->Reclaim();
+    if (AssetStreamer::active) AssetStreamer::active->Pump();
+    if (TextureStreamer::active) TextureStreamer::active->Update();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     tickManager.CallAll(delta);
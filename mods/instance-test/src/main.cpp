@@ -25,6 +25,7 @@ SOFTWARE.
 */
 
 #include <base/resources.h>
+#include <cmath>
 #include <core/file.h>
 #include <game/game.h>
 #include <game/spectatorcamera.h>
@@ -37,14 +38,32 @@ SOFTWARE.
 #include <scene/scene.h>
 #include <scene/tagmanager.h>
 
+using InstanceConfig =
+    MeshRenderConfigs::Compose<MeshRenderConfigs::Instanced::DynamicTransformation,
+                               MeshRenderConfigs::Instanced::Layers,
+                               MeshRenderConfigs::Standard,
+                               MeshRenderConfigs::Textures>;
+
 class MyGame : public Game {
+  // Outlives the scene, whose meshes are allocated from its buffer arenas
+  Resources resources;
+  static constexpr const auto width = 30, length = 30, height = 30;
+  static constexpr const auto instanceCount = width * length * height;
+  static constexpr const auto spacing = 4.5f;
+
   Scene scene;
   std::unique_ptr<InstancedMesh> mesh;
+  std::shared_ptr<InstanceConfig> config;
   KeyState::RegistrationType escapeRegistration;
+  float time = 0.0f;
+
+  void AnimateInstances(float delta);
 
 public:
   MyGame();
   void Tick(float delta) override {
+    AnimateInstances(delta);
+
     glClearColor(0.3f, 0.6f, 0.6f, 1.0f);
     scene.Render();
 
@@ -63,14 +82,28 @@ public:
   }
 };
 
+void MyGame::AnimateInstances(float delta) {
+  time += delta;
+
+  auto matrices = config->Map(instanceCount);
+  auto it = matrices.begin();
+  if (!matrices.Empty())
+    for (int i = 0; i < width; i++)
+      for (int j = 0; j < length; j++)
+        for (int k = 0; k < height; k++) {
+          float bob = std::sin(time * 2.0f + (i + j + k) * 0.3f);
+          *it++ = Mat4::Translate(i * spacing, j * spacing + bob, k * spacing);
+        }
+  config->Unmap();
+}
+
 MyGame::MyGame() {
   escapeRegistration =
       GetInput().RegisterKeyCallback(KeyCode::Escape, [](InputEvent action) {
         if (action == InputEvent::Press) Window::Active()->Close();
       });
 
-  auto resources = std::make_unique<Resources>();
-  Resources::active = resources.get();
+  Resources::active = &resources;
 
   auto typeManager = std::make_shared<JSON::TypeManager>();
   JSON::ReadData readData{typeManager};
@@ -84,30 +117,41 @@ MyGame::MyGame() {
 
   JSON::GetDataFromFile(shaders, "mods/instance-test/res/shaders.json");
   JSON::Read(Resources::active->shaders, shaders, readData);
+  Resources::active->SubmitShaders();
 
   JSON::GetDataFromFile(textures, "mods/instance-test/res/textures.json");
   JSON::Read(Resources::active->textures, textures, readData);
+  Resources::active->PackTextures();
+
+  config = std::make_shared<InstanceConfig>();
+  auto sphere = Resources::active->textures.Get("sphere");
+  auto checker = Resources::active->textures.Get("checker");
+  config->textures.push_back({"material.diffuse", sphere});
+
+  // When both textures were packed into the same array, alternate instances
+  // sample the other layer, which still draws every instance in one call
+  if (sphere->IsLayer() && sphere->GetArray() == checker->GetArray()) {
+    auto &layers = config->Get<MeshRenderConfigs::Instanced::Layers>().layers;
+    layers.reserve(instanceCount);
+    for (int i = 0; i < instanceCount; i++)
+      layers.push_back(static_cast<GLfloat>(
+          i % 2 ? checker->Layer() : sphere->Layer()));
+  }
 
-  using namespace MeshRenderConfigs;
-  auto config = std::make_shared<
-      Compose<Instanced::Transformation, Standard, Textures>>();
-  config->textures.push_back(
-      {"material.diffuse", Resources::active->textures.Get("sphere")});
-
-  constexpr const auto width = 5, length = 5, height = 7;
-  constexpr const auto instanceCount = width * length * height;
-  constexpr const auto spacing = 4.5f;
-
-  std::vector<Mat4> mats;
-  mats.reserve(instanceCount);
-  for (int i = 0; i < width; i++)
-    for (int j = 0; j < length; j++)
-      for (int k = 0; k < height; k++)
-        mats.push_back(Mat4::Translate(i * spacing, j * spacing, k * spacing));
-  config->transformationMatrices = mats;
-
+  Shader::Definitions definitions;
+  config->ForEach([&](auto &c) {
+    using Type = std::remove_reference_t<decltype(c)>;
+    if constexpr (MeshRenderConfigs::ImplementsAddDefinitions<Type>::value)
+      c.AddDefinitions(definitions);
+  });
+  auto shader = definitions.empty()
+                    ? Resources::active->shaders.Get("instanced")
+                    : Resources::active->GetShaderVariant("instanced",
+                                                          definitions);
+
+  // Instance data is streamed in every frame by AnimateInstances
   mesh = MeshData{"mods/instance-test/res/sphere.blend"}.GenerateInstancedMesh(
-      Resources::active->shaders.Get("instanced"), config, *config, instanceCount);
+      shader, config, *config, instanceCount);
 }
 
 extern "C" bool InstanceTest_Run() {
@@ -24,22 +24,31 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <algorithm>
 #include <base/resources.h>
+#include <base/gpumemory.h>
+#include <base/shadercache.h>
+#include <base/texturecache.h>
 #include <core/file.h>
+#include <core/package.h>
 #include <game/game.h>
 #include <game/spectatorcamera.h>
+#include <scene/assetprefetch.h>
 #include <scene/camera.h>
 #include <scene/mesh.h>
 #include <scene/meshconfig.h>
 #include <scene/pointlight.h>
 #include <scene/scene.h>
+#include <scene/scenecache.h>
 #include <scene/tagmanager.h>
 
 class MyGame : public Game {
+  // Outlives the scene, whose meshes are allocated from its buffer arenas
+  Resources resources;
   Scene scene;
   NNode *tagged, *shape;
   NPointLight *pointLight;
-  KeyState::RegistrationType escapeRegistration;
+  KeyState::RegistrationType escapeRegistration, statisticsRegistration;
 
 public:
   MyGame();
@@ -74,11 +83,20 @@ MyGame::MyGame() {
       GetInput().RegisterKeyCallback(KeyCode::Escape, [](InputEvent action) {
         if (action == InputEvent::Press) Window::Active()->Close();
       });
+  // Reports how many triangles cluster culling and how many uniform uploads
+  // shadowing saved since the last report
+  statisticsRegistration =
+      GetInput().RegisterKeyCallback(KeyCode::C, [](InputEvent action) {
+        if (action != InputEvent::Press) return;
+        std::cout << "Cluster culling: " << Mesh::cullStatistics << '\n';
+        std::cout << "Uniforms: " << Shader::uniformStatistics << '\n';
+        Mesh::cullStatistics = {};
+        Shader::uniformStatistics = {};
+      });
 
   auto tm = std::make_unique<TagManager>();
   TagManager::active = tm.get();
-  auto resources = std::make_unique<Resources>();
-  Resources::active = resources.get();
+  Resources::active = &resources;
 
   auto typeManager = std::make_shared<JSON::TypeManager>();
   JSON::ReadData readData{typeManager};
@@ -101,16 +119,31 @@ MyGame::MyGame() {
         MakeGenerator<Compose<Single, Standard, Textures, Lit>>();
   }
 
-  JSON::Document shaders, textures, sceneDoc;
+  JSON::Document shaders, variants, textures;
 
   JSON::GetDataFromFile(shaders, "mods/json-load/res/shaders.json");
   JSON::Read(Resources::active->shaders, shaders, readData);
+  Resources::active->SubmitShaders();
+
+  // Compiles the variants the scene's meshes will ask for while other assets
+  // load, rather than when the scene is read
+  JSON::GetDataFromFile(variants, "mods/json-load/res/variants.json");
+  std::vector<ShaderVariantRequest> warmUp;
+  JSON::Read(warmUp, variants, readData);
+  Resources::active->WarmUpShaderVariants(warmUp);
 
   JSON::GetDataFromFile(textures, "mods/json-load/res/textures.json");
   JSON::Read(Resources::active->textures, textures, readData);
+  std::clog << "Packed textures into " << Resources::active->PackTextures()
+            << " arrays\n";
 
-  JSON::GetDataFromFile(sceneDoc, "mods/json-load/res/scene.json");
-  JSON::Read(scene, sceneDoc, readData);
+  SceneCache::ReadScene("mods/json-load/res/scene.json", scene, readData);
+
+  ShaderBinaryCache::Report(std::cout);
+  TextureCache::Report(std::cout);
+  SceneCache::Report(std::cout);
+  Resources::active->shaderVariants.Report(std::cout);
+  GPUMemory::Report(std::cout);
 
   tagged = TagManager::active->Get<NNode>("model");
   shape = TagManager::active->Get<NNode>("shape");
@@ -118,6 +151,11 @@ MyGame::MyGame() {
 }
 
 extern "C" bool JsonLoad_Run() {
+  // Lets the time taken to read the scene be compared without prefetching
+  const auto &args = Package::args;
+  if (std::find(args.begin(), args.end(), "--no-prefetch") != args.end())
+    AssetPrefetch::enabled = false;
+
   auto window = std::make_unique<Window>(IVec2{640, 480});
   MyGame().Start();
   return true;
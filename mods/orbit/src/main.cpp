@@ -24,7 +24,10 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <base/assetstreamer.h>
+#include <base/pixeluploadring.h>
 #include <base/resources.h>
+#include <base/texturestreamer.h>
 #include <core/file.h>
 #include <game/game.h>
 #include <game/spectatorcamera.h>
@@ -32,9 +35,17 @@ SOFTWARE.
 #include <scene/mesh.h>
 #include <scene/meshconfig.h>
 #include <scene/scene.h>
+#include <scene/scenecache.h>
 #include <scene/tagmanager.h>
 
 class MyGame : public Game {
+  // Outlives the scene, whose meshes are allocated from its buffer arenas
+  Resources resources;
+  // Both outlive the asset streamer, whose pending uploads use them and which
+  // releases what it staged when dropped
+  PixelUploadRing uploadRing;
+  TextureStreamer textureStreamer;
+  AssetStreamer assetStreamer;
   Scene scene;
   NMesh *sphere;
   Vec3 rot;
@@ -86,6 +97,14 @@ MyGame::MyGame() {
         if (action == InputEvent::Press) Window::Active()->Close();
       }));
 
+  keyRegistrations.emplace_back(
+      GetInput().RegisterKeyCallback(KeyCode::T, [this](InputEvent action) {
+        if (action != InputEvent::Press) return;
+        std::clog << assetStreamer.statistics << '\n'
+                  << textureStreamer.statistics << '\n'
+                  << uploadRing.statistics << '\n';
+      }));
+
   keyRegistrations.emplace_back(
       GetInput().RegisterKeyCallback(KeyCode::U, [this](InputEvent action) {
         if (action == InputEvent::Press) go = !go;
@@ -123,8 +142,10 @@ MyGame::MyGame() {
 
   auto tm = std::make_unique<TagManager>();
   TagManager::active = tm.get();
-  auto resources = std::make_unique<Resources>();
-  Resources::active = resources.get();
+  Resources::active = &resources;
+  PixelUploadRing::active = &uploadRing;
+  AssetStreamer::active = &assetStreamer;
+  TextureStreamer::active = &textureStreamer;
 
   auto typeManager = std::make_shared<JSON::TypeManager>();
   JSON::ReadData readData{typeManager};
@@ -141,16 +162,16 @@ MyGame::MyGame() {
 
   scene.SetActive();
 
-  JSON::Document shaders, textures, sceneDoc;
+  JSON::Document shaders, textures;
 
   JSON::GetDataFromFile(shaders, "mods/orbit/res/shaders.json");
   JSON::Read(Resources::active->shaders, shaders, readData);
+  Resources::active->SubmitShaders();
 
   JSON::GetDataFromFile(textures, "mods/orbit/res/textures.json");
   JSON::Read(Resources::active->textures, textures, readData);
 
-  JSON::GetDataFromFile(sceneDoc, "mods/orbit/res/scene.json");
-  JSON::Read(scene, sceneDoc, readData);
+  SceneCache::ReadScene("mods/orbit/res/scene.json", scene, readData);
 
   sphere = TagManager::active->Get<NMesh>("sphere");
 }
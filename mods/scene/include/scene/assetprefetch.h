@@ -0,0 +1,170 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _SCENE__ASSET_PREFETCH_H
+#define _SCENE__ASSET_PREFETCH_H
+
+#include <base/blockcompression.h>
+#include <base/image.h>
+#include <base/texture.h>
+#include <core/readwrite.h>
+#include <core/threadpool.h>
+#include <functional>
+#include <future>
+#include <scene/meshload.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Scene;
+
+/*
+ * Imports the meshes and decodes the textures a scene references on a thread
+ * pool before the scene is read. Only file access and decoding happen on the
+ * workers; uploads to the GPU and node construction stay on the main thread.
+ *
+ * While a prefetch is active, mesh loading takes its data from the prefetch
+ * instead of importing it, and named textures are uploaded from the decoded
+ * images. Textures are read from the TextureCache when they have been cooked
+ */
+class AssetPrefetch {
+  struct PendingMesh {
+    std::future<MeshData> future;
+    MeshData data;
+    bool ready = false;
+    // How many meshes in the scene use the path
+    unsigned users = 0;
+  };
+
+  struct PendingTexture {
+    std::future<bool> future;
+
+    // The cooked texture if it is up to date, and the decoded image otherwise
+    CompressedImage cooked;
+    RawImage image;
+    bool isCooked = false;
+
+    TextureSettings settings;
+  };
+
+  std::unordered_map<std::string, PendingMesh> meshes;
+  std::unordered_map<std::string, PendingTexture> textures;
+
+  void Collect(const JSON::Value &value, ThreadPool &pool);
+
+  // Submits a mesh, or counts another user of it if it was already submitted
+  void StartMesh(const std::string &path, ThreadPool &pool);
+
+  // Submits a texture unless it was already submitted, has been loaded, is
+  // streamed or isn't one of the active resources' textures
+  void StartTexture(const std::string &name, ThreadPool &pool);
+
+  void LogStart(const ThreadPool &pool) const;
+
+public:
+  AssetPrefetch() {}
+  AssetPrefetch(const AssetPrefetch &) = delete;
+  AssetPrefetch &operator=(const AssetPrefetch &) = delete;
+
+  /*
+   * Waits for any loads still running, as they write into the prefetch
+   */
+  ~AssetPrefetch();
+
+  /*
+   * Submits every mesh and texture referenced by a scene for loading. A mesh
+   * is any object with 'path' and 'shader' members, and a texture is any
+   * 'texture' member naming one of the active resources' textures which
+   * hasn't been loaded yet
+   * @param scene The scene's JSON
+   * @param pool The pool to load the assets on
+   */
+  void Start(const JSON::Value &scene, ThreadPool &pool = ThreadPool::Shared());
+
+  /*
+   * Submits meshes and textures which were collected ahead of time, such as
+   * by SceneCache when compiling a scene
+   * @param meshPaths The path of each mesh, once for every mesh using it
+   * @param textureNames The names of the textures
+   * @param pool The pool to load the assets on
+   */
+  void Start(const std::vector<std::string> &meshPaths,
+             const std::vector<std::string> &textureNames,
+             ThreadPool &pool = ThreadPool::Shared());
+
+  /*
+   * Waits for a prefetched mesh. The last user of a path receives the data
+   * itself, and earlier users a copy
+   * @param path The path the mesh was loaded from
+   * @param out Set to every mesh in the file, as loaded by MeshData::LoadModel
+   * @returns false if the path was not prefetched
+   */
+  bool TakeMesh(const std::string &path, MeshData &out);
+
+  /*
+   * Waits for a prefetched texture and uploads it, registering it with the
+   * active resources. Does nothing if the texture was not prefetched
+   * @param name The texture's name
+   */
+  void UploadTexture(const std::string &name);
+
+  /*
+   * Uploads every prefetched texture which hasn't been uploaded yet
+   */
+  void UploadTextures();
+
+  std::size_t MeshCount() const { return meshes.size(); }
+  std::size_t TextureCount() const { return textures.size(); }
+
+  /*
+   * Whether ReadScene loads assets in parallel. Disabling it lets the time
+   * taken to read a scene be compared with loading assets one at a time
+   */
+  static bool enabled;
+
+  /*
+   * Reads a scene, loading its assets in parallel first, and logs the time
+   * taken. While an AssetStreamer is active, the assets are streamed in
+   * afterwards instead
+   * @param scene The scene to read into
+   * @param value The scene's JSON
+   * @param data The data used to read the scene
+   */
+  static void ReadScene(Scene &scene, const JSON::Value &value,
+                        const JSON::ReadData &data);
+
+  /*
+   * Reads a scene like ReadScene, for scenes which aren't read from JSON
+   * @param submit Submits the scene's assets to the prefetch
+   * @param read Reads the scene while the prefetch is active
+   */
+  static void ReadScene(const std::function<void(AssetPrefetch &)> &submit,
+                        const std::function<void()> &read);
+
+  static AssetPrefetch *active;
+};
+
+#endif // _SCENE__ASSET_PREFETCH_H
@@ -27,6 +27,7 @@ SOFTWARE.
 #ifndef _SCENE__DIRECTIONAL_LIGHT_H
 #define _SCENE__DIRECTIONAL_LIGHT_H
 
+#include <base/stringhash.h>
 #include <scene/light.h>
 
 #include <scene/lightmanager.h>
@@ -35,7 +36,12 @@ class NDirectionalLight : public NLight {
   LightManager::DirectionalLightRegistration registration;
 
 public:
-  void SetUniformData(const std::string &prefix) const;
+  /*
+   * Sets the light's uniforms in the current shader
+   * @param prefix The hash of the name of the shader's struct for this light,
+   * e.g. HashString("pointLights[0]")
+   */
+  void SetUniformData(StringHash prefix) const;
 
   Vec3 ambient = Vec3::one * 0.1f, diffuse, specular;
 
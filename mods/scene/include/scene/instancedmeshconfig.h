@@ -30,6 +30,7 @@ SOFTWARE.
 #include <algorithm>
 #include <base/mesh.h>
 #include <base/shader.h>
+#include <base/streamingbuffer.h>
 #include <core/readwrite.h>
 #include <scene/camera.h>
 #include <scene/meshconfig.h>
@@ -40,7 +41,7 @@ namespace Instanced {
 struct Transformation {
   std::vector<Mat4> transformationMatrices;
   void Setup(std::vector<VertexAttribute> &attributes) {
-    attributes.emplace_back(3, 16, 1, transformationMatrices);
+    attributes.emplace_back(3, 16, 1, std::move(transformationMatrices));
     transformationMatrices.clear();
   }
 
@@ -50,7 +51,7 @@ struct Transformation {
                    [](auto t) -> Mat4 { return t.Matrix(); });
   }
 
-  void GetUniforms(Shader &s) { vpUniform = s.GetUniform("VP"); }
+  void GetUniforms(Shader &s) { vpUniform = s.GetUniform(HashString("VP")); }
 
   void PreRender() {
     auto camera = NCamera::active;
@@ -61,6 +62,69 @@ struct Transformation {
 private:
   Shader::Uniform vpUniform;
 };
+
+/*
+ * The texture array layer each instance samples from, so that instances can
+ * be textured differently while drawn in one call. Used with shaders built
+ * with INSTANCE_LAYERS
+ */
+struct Layers {
+  std::vector<GLfloat> layers;
+
+  void Setup(std::vector<VertexAttribute> &attributes) {
+    if (layers.empty()) return;
+    attributes.emplace_back(attribute, 1, 1, std::move(layers));
+    layers.clear();
+  }
+
+  /*
+   * Adds INSTANCE_LAYERS unless no layers were given
+   */
+  void AddDefinitions(Shader::Definitions &definitions) const {
+    if (!layers.empty()) definitions["INSTANCE_LAYERS"] = "1";
+  }
+
+private:
+  // After the four columns of the transformation matrix
+  static constexpr const GLuint attribute = 7;
+};
+
+/*
+ * Transformation matrices which are rewritten every frame. Write to the span
+ * returned by Map and call Unmap before the mesh is next drawn; the number of
+ * instances drawn is the count last passed to Map
+ */
+struct DynamicTransformation {
+  void SetCompose(MeshRenderer &r) { renderer = &r; }
+
+  // The instance attributes are pointed at the streaming buffer in Unmap
+  void Setup(std::vector<VertexAttribute> & /* attributes */) {}
+
+  MappedSpan<Mat4> Map(std::size_t count) {
+    auto matrices = buffer.Map<Mat4>(count);
+    instanceCount = matrices.size;
+    return matrices;
+  }
+
+  void Unmap();
+
+  void GetUniforms(Shader &s) { vpUniform = s.GetUniform(HashString("VP")); }
+
+  void PreRender() {
+    auto camera = NCamera::active;
+    auto VP = camera->ProjectionMatrix() * camera->ViewMatrix();
+    vpUniform.SetMatrix4(1, false, VP);
+  }
+
+private:
+  static constexpr const GLuint firstAttribute = 3;
+
+  MeshRenderer *renderer = nullptr;
+  StreamingBuffer buffer;
+  std::size_t instanceCount = 0;
+
+  Shader::Uniform vpUniform;
+};
 } // namespace Instanced
 } // namespace MeshRenderConfigs
 
@@ -70,4 +134,10 @@ struct JSONImpl<MeshRenderConfigs::Instanced::Transformation> {
                    const JSON::Value &value, const JSON::ReadData &data);
 };
 
+template <>
+struct JSONImpl<MeshRenderConfigs::Instanced::Layers> {
+  static void Read(MeshRenderConfigs::Instanced::Layers &out,
+                   const JSON::Value &value, const JSON::ReadData &data);
+};
+
 #endif // _SCENE__INSTANCED_MESH_CONFIG_H
@@ -0,0 +1,104 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _SCENE__MESH_CACHE_H
+#define _SCENE__MESH_CACHE_H
+
+#include <atomic>
+#include <base/stringhash.h>
+#include <cstdint>
+#include <string>
+
+struct MeshData;
+
+/*
+ * Static class for storing imported meshes in a binary format, so that later
+ * runs can skip the importer. A cached mesh is used while the size and
+ * modification time of its source are unchanged, or failing that while the
+ * contents of the source hash to the same value.
+ *
+ * Files start with a header, followed by a table of submeshes, the positions,
+ * texture coordinates, normals and indices, and the source's node hierarchy.
+ * Each block is aligned to 16 bytes and vertex data is stored exactly as it is
+ * uploaded. Values are stored in the byte order of the machine which wrote
+ * them
+ */
+class MeshBinaryCache {
+  /*
+   * As class is static, we don't want to be able to create MeshBinaryCache
+   * objects
+   */
+  MeshBinaryCache() = delete;
+
+public:
+  // Meshes may be loaded from several threads at once
+  struct Statistics {
+    std::atomic<unsigned> hits{0}, misses{0}, stale{0};
+  };
+
+  static Statistics statistics;
+
+  /*
+   * Whether the cache is used when loading meshes
+   */
+  static bool enabled;
+
+  /*
+   * The directory (relative to the build path) cached meshes are stored in
+   */
+  static std::string directory;
+
+  /*
+   * @param source The path of the source mesh
+   * @returns the path of the cached mesh for the source
+   */
+  static std::string Path(const std::string &source);
+
+  /*
+   * Loads the cached meshes and hierarchy of a source if it is still up to date
+   * @param source The path of the source mesh
+   * @param out The MeshData to load into, which should be empty
+   * @returns true if the mesh was loaded from the cache
+   */
+  static bool Load(const std::string &source, MeshData &out);
+
+  /*
+   * Stores a freshly imported mesh
+   * @param source The path of the mesh's source
+   * @param data The imported mesh
+   * @returns true if the mesh was written
+   */
+  static bool Store(const std::string &source, const MeshData &data);
+
+  /*
+   * Imports a mesh and stores it, regardless of whether it is already cached
+   * @param source The path of the source mesh
+   * @returns true if the mesh was imported and written
+   */
+  static bool Bake(const std::string &source);
+};
+
+#endif // _SCENE__MESH_CACHE_H
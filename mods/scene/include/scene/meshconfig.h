@@ -33,20 +33,39 @@ SOFTWARE.
 
 #include <base/resources.h>
 #include <base/texture.h>
+#include <optional>
 #include <test/macros.h>
 
 namespace MeshRenderConfigs {
-IS_VALID_EXPR(ImplementsSetCompose, &Type::SetCompose)
+/*
+ * Configs may take the composed renderer in SetCompose to find other configs
+ * composed with them
+ */
+template <typename Type, typename Composed, typename = void>
+struct ImplementsSetCompose : std::false_type {};
+
+template <typename Type, typename Composed>
+struct ImplementsSetCompose<
+    Type, Composed,
+    std::void_t<decltype(std::declval<Type &>().SetCompose(
+        std::declval<Composed &>()))>> : std::true_type {};
+
 IS_VALID_EXPR(ImplementsGetUniforms, &Type::GetUniforms)
 IS_VALID_EXPR(ImplementsPreRender, &Type::PreRender)
 IS_VALID_EXPR(ImplementsSetup, &Type::Setup)
 
+/*
+ * Configs may add the shader definitions they need to the definitions of the
+ * mesh's shader in AddDefinitions
+ */
+IS_VALID_EXPR(ImplementsAddDefinitions, &Type::AddDefinitions)
+
 template <typename... Configs>
 class Compose : public MeshRenderer, public Configs... {
   template <typename C>
   void TryCallSetCompose() {
-    if constexpr (ImplementsSetCompose<C>::value)
-      static_cast<C *>(this)->SetCompose();
+    if constexpr (ImplementsSetCompose<C, Compose>::value)
+      static_cast<C *>(this)->SetCompose(*this);
   }
 
   template <typename C>
@@ -133,13 +152,36 @@ struct Standard {
 };
 
 struct Single {
-  void GetUniforms(Shader &s) { mvpUniform = s.GetUniform("MVP"); }
+  void SetCompose(MeshRenderer &composed) { renderer = &composed; }
+
+  void GetUniforms(Shader &s) { mvpUniform = s.GetUniform(HashString("MVP")); }
 
+  /*
+   * Sets the MVP uniform, culls the mesh's clusters if it has any, and
+   * estimates the mesh's size on screen
+   */
   void PreRender();
 
+  /*
+   * @returns the height in pixels of the mesh's bounds on screen as of the
+   * last PreRender, or 0 if the mesh has no bounds
+   */
+  float ProjectedSize() const { return projectedSize; }
+
   const Transform &GetGlobalTransform() const { return globalTransform; }
   void SetGlobalTransform(const Transform &t) { globalTransform = t; }
 
+  /*
+   * Sets a transform applied to vertices before the model transform, such as
+   * the dequantization matrix of a quantized mesh
+   */
+  void SetVertexTransform(const Mat4 &m) {
+    vertexTransform = m;
+    hasVertexTransform = true;
+  }
+
+  const Mat4 &GetVertexTransform() const { return vertexTransform; }
+
   template <typename... Configs>
   static Single &Get(Compose<Configs...> &compose) {
     static_assert(Compose<Configs...>::template canGet<Single>,
@@ -150,13 +192,26 @@ struct Single {
 private:
   Transform globalTransform;
 
+  Mat4 vertexTransform;
+  bool hasVertexTransform = false;
+
   Shader::Uniform mvpUniform;
+
+  float projectedSize = 0.0f;
+
+  MeshRenderer *renderer = nullptr;
 };
 
 struct GeneratorReturn {
   std::shared_ptr<MeshRenderer> meshRenderer;
   Single &single;
   Standard &standard;
+
+  /*
+   * Definitions the configs need in the mesh's shader, such as TEXTURE_ARRAY
+   * for textures which are layers of an array
+   */
+  Shader::Definitions definitions;
 };
 
 using Generator = GeneratorReturn (*)(const JSON::Value &,
@@ -172,7 +227,14 @@ Generator MakeGenerator() {
   return [](const auto &value, const auto &data) -> GeneratorReturn {
     auto c = std::make_shared<ConfigType>();
     JSONImpl<ConfigType>::Read(*c, value, data);
-    return {c, c->template Get<Single>(), c->template Get<Standard>()};
+    GeneratorReturn result{c, c->template Get<Single>(),
+                           c->template Get<Standard>(), {}};
+    c->ForEach([&](auto &config) {
+      using Type = std::remove_reference_t<decltype(config)>;
+      if constexpr (ImplementsAddDefinitions<Type>::value)
+        config.AddDefinitions(result.definitions);
+    });
+    return result;
   };
 }
 
@@ -181,13 +243,35 @@ struct NamedTexturePair {
   std::shared_ptr<Texture> texture;
 };
 
+/*
+ * Binds textures to consecutive texture units. Textures which are layers of an
+ * array also set the uniform named after theirs with 'Layer' appended, such as
+ * 'material.diffuseLayer', when the shader has one.
+ *
+ * Streamed textures request the levels needed for the mesh's size on screen
+ * from the active TextureStreamer, or every level without a Single config
+ */
 struct Textures {
   std::vector<NamedTexturePair> textures;
   std::vector<Shader::Uniform> textureUniforms;
+  std::vector<std::optional<Shader::Uniform>> layerUniforms;
+
+  Single *single = nullptr;
+
+  template <typename Composed>
+  void SetCompose(Composed &c) {
+    if constexpr (std::is_base_of_v<Single, Composed>)
+      single = &c.template Get<Single>();
+  }
 
   void GetUniforms(Shader &s);
 
   void PreRender();
+
+  /*
+   * Adds TEXTURE_ARRAY when any of the textures is a layer of an array
+   */
+  void AddDefinitions(Shader::Definitions &definitions) const;
 };
 
 struct Lit {
@@ -199,7 +283,8 @@ struct Lit {
 
   template <typename Composed>
   void SetCompose(Composed &c) {
-    if constexpr (c.template canGet<Single>) single = &c.template Get<Single>();
+    if constexpr (std::is_base_of_v<Single, Composed>)
+      single = &c.template Get<Single>();
   }
 
   void GetUniforms(Shader &s);
@@ -208,6 +293,12 @@ struct Lit {
 
 private:
   Shader::Uniform specularUniform, shininessUniform, modelUniform;
+
+  /*
+   * Only present in shaders built for quantized vertices
+   */
+  Shader::Uniform dequantizeUniform;
+  bool hasDequantizeUniform = false;
 };
 } // namespace MeshRenderConfigs
 
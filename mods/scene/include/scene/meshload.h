@@ -27,10 +27,17 @@ SOFTWARE.
 #ifndef _SCENE__MESH_LOAD_H
 #define _SCENE__MESH_LOAD_H
 
+#include <functional>
+#include <ostream>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
+#include <base/meshlet.h>
+#include <base/meshoptimizer.h>
+#include <base/vertexlayout.h>
 #include <scene/mesh.h>
 #include <scene/scene.h>
 
@@ -42,17 +49,243 @@ struct Single;
 struct Standard;
 } // namespace MeshRenderConfigs
 
+/*
+ * Interleaved layouts meshes can be generated with. Attributes are positions,
+ * texture coordinates and normals, in that order
+ */
+namespace MeshLayouts {
+using Interleaved =
+    VertexLayout<VertexLayoutAttribute<0, VertexFormats::Float3>,
+                 VertexLayoutAttribute<1, VertexFormats::Float2>,
+                 VertexLayoutAttribute<2, VertexFormats::Float3>>;
+
+/*
+ * Half float texture coordinates and 10:10:10:2 normals. 20 bytes per vertex
+ * rather than 32
+ */
+using Packed =
+    VertexLayout<VertexLayoutAttribute<0, VertexFormats::Float3>,
+                 VertexLayoutAttribute<1, VertexFormats::Half2>,
+                 VertexLayoutAttribute<2, VertexFormats::Int2101010>>;
+
+/*
+ * 16 bit positions relative to the mesh bounds, half float texture coordinates
+ * and oct-encoded normals. 16 bytes per vertex. The mesh must be quantized
+ * first, and lit shaders must be built with QUANTIZED_VERTICES defined
+ */
+using Quantized =
+    VertexLayout<VertexLayoutAttribute<0, VertexFormats::UNorm16x3>,
+                 VertexLayoutAttribute<1, VertexFormats::Half2>,
+                 VertexLayoutAttribute<2, VertexFormats::Oct16>>;
+} // namespace MeshLayouts
+
+/*
+ * The largest errors introduced by quantizing a mesh
+ */
+struct QuantizationReport {
+  /*
+   * Position error in object space units, and normal error in degrees
+   */
+  float maxPositionError = 0.0f, maxNormalError = 0.0f, maxUVError = 0.0f;
+  std::size_t bytesBefore = 0, bytesAfter = 0;
+};
+
+std::ostream &operator<<(std::ostream &os, const QuantizationReport &report);
+
+/*
+ * Which stages MeshData::Optimize runs
+ */
+struct MeshOptimizationSettings {
+  bool vertexCache = true, overdraw = false, vertexFetch = true;
+
+  /*
+   * How much worse the vertex cache may get to reduce overdraw
+   */
+  float overdrawThreshold = 1.05f;
+};
+
+/*
+ * Vertex cache efficiency after each stage of MeshData::Optimize, and the size
+ * of the index buffer
+ */
+struct MeshOptimizationReport {
+  MeshOptimizer::VertexCacheStatistics original, vertexCache, overdraw,
+      vertexFetch;
+  std::size_t indexBytesBefore = 0, indexBytesAfter = 0;
+};
+
+std::ostream &operator<<(std::ostream &os,
+                         const MeshOptimizationReport &report);
+
+/*
+ * One mesh of an imported file, as a range of MeshData's vertices and indices.
+ * Indices are relative to the submesh's first vertex
+ */
+struct MeshDataSubmesh {
+  std::string name;
+  GLuint firstIndex = 0, indexCount = 0, baseVertex = 0, vertexCount = 0;
+
+  IndexRange Range() const {
+    return {static_cast<GLsizei>(firstIndex),
+            static_cast<GLsizei>(indexCount), static_cast<GLint>(baseVertex)};
+  }
+};
+
+/*
+ * A node of an imported file's hierarchy
+ */
+struct MeshDataNode {
+  std::string name;
+
+  // The index of the node's parent in MeshData::nodes, or -1 for the root.
+  // Parents always come before their children
+  int parent = -1;
+
+  Transform transform;
+
+  // Indices of the meshes the node draws in MeshData::submeshes
+  std::vector<unsigned> submeshes;
+};
+
+/*
+ * Geometry generated from MeshData. Every mesh in the file shares its
+ * buffers, and the node hierarchy is kept so that models can be created from
+ * geometry found in Resources::meshes
+ */
+class ModelGeometry : public MeshGeometry {
+public:
+  using MeshGeometry::MeshGeometry;
+
+  std::vector<MeshDataSubmesh> submeshes;
+  std::vector<MeshDataNode> nodes;
+};
+
 struct MeshData {
   std::vector<GLfloat> verts, uvs, normals;
   std::vector<GLuint> indices;
   bool hasUVs = true, successful = true;
 
+  /*
+   * The meshes and node hierarchy of the imported file. Vertices and indices
+   * of every mesh are stored one after another
+   */
+  std::vector<MeshDataSubmesh> submeshes;
+  std::vector<MeshDataNode> nodes;
+
+  /*
+   * Clusters built by BuildMeshlets, which generated geometry keeps for culling
+   */
+  std::vector<Meshlet> meshlets;
+
+  /*
+   * Whether positions have been scaled to the mesh bounds by Quantize, and the
+   * matrix which transforms them back
+   */
+  bool quantized = false;
+  Mat4 dequantization;
+
   using ConfigType = MeshRenderConfigs::Standard;
 
   MeshData() {}
   MeshData(const aiMesh *mesh) { Load(mesh); }
   MeshData(const std::string &path) { Load(path); }
 
+  std::size_t VertexCount() const { return verts.size() / 3; }
+
+  /*
+   * Scales positions into the range [0, 1] relative to the mesh bounds, so that
+   * they can be stored with MeshLayouts::Quantized. Generated meshes apply the
+   * dequantization matrix as part of their model transform
+   * @returns the errors quantization introduces
+   */
+  QuantizationReport Quantize();
+
+  /*
+   * Reorders triangles and vertices so the mesh renders faster. The index
+   * buffer uses 16 bit indices if possible regardless of this. Only data with
+   * a single submesh can be optimized
+   * @returns the vertex cache efficiency after each stage
+   */
+  MeshOptimizationReport
+  Optimize(const MeshOptimizationSettings &settings = {});
+
+  /*
+   * Splits the triangles into clusters which are culled separately when the
+   * mesh is drawn. Should be run after Optimize, and like it only works on
+   * data with a single submesh
+   * @returns the number of clusters
+   */
+  std::size_t
+  BuildMeshlets(unsigned maxTriangles = Meshlets::defaultMaxTriangles,
+                unsigned maxVertices = Meshlets::defaultMaxVertices);
+
+  /*
+   * Packs the vertex data into a single buffer
+   * @tparam Layout A layout from MeshLayouts, or any VertexLayout with
+   * attributes for positions, texture coordinates and normals
+   */
+  template <typename Layout>
+  InterleavedVertices Interleave() const {
+    static_assert(Layout::attributeCount == 3,
+                  "Layout must have attributes for positions, texture "
+                  "coordinates and normals");
+    return Layout::Pack({&verts, &uvs, &normals}, VertexCount());
+  }
+
+  /*
+   * Creates geometry which can be shared by any number of meshes, storing
+   * each attribute in its own buffer.
+   *
+   * Like the other Generate functions, this moves the vertex data out of the
+   * MeshData. Use MeshRenderer::KeepCPUData to keep it available on the CPU
+   */
+  std::shared_ptr<MeshGeometry> GenerateGeometry();
+
+  /*
+   * Creates geometry which stores its vertices in one interleaved buffer
+   */
+  template <typename Layout>
+  std::shared_ptr<MeshGeometry> GenerateGeometry() {
+    if (!successful) return nullptr;
+    if constexpr (std::is_same_v<Layout, MeshLayouts::Quantized>)
+      if (!quantized) Quantize();
+    auto vertices = Interleave<Layout>();
+    auto geometry = MakeGeometry();
+    ReleaseVertexData();
+
+    geometry->AddAttribute(VertexAttribute(std::move(vertices)));
+    return geometry;
+  }
+
+  /*
+   * Generates a mesh which stores its vertices in one interleaved buffer. The
+   * configuration's attribute data is left empty
+   */
+  template <typename Layout>
+  NMesh *GenerateNMesh(const std::shared_ptr<Shader> &shader,
+                       const std::shared_ptr<MeshRenderer> &mr,
+                       MeshRenderConfigs::Single &single,
+                       unsigned instanceCount) {
+    return MakeNMesh(shader, mr, single, GenerateGeometry<Layout>(),
+                     instanceCount);
+  }
+
+  template <typename Layout>
+  std::unique_ptr<InstancedMesh>
+  GenerateInstancedMesh(const std::shared_ptr<Shader> &shader,
+                        const std::shared_ptr<MeshRenderer> &mr,
+                        unsigned instanceCount) {
+    static_assert(!std::is_same_v<Layout, MeshLayouts::Quantized>,
+                  "Instanced meshes do not support quantized positions");
+    return MakeInstancedMesh(shader, mr, GenerateGeometry<Layout>(),
+                             instanceCount);
+  }
+
+  /*
+   * Generates a mesh with separate attribute buffers. Texture coordinates and
+   * normals are part of the mesh's geometry, so the configuration's attribute
+   * data is left empty
+   */
   NMesh *GenerateNMesh(const std::shared_ptr<Shader> &shader,
                        const std::shared_ptr<MeshRenderer> &mr,
                        MeshRenderConfigs::Single &single, ConfigType &config,
@@ -63,24 +296,96 @@ struct MeshData {
                         const std::shared_ptr<MeshRenderer> &mr,
                         ConfigType &config, unsigned instanceCount);
 
+  /*
+   * Creates a node for each node of the file the geometry was generated from,
+   * each with a child mesh drawing every submesh it uses. All of the meshes
+   * share the geometry's buffers
+   * @param geometry Geometry generated from a MeshData
+   * @param makeMesh Creates a mesh drawing the whole geometry for a submesh,
+   * such as with MakeNMesh. It is then limited to the submesh's range
+   * @returns the root node, or nullptr if 'geometry' is null or has no nodes
+   */
+  static NNode *
+  MakeModel(const std::shared_ptr<ModelGeometry> &geometry,
+            const std::function<NMesh *(const MeshDataSubmesh &)> &makeMesh);
+
+  /*
+   * Creates a mesh which draws existing geometry, such as geometry from
+   * Resources::meshes
+   * @returns nullptr if 'geometry' is null
+   */
+  static NMesh *MakeNMesh(const std::shared_ptr<Shader> &shader,
+                          const std::shared_ptr<MeshRenderer> &mr,
+                          MeshRenderConfigs::Single &single,
+                          std::shared_ptr<MeshGeometry> geometry,
+                          unsigned instanceCount);
+  static std::unique_ptr<InstancedMesh>
+  MakeInstancedMesh(const std::shared_ptr<Shader> &shader,
+                    const std::shared_ptr<MeshRenderer> &mr,
+                    std::shared_ptr<MeshGeometry> geometry,
+                    unsigned instanceCount);
+
   void Load(const aiMesh *mesh);
+
+  /*
+   * Loads a file holding a single mesh. See LoadModel
+   */
   void Load(const std::string &path);
 
+  /*
+   * Loads every mesh and node in a file from MeshBinaryCache if it is up to
+   * date, and otherwise imports them and adds them to the cache
+   */
+  void LoadModel(const std::string &path);
+
+  /*
+   * Imports every mesh and node in a file with assimp, bypassing the cache
+   */
+  void LoadFromSource(const std::string &path);
+
+  /*
+   * Marks the data as unsuccessful if it holds more than one mesh, as
+   * meshes loaded from the data would draw all of them at the same place
+   * @returns whether the data holds a single mesh
+   */
+  bool RequireSingleMesh();
+
 private:
-  void GenerateHelper(const std::shared_ptr<MeshRenderer> &mr,
-                      MeshData::ConfigType &config, unsigned instanceCount);
+  // Adds a mesh's vertices and indices as a new submesh
+  void AppendMesh(const aiMesh *mesh);
+
+  // Adds the nodes of an imported hierarchy, parents first
+  void AppendNode(const aiNode *node, int parent);
+
+  // Frees the per-attribute vertex data once it has been interleaved
+  void ReleaseVertexData();
+
+  // Creates geometry holding the indices, the dequantization transform, the
+  // bounds of the vertices and the node hierarchy
+  std::shared_ptr<ModelGeometry> MakeGeometry();
 };
 
 const aiScene *LoadScene(const std::string &path, Assimp::Importer &importer);
 
 /*
  * Function that can be registered for the ability to load single meshes as
- * shown below:
+ * shown below. Meshes with the same path and import options share their
+ * geometry through Resources::meshes:
  * [
  *   "NMesh",
  *   {
  *     "path": "mods/mod/res/mesh.blend",
  *     "shader": "unlit",
+ *     "vertex-layout": "packed", // Optional: "separate" (default),
+ *                                // "interleaved", "packed" or "quantized"
+ *     "optimize": "overdraw", // Optional: "none" (default), "vertex-cache"
+ *                             // or "overdraw", which also sorts triangles
+ *                             // to reduce overdraw
+ *     "keep-cpu-data": true, // Optional: keep vertex data in RAM after upload,
+ *                            // for collision or picking. Defaults to false
+ *     "clusters": true, // Optional: split the mesh into clusters which are
+ *                       // culled on the CPU each frame, for large meshes of
+ *                       // which only part is usually visible
  *     "config": {
  *       "type": "none",
  *       "data": {}
@@ -92,4 +397,25 @@ const aiScene *LoadScene(const std::string &path, Assimp::Importer &importer);
 NMesh *MeshTypeRegistration(const JSON::Value &value,
                             const JSON::ReadData &data);
 
+/*
+ * Function that can be registered for the ability to load every mesh in a file
+ * along with its node hierarchy. The meshes share one set of buffers. Options
+ * are the same as for single meshes, except that "optimize" and "clusters"
+ * aren't supported:
+ * [
+ *   "NModel",
+ *   {
+ *     "path": "mods/mod/res/model.blend",
+ *     "shader": "unlit",
+ *     "config": { ... }, // Used for every mesh
+ *     "mesh-configs": { // Optional: configs for meshes by name
+ *       "Wheel": { ... }
+ *     },
+ *     "NNode": { ... } // For the root node
+ *   }
+ * ]
+ */
+NNode *ModelTypeRegistration(const JSON::Value &value,
+                             const JSON::ReadData &data);
+
 #endif // _SCENE__MESH_LOAD_H
@@ -34,6 +34,7 @@ class Shader;
 
 class MeshRenderer {
   std::unique_ptr<Mesh> mesh;
+  bool keepCPUData = false;
 
 protected:
   std::vector<VertexAttribute> vertexAttributes;
@@ -43,15 +44,33 @@ protected:
   virtual void Setup() = 0;
 
 public:
-  const Mesh *GetMesh() { return mesh.get(); }
+  const Mesh *GetMesh() const { return mesh.get(); }
+  Mesh *GetMesh() { return mesh.get(); }
+
+  /*
+   * Keeps the mesh's vertex data in RAM after it is uploaded, for meshes which
+   * are also used on the CPU. Must be set before SetMeshAndSetupAttributes
+   */
+  void KeepCPUData(bool keep) { keepCPUData = keep; }
+  bool KeepsCPUData() const { return keepCPUData; }
 
   void SetMeshAndSetupAttributes(std::unique_ptr<Mesh> _mesh);
 
+  /*
+   * @returns the RAM and GPU memory used by the mesh and its attributes
+   */
+  Residency GetResidency() const;
+
   void SetShader(Shader &s) { GetUniforms(s); }
 
   virtual void PreRender() = 0;
 
-  void Draw() { mesh->Draw(); }
+  /*
+   * Does nothing until a mesh has been set, such as while it is streamed
+   */
+  void Draw() {
+    if (mesh) mesh->Draw();
+  }
 
   virtual ~MeshRenderer() {}
 };
@@ -0,0 +1,129 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#ifndef _SCENE__SCENE_CACHE_H
+#define _SCENE__SCENE_CACHE_H
+
+#include <atomic>
+#include <core/readwrite.h>
+#include <ostream>
+#include <string>
+
+class Scene;
+
+/*
+ * Static class for compiling scene files into a binary format, whose nodes are
+ * built without parsing any text. A compiled scene is used while the size and
+ * modification time of its source are unchanged, or failing that while the
+ * contents of the source hash to the same value. Otherwise the source is
+ * parsed, so scenes can be edited during development without compiling them.
+ * A compiled scene whose source is missing is used as it is, so builds can
+ * ship without the JSON.
+ *
+ * Files start with a header, followed by a table of strings, the types of the
+ * scene's nodes, the meshes and textures they use, and then the nodes in the
+ * order they appear. Every string is stored once in the table and referred to
+ * by its index. Nodes refer to their type by its index, and tagged nodes are
+ * stored as the node they tag along with the tag, so each type is looked up in
+ * the TypeManager once rather than once for every node. The assets are
+ * prefetched from their lists without searching the nodes for them.
+ *
+ * The nodes are built in one pass over the mapped file. Node types are read
+ * through their JSONImpl, so the data of each node is decoded into a value on
+ * its own, in memory reused between nodes, with its strings pointing into the
+ * file. Numbers are stored in binary, and arrays holding only integers or only
+ * decimals are packed. Values are stored in the byte order of the machine
+ * which wrote them
+ */
+class SceneCache {
+  /*
+   * As class is static, we don't want to be able to create SceneCache objects
+   */
+  SceneCache() = delete;
+
+public:
+  struct Statistics {
+    std::atomic<unsigned> hits{0}, misses{0}, stale{0};
+  };
+
+  static Statistics statistics;
+
+  /*
+   * Whether compiled scenes are used when reading scenes
+   */
+  static bool enabled;
+
+  /*
+   * The directory (relative to the build path) compiled scenes are stored in
+   */
+  static std::string directory;
+
+  /*
+   * @param source The path of the scene file
+   * @returns the path of the compiled scene for the source
+   */
+  static std::string Path(const std::string &source);
+
+  /*
+   * Reads a scene from its compiled form if it is up to date, and parses the
+   * source otherwise. The scene's assets are loaded as by
+   * AssetPrefetch::ReadScene
+   * @param source The path of the scene file
+   * @param scene The scene to read into
+   * @param data The data used to read the scene
+   * @throws JSON::ParseException if the scene is invalid
+   */
+  static void ReadScene(const std::string &source, Scene &scene,
+                        const JSON::ReadData &data);
+
+  /*
+   * Reads the compiled form of a scene if it is up to date
+   * @returns true if the scene was read
+   * @throws JSON::ParseException if a node is invalid
+   */
+  static bool ReadCompiled(const std::string &source, Scene &scene,
+                           const JSON::ReadData &data);
+
+  /*
+   * Stores a scene in its compiled form
+   * @param source The path of the scene file
+   * @param scene The parsed scene
+   * @returns true if the scene was written
+   */
+  static bool Store(const std::string &source, const JSON::Value &scene);
+
+  /*
+   * Parses a scene file and stores it, regardless of whether it is already
+   * compiled
+   * @param source The path of the scene file
+   * @returns true if the scene was parsed and written
+   */
+  static bool Compile(const std::string &source);
+
+  static void Report(std::ostream &os);
+};
+
+#endif // _SCENE__SCENE_CACHE_H
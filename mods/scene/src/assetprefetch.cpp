@@ -0,0 +1,191 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <assetprefetch.h>
+
+#include <base/assetstreamer.h>
+#include <base/resources.h>
+#include <base/texturecache.h>
+#include <chrono>
+#include <iostream>
+#include <scene.h>
+
+AssetPrefetch *AssetPrefetch::active = nullptr;
+bool AssetPrefetch::enabled = true;
+
+AssetPrefetch::~AssetPrefetch() {
+  for (auto &pair : meshes)
+    if (pair.second.future.valid()) pair.second.future.wait();
+  for (auto &pair : textures)
+    if (pair.second.future.valid()) pair.second.future.wait();
+}
+
+void AssetPrefetch::Collect(const JSON::Value &value, ThreadPool &pool) {
+  if (value.IsArray()) {
+    for (const auto &element : value.GetArray()) Collect(element, pool);
+    return;
+  }
+  if (!value.IsObject()) return;
+
+  auto pathIt = value.FindMember("path");
+  if (pathIt != value.MemberEnd() && pathIt->value.IsString() &&
+      value.HasMember("shader"))
+    StartMesh(pathIt->value.GetString(), pool);
+
+  auto textureIt = value.FindMember("texture");
+  if (textureIt != value.MemberEnd() && textureIt->value.IsString())
+    StartTexture(textureIt->value.GetString(), pool);
+
+  for (const auto &member : value.GetObject()) Collect(member.value, pool);
+}
+
+void AssetPrefetch::StartMesh(const std::string &path, ThreadPool &pool) {
+  auto &mesh = meshes[path];
+  if (mesh.users++ == 0)
+    mesh.future = pool.Submit([path] {
+      MeshData data;
+      data.LoadModel(path);
+      return data;
+    });
+}
+
+void AssetPrefetch::StartTexture(const std::string &name, ThreadPool &pool) {
+  auto &resources = *Resources::active;
+  auto deferredIt = resources.textures.GetDeferred().find(name);
+  // Streamed textures are decoded by the TextureStreamer instead
+  if (textures.count(name) || resources.textures.GetLoaded().count(name) ||
+      deferredIt == resources.textures.GetDeferred().end() ||
+      deferredIt->second.streaming)
+    return;
+
+  auto &texture = textures[name];
+  texture.settings = deferredIt->second;
+  auto *pending = &texture;
+  auto path = texture.settings.path;
+  // Elements of an unordered_map keep their address when it grows
+  texture.future = pool.Submit([pending, path] {
+    pending->isCooked = TextureCache::Load(path, pending->cooked);
+    return pending->isCooked || pending->image.Load(path, true);
+  });
+}
+
+void AssetPrefetch::LogStart(const ThreadPool &pool) const {
+  std::clog << "Prefetching " << meshes.size() << " meshes and "
+            << textures.size() << " textures on " << pool.Size()
+            << " threads\n";
+}
+
+void AssetPrefetch::Start(const JSON::Value &scene, ThreadPool &pool) {
+  Collect(scene, pool);
+  LogStart(pool);
+}
+
+void AssetPrefetch::Start(const std::vector<std::string> &meshPaths,
+                          const std::vector<std::string> &textureNames,
+                          ThreadPool &pool) {
+  for (const auto &path : meshPaths) StartMesh(path, pool);
+  for (const auto &name : textureNames) StartTexture(name, pool);
+  LogStart(pool);
+}
+
+bool AssetPrefetch::TakeMesh(const std::string &path, MeshData &out) {
+  auto it = meshes.find(path);
+  if (it == meshes.end()) return false;
+
+  auto &mesh = it->second;
+  if (!mesh.ready) {
+    mesh.data = mesh.future.get();
+    mesh.ready = true;
+  }
+
+  if (--mesh.users == 0) {
+    out = std::move(mesh.data);
+    meshes.erase(it);
+  } else
+    out = mesh.data;
+  return true;
+}
+
+void AssetPrefetch::UploadTexture(const std::string &name) {
+  auto it = textures.find(name);
+  if (it == textures.end()) return;
+
+  auto &pending = it->second;
+  if (pending.future.get()) {
+    auto texture = std::make_shared<Texture>();
+    if (pending.isCooked)
+      texture->Load(pending.cooked, pending.settings);
+    else
+      texture->Load(pending.image, pending.settings);
+    Resources::active->textures.Register(name, texture);
+  } else
+    std::cerr << "Failed to load texture with path: " << pending.settings.path
+              << '\n';
+  textures.erase(it);
+}
+
+void AssetPrefetch::UploadTextures() {
+  while (!textures.empty()) UploadTexture(textures.begin()->first);
+}
+
+void AssetPrefetch::ReadScene(Scene &scene, const JSON::Value &value,
+                              const JSON::ReadData &data) {
+  ReadScene([&](AssetPrefetch &prefetch) { prefetch.Start(value); },
+            [&] { JSON::Read(scene, value, data); });
+}
+
+void AssetPrefetch::ReadScene(
+    const std::function<void(AssetPrefetch &)> &submit,
+    const std::function<void()> &read) {
+  // Assets are streamed in after the scene is read instead when a streamer
+  // is active
+  bool prefetch = enabled && !AssetStreamer::active;
+  auto start = std::chrono::steady_clock::now();
+  if (!prefetch) {
+    read();
+  } else {
+    AssetPrefetch prefetch;
+    submit(prefetch);
+
+    auto *previous = active;
+    active = &prefetch;
+    try {
+      read();
+      // Textures named in the scene but not used by any config would
+      // otherwise be decoded again when they are first used
+      prefetch.UploadTextures();
+    } catch (...) {
+      active = previous;
+      throw;
+    }
+    active = previous;
+  }
+
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::clog << "Read scene in " << elapsed.count() << "ms ("
+            << (prefetch ? "with" : "without") << " prefetching)\n";
+}
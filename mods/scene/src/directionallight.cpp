@@ -28,12 +28,12 @@ SOFTWARE.
 
 #include <base/shader.h>
 
-void NDirectionalLight::SetUniformData(const std::string &prefix) const {
+void NDirectionalLight::SetUniformData(StringHash prefix) const {
   auto s = Shader::Current();
-  s->GetUniform(prefix + ".direction").Set(GlobalRotation() * Vec3::front);
-  s->GetUniform(prefix + ".ambient").Set(ambient);
-  s->GetUniform(prefix + ".diffuse").Set(diffuse);
-  s->GetUniform(prefix + ".specular").Set(specular);
+  s->GetUniform(HashString(".direction", prefix)).Set(GlobalRotation() * Vec3::front);
+  s->GetUniform(HashString(".ambient", prefix)).Set(ambient);
+  s->GetUniform(HashString(".diffuse", prefix)).Set(diffuse);
+  s->GetUniform(HashString(".specular", prefix)).Set(specular);
 }
 
 void JSONImpl<NDirectionalLight>::Read(NDirectionalLight &out, const JSON::Value &value, const JSON::ReadData &data) {
@@ -24,7 +24,28 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <cassert>
 #include <instancedmeshconfig.h>
+#include <scene/meshrenderer.h>
+
+void MeshRenderConfigs::Instanced::DynamicTransformation::Unmap() {
+  buffer.Unmap();
+
+  assert(renderer);
+  auto mesh = renderer->GetMesh();
+  assert(mesh);
+  mesh->SetInstanceCount(instanceCount);
+
+  // The region written to moves every frame, so the matrix columns are
+  // re-pointed at its offset
+  static const std::vector<InterleavedAttribute> columns{
+      {firstAttribute, 4, GL_FLOAT, GL_FALSE, 0},
+      {firstAttribute + 1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat)},
+      {firstAttribute + 2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat)},
+      {firstAttribute + 3, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(GLfloat)}};
+  mesh->UpdateAttributes(
+      [this] { buffer.PointAttributes(columns, sizeof(Mat4), 1); });
+}
 
 void JSONImpl<MeshRenderConfigs::Instanced::Transformation>::Read(
     MeshRenderConfigs::Instanced::Transformation &out, const JSON::Value &value,
@@ -37,3 +58,11 @@ void JSONImpl<MeshRenderConfigs::Instanced::Transformation>::Read(
   JSON::GetMember(transformations, "transformations", object, data);
   out.SetTransforms(transformations);
 }
+
+void JSONImpl<MeshRenderConfigs::Instanced::Layers>::Read(
+    MeshRenderConfigs::Instanced::Layers &out, const JSON::Value &value,
+    const JSON::ReadData &data) {
+  auto t = Trace::Pusher{data.trace, "MeshRenderConfigs::Instanced::Layers"};
+  const auto &object = JSON::GetObject(value, data);
+  JSON::GetMember(out.layers, "layers", object, data);
+}
@@ -42,14 +42,12 @@ void LightManager::SetDirectionalLights(const LightingConfig &config) {
   if (config.maxDirectionalLights == 0) return;
 
   GLint numDirLights = std::min(config.maxDirectionalLights, directionalLights.size());
-  Shader::Current()->GetUniform("numDirectionalLights").Set(numDirLights);
+  s->GetUniform(HashString("numDirectionalLights")).Set(numDirLights);
 
+  constexpr auto arrayName = HashString("directionalLights");
   auto dirIt = directionalLights.begin();
-  for (auto i = 0; i < numDirLights; i++, dirIt++) {
-    std::stringstream iss;
-    iss << "directionalLights[" << i << ']';
-    (*dirIt)->SetUniformData(iss.str());
-  }
+  for (auto i = 0; i < numDirLights; i++, dirIt++)
+    (*dirIt)->SetUniformData(HashIndexed(arrayName, i));
 }
 
 void LightManager::SetPointLights(Vec3 location, const LightingConfig &config) {
@@ -60,7 +58,7 @@ void LightManager::SetPointLights(Vec3 location, const LightingConfig &config) {
   if (config.maxPointLights == 0) return;
 
   GLint numPointLights = std::min(config.maxPointLights, pointLights.size());
-  s->GetUniform("numPointLights").Set(numPointLights);
+  s->GetUniform(HashString("numPointLights")).Set(numPointLights);
 
   // Order point lights by distance to objects
   pointLights.sort([&location](const auto &lhs, const auto &rhs) {
@@ -68,12 +66,10 @@ void LightManager::SetPointLights(Vec3 location, const LightingConfig &config) {
            Vec3::Distance(rhs->transform.Location(), location);
   });
 
+  constexpr auto arrayName = HashString("pointLights");
   auto pointIt = pointLights.begin();
-  for (auto i = 0; i < numPointLights; i++, pointIt++) {
-    std::stringstream iss;
-    iss << "pointLights[" << i << ']';
-    (*pointIt)->SetUniformData(iss.str());
-  }
+  for (auto i = 0; i < numPointLights; i++, pointIt++)
+    (*pointIt)->SetUniformData(HashIndexed(arrayName, i));
 }
 
 void LightManager::SetUniformsForClosestLights(Vec3 location,
@@ -82,7 +78,7 @@ void LightManager::SetUniformsForClosestLights(Vec3 location,
   assert(s);
 
   assert(NCamera::active);
-  s->GetUniform("cameraLocation").Set(NCamera::active->transform.Location());
+  s->GetUniform(HashString("cameraLocation")).Set(NCamera::active->transform.Location());
 
   SetDirectionalLights(config);
   SetPointLights(location, config);
@@ -0,0 +1,320 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <meshcache.h>
+
+#include <core/file.h>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <meshload.h>
+#include <sstream>
+
+MeshBinaryCache::Statistics MeshBinaryCache::statistics;
+bool MeshBinaryCache::enabled = true;
+std::string MeshBinaryCache::directory = "cache/meshes/";
+
+namespace {
+constexpr char magic[4] = {'E', 'R', 'S', 'M'};
+constexpr std::uint32_t version = 2;
+constexpr std::size_t blockAlignment = 16;
+
+constexpr std::uint32_t hasUVsFlag = 1;
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+
+  // The source the mesh was imported from
+  File::Stamp source;
+
+  std::uint32_t flags;
+  std::uint32_t vertexCount, indexCount, submeshCount;
+  std::uint32_t nodeCount, nodeSubmeshCount, nameBytes;
+
+  // Offsets of each block from the start of the file
+  std::uint64_t submeshOffset, positionOffset, uvOffset, normalOffset,
+      indexOffset, nodeOffset, nodeSubmeshOffset, nameOffset;
+};
+
+/*
+ * A string in the block of names
+ */
+struct Name {
+  std::uint32_t offset, length;
+};
+
+/*
+ * A range of the index and vertex data holding one mesh of the source
+ */
+struct Submesh {
+  std::uint32_t firstIndex, indexCount, baseVertex, vertexCount;
+  Name name;
+};
+
+/*
+ * A node of the source's hierarchy. Its submeshes are a range of the block of
+ * node submesh indices
+ */
+struct Node {
+  std::int32_t parent;
+  Name name;
+  std::uint32_t firstSubmesh, submeshCount;
+  float location[3], rotation[4], scale[3];
+};
+
+std::size_t Align(std::size_t offset) {
+  return (offset + blockAlignment - 1) / blockAlignment * blockAlignment;
+}
+
+template <typename T>
+bool ReadBlock(const MappedFile &file, std::uint64_t offset, std::size_t count,
+               std::vector<T> &out) {
+  if (offset % alignof(T) != 0 || offset > file.Size() ||
+      count > (file.Size() - offset) / sizeof(T))
+    return false;
+  const auto *begin = reinterpret_cast<const T *>(file.Data() + offset);
+  out.assign(begin, begin + count);
+  return true;
+}
+
+Name AppendName(std::vector<char> &names, const std::string &name) {
+  Name out{static_cast<std::uint32_t>(names.size()),
+           static_cast<std::uint32_t>(name.size())};
+  names.insert(names.end(), name.begin(), name.end());
+  return out;
+}
+
+bool ReadName(const std::vector<char> &names, Name name, std::string &out) {
+  if (std::uint64_t{name.offset} + name.length > names.size()) return false;
+  out.assign(names.data() + name.offset, name.length);
+  return true;
+}
+
+template <typename T>
+std::uint64_t AppendBlock(std::string &contents, const std::vector<T> &data) {
+  auto offset = Align(contents.size());
+  contents.resize(offset + data.size() * sizeof(T), '\0');
+  if (!data.empty())
+    std::memcpy(&contents[offset], data.data(), data.size() * sizeof(T));
+  return offset;
+}
+void WriteHierarchy(const MeshData &data, std::vector<Submesh> &submeshes,
+                    std::vector<Node> &nodes,
+                    std::vector<std::uint32_t> &nodeSubmeshes,
+                    std::vector<char> &names) {
+  // Data which wasn't imported from a file is a single mesh
+  if (data.submeshes.empty()) {
+    submeshes.push_back({0, static_cast<std::uint32_t>(data.indices.size()), 0,
+                         static_cast<std::uint32_t>(data.VertexCount()),
+                         {0, 0}});
+    return;
+  }
+
+  for (const auto &submesh : data.submeshes)
+    submeshes.push_back({submesh.firstIndex, submesh.indexCount,
+                         submesh.baseVertex, submesh.vertexCount,
+                         AppendName(names, submesh.name)});
+
+  for (const auto &node : data.nodes) {
+    auto l = node.transform.Location();
+    auto r = node.transform.Rotation();
+    auto s = node.transform.Scale();
+    nodes.push_back({node.parent, AppendName(names, node.name),
+                     static_cast<std::uint32_t>(nodeSubmeshes.size()),
+                     static_cast<std::uint32_t>(node.submeshes.size()),
+                     {l.x, l.y, l.z},
+                     {r.x, r.y, r.z, r.w},
+                     {s.x, s.y, s.z}});
+    nodeSubmeshes.insert(nodeSubmeshes.end(), node.submeshes.begin(),
+                         node.submeshes.end());
+  }
+}
+
+bool ReadHierarchy(const std::vector<Submesh> &submeshes,
+                   const std::vector<Node> &nodes,
+                   const std::vector<std::uint32_t> &nodeSubmeshes,
+                   const std::vector<char> &names, MeshData &out) {
+  auto vertexCount = out.VertexCount();
+  for (const auto &submesh : submeshes) {
+    if (std::uint64_t{submesh.firstIndex} + submesh.indexCount >
+            out.indices.size() ||
+        std::uint64_t{submesh.baseVertex} + submesh.vertexCount > vertexCount)
+      return false;
+
+    MeshDataSubmesh s;
+    if (!ReadName(names, submesh.name, s.name)) return false;
+    s.firstIndex = submesh.firstIndex;
+    s.indexCount = submesh.indexCount;
+    s.baseVertex = submesh.baseVertex;
+    s.vertexCount = submesh.vertexCount;
+    out.submeshes.push_back(std::move(s));
+  }
+
+  for (const auto &node : nodes) {
+    // Parents must come before their children, and roots have a parent of -1
+    if (node.parent < -1 ||
+        node.parent >= static_cast<std::int64_t>(out.nodes.size()) ||
+        std::uint64_t{node.firstSubmesh} + node.submeshCount >
+            nodeSubmeshes.size())
+      return false;
+
+    MeshDataNode n;
+    if (!ReadName(names, node.name, n.name)) return false;
+    n.parent = node.parent;
+    n.transform = Transform{
+        Vec3(node.location[0], node.location[1], node.location[2]),
+        Quat(node.rotation[0], node.rotation[1], node.rotation[2],
+             node.rotation[3]),
+        Vec3(node.scale[0], node.scale[1], node.scale[2])};
+    auto first = nodeSubmeshes.begin() + node.firstSubmesh;
+    n.submeshes.assign(first, first + node.submeshCount);
+    for (auto index : n.submeshes)
+      if (index >= submeshes.size()) return false;
+    out.nodes.push_back(std::move(n));
+  }
+  return true;
+}
+} // namespace
+
+std::string MeshBinaryCache::Path(const std::string &source) {
+  std::stringstream ss;
+  ss << directory << std::hex << std::setw(16) << std::setfill('0')
+     << HashString(source) << ".mesh";
+  return ss.str();
+}
+
+bool MeshBinaryCache::Load(const std::string &source, MeshData &out) {
+  if (!enabled) return false;
+
+  MappedFile file;
+  if (!file.Open(Path(source))) {
+    statistics.misses++;
+    return false;
+  }
+
+  Header header;
+  if (file.Size() < sizeof(header)) {
+    statistics.stale++;
+    return false;
+  }
+  std::memcpy(&header, file.Data(), sizeof(header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+      header.version != version) {
+    statistics.stale++;
+    return false;
+  }
+
+  if (!File::Matches(source, header.source)) {
+    statistics.stale++;
+    return false;
+  }
+
+  MeshData data;
+  std::vector<Submesh> submeshes;
+  std::vector<Node> nodes;
+  std::vector<std::uint32_t> nodeSubmeshes;
+  std::vector<char> names;
+  bool hasUVs = header.flags & hasUVsFlag;
+  // Widened so that a corrupt count can't wrap around when multiplied
+  std::size_t vertexCount = header.vertexCount;
+  if (!ReadBlock(file, header.submeshOffset, header.submeshCount, submeshes) ||
+      !ReadBlock(file, header.nodeOffset, header.nodeCount, nodes) ||
+      !ReadBlock(file, header.nodeSubmeshOffset, header.nodeSubmeshCount,
+                 nodeSubmeshes) ||
+      !ReadBlock(file, header.nameOffset, header.nameBytes, names) ||
+      !ReadBlock(file, header.positionOffset, vertexCount * 3, data.verts) ||
+      !ReadBlock(file, header.uvOffset, hasUVs ? vertexCount * 2 : 0,
+                 data.uvs) ||
+      !ReadBlock(file, header.normalOffset, vertexCount * 3,
+                 data.normals) ||
+      !ReadBlock(file, header.indexOffset, header.indexCount, data.indices)) {
+    std::cerr << "MeshBinaryCache: '" << Path(source) << "' is truncated\n";
+    statistics.stale++;
+    return false;
+  }
+
+  if (!ReadHierarchy(submeshes, nodes, nodeSubmeshes, names, data)) {
+    std::cerr << "MeshBinaryCache: '" << Path(source) << "' is corrupt\n";
+    statistics.stale++;
+    return false;
+  }
+
+  data.hasUVs = hasUVs;
+  out = std::move(data);
+  statistics.hits++;
+  return true;
+}
+
+bool MeshBinaryCache::Store(const std::string &source, const MeshData &data) {
+  if (!data.successful) return false;
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  if (!File::GetStamp(source, header.source)) return false;
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.flags = data.hasUVs ? hasUVsFlag : 0;
+  header.vertexCount = data.VertexCount();
+  header.indexCount = data.indices.size();
+
+  std::vector<Submesh> submeshes;
+  std::vector<Node> nodes;
+  std::vector<std::uint32_t> nodeSubmeshes;
+  std::vector<char> names;
+  WriteHierarchy(data, submeshes, nodes, nodeSubmeshes, names);
+  header.submeshCount = submeshes.size();
+  header.nodeCount = nodes.size();
+  header.nodeSubmeshCount = nodeSubmeshes.size();
+  header.nameBytes = names.size();
+
+  std::string contents(sizeof(header), '\0');
+  header.submeshOffset = AppendBlock(contents, submeshes);
+  header.nodeOffset = AppendBlock(contents, nodes);
+  header.nodeSubmeshOffset = AppendBlock(contents, nodeSubmeshes);
+  header.nameOffset = AppendBlock(contents, names);
+  header.positionOffset = AppendBlock(contents, data.verts);
+  header.uvOffset = AppendBlock(contents, data.hasUVs ? data.uvs
+                                                      : std::vector<GLfloat>{});
+  header.normalOffset = AppendBlock(contents, data.normals);
+  header.indexOffset = AppendBlock(contents, data.indices);
+  std::memcpy(&contents[0], &header, sizeof(header));
+
+  try {
+    if (!Directory::Exists(directory)) Directory::Create(directory);
+    File::Write(Path(source), contents);
+  } catch (const FileAccessException &e) {
+    std::cerr << "MeshBinaryCache: " << e.what() << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool MeshBinaryCache::Bake(const std::string &source) {
+  MeshData data;
+  data.LoadFromSource(source);
+  return Store(source, data);
+}
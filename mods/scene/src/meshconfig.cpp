@@ -24,6 +24,11 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <algorithm>
+#include <assetprefetch.h>
+#include <base/texturestreamer.h>
+#include <base/window.h>
+#include <limits>
 #include <meshconfig.h>
 #include <test/macros.h>
 
@@ -31,45 +36,106 @@ std::unordered_map<std::string, MeshRenderConfigs::Generator>
     MeshRenderConfigs::configurationGenerators;
 
 void MeshRenderConfigs::UV::Setup(std::vector<VertexAttribute> &attributes) {
-  attributes.emplace_back(1, 2, 0, uvs);
+  attributes.emplace_back(1, 2, 0, std::move(uvs));
   uvs.clear();
 }
 
 void MeshRenderConfigs::Normal::Setup(
     std::vector<VertexAttribute> &attributes) {
-  attributes.emplace_back(0, 3, 0, normals);
+  attributes.emplace_back(0, 3, 0, std::move(normals));
   normals.clear();
 }
 
 void MeshRenderConfigs::Standard::Setup(
     std::vector<VertexAttribute> &attributes) {
-  attributes.emplace_back(1, 2, 0, uvs);
-  attributes.emplace_back(2, 3, 0, normals);
+  // Meshes with interleaved vertices have no separate attribute data
+  if (!uvs.empty()) attributes.emplace_back(1, 2, 0, std::move(uvs));
+  if (!normals.empty()) attributes.emplace_back(2, 3, 0, std::move(normals));
+  uvs.clear();
+  normals.clear();
 }
 
 void MeshRenderConfigs::Single::PreRender() {
-  auto mvp = NCamera::active->Matrix(globalTransform.Matrix());
+  auto model = globalTransform.Matrix();
+  auto *mesh = renderer ? renderer->GetMesh() : nullptr;
+  // Clusters are built before quantization, so their bounds are tested
+  // without the vertex transform
+  if (mesh && mesh->CanCull())
+    mesh->Cull(NCamera::active->Matrix(model),
+               model.Inverse() * NCamera::active->GlobalLocation());
+
+  if (hasVertexTransform) model *= vertexTransform;
+  auto mvp = NCamera::active->Matrix(model);
   mvpUniform.SetMatrix4(1, GL_FALSE, mvp);
+
+  projectedSize = 0.0f;
+  if (!mesh || !Window::Active()) return;
+  const auto &geometry = *mesh->GetGeometry();
+  if (geometry.GetBoundsRadius() <= 0.0f) return;
+
+  // The bounds' diameter scaled by the projection, over their distance in
+  // front of the camera. Bounds reaching behind the camera fill the screen
+  const auto &center = geometry.GetBoundsCenter();
+  auto w = (mvp * Vec4(center.x, center.y, center.z, 1.0f)).w;
+  if (w <= 0.0f) {
+    projectedSize = std::numeric_limits<float>::max();
+    return;
+  }
+
+  float scale = 0.0f;
+  for (int column = 0; column < 3; column++)
+    scale = std::max(scale, Vec3(model[column][0], model[column][1],
+                                 model[column][2]).Length());
+  auto projection = NCamera::active->ProjectionMatrix();
+  projectedSize = geometry.GetBoundsRadius() * scale * projection[1][1] *
+                  Window::Active()->Size().y / w;
 }
 
 void MeshRenderConfigs::Textures::GetUniforms(Shader &s) {
   textureUniforms.reserve(textures.size());
-  for (auto &pair : textures)
+  layerUniforms.reserve(textures.size());
+  for (auto &pair : textures) {
     textureUniforms.push_back(s.GetUniform(pair.uniform));
+
+    // Shaders which take the layer from an instance attribute have no uniform
+    auto layerName = HashString("Layer", HashString(pair.uniform));
+    if (pair.texture->IsLayer() && s.HasUniform(layerName))
+      layerUniforms.push_back(s.GetUniform(layerName));
+    else
+      layerUniforms.push_back(std::nullopt);
+  }
 }
 
 void MeshRenderConfigs::Textures::PreRender() {
   for (std::size_t i = 0; i < textureUniforms.size(); i++) {
-    glActiveTexture(GL_TEXTURE0 + i);
-    glBindTexture(GL_TEXTURE_2D, textures[i].texture->ID());
+    const auto &texture = *textures[i].texture;
+    texture.Bind(i);
     textureUniforms[i].Set(static_cast<GLint>(i));
+    if (layerUniforms[i])
+      layerUniforms[i]->Set(static_cast<GLfloat>(texture.Layer()));
+    if (TextureStreamer::active)
+      TextureStreamer::active->Request(texture,
+                                       single ? single->ProjectedSize() : 0.0f);
   }
 }
 
+void MeshRenderConfigs::Textures::AddDefinitions(
+    Shader::Definitions &definitions) const {
+  for (const auto &pair : textures)
+    if (pair.texture->IsLayer()) {
+      definitions["TEXTURE_ARRAY"] = "1";
+      return;
+    }
+}
+
 void MeshRenderConfigs::Lit::GetUniforms(Shader &s) {
-  specularUniform = s.GetUniform("material.specular");
-  shininessUniform = s.GetUniform("material.shininess");
-  modelUniform = s.GetUniform("model");
+  specularUniform = s.GetUniform(HashString("material.specular"));
+  shininessUniform = s.GetUniform(HashString("material.shininess"));
+  modelUniform = s.GetUniform(HashString("model"));
+
+  constexpr auto dequantize = HashString("dequantize");
+  hasDequantizeUniform = s.HasUniform(dequantize);
+  if (hasDequantizeUniform) dequantizeUniform = s.GetUniform(dequantize);
 }
 
 void MeshRenderConfigs::Lit::PreRender() {
@@ -87,6 +153,8 @@ void MeshRenderConfigs::Lit::PreRender() {
   specularUniform.Set(specular);
   shininessUniform.Set(shininess);
   modelUniform.SetMatrix4(1, false, t.Matrix());
+  if (hasDequantizeUniform && single)
+    dequantizeUniform.SetMatrix4(1, false, single->GetVertexTransform());
 }
 
 void JSONImpl<MeshRenderConfigs::NamedTexturePair>::Read(
@@ -96,6 +164,7 @@ void JSONImpl<MeshRenderConfigs::NamedTexturePair>::Read(
   const auto &object = JSON::GetObject(value, data);
   JSON::GetMember(out.uniform, "uniform", object, data);
   auto textureStr = JSON::GetMember<std::string>("texture", object, data);
+  if (AssetPrefetch::active) AssetPrefetch::active->UploadTexture(textureStr);
   out.texture = Resources::active->textures.Get(textureStr);
 }
 
@@ -24,10 +24,13 @@ SOFTWARE.
 ---------------------------------------------------------------------------
 */
 
+#include <assetprefetch.h>
 #include <assimp/postprocess.h>
+#include <base/assetstreamer.h>
 #include <base/resources.h>
 #include <instancedmesh.h>
 #include <mesh.h>
+#include <meshcache.h>
 #include <meshconfig.h>
 #include <meshload.h>
 #include <test/macros.h>
@@ -35,69 +38,300 @@ SOFTWARE.
 NMesh *MeshData::GenerateNMesh(const std::shared_ptr<Shader> &shader,
                                const std::shared_ptr<MeshRenderer> &mr,
                                MeshRenderConfigs::Single &single,
-                               MeshData::ConfigType &config,
+                               MeshData::ConfigType & /* config */,
                                unsigned instanceCount) {
-  if (!successful) return nullptr;
+  return MakeNMesh(shader, mr, single, GenerateGeometry(), instanceCount);
+}
 
-  GenerateHelper(mr, config, instanceCount);
+std::unique_ptr<InstancedMesh>
+MeshData::GenerateInstancedMesh(const std::shared_ptr<Shader> &shader,
+                                const std::shared_ptr<MeshRenderer> &mr,
+                                MeshData::ConfigType & /* config */,
+                                unsigned instanceCount) {
+  return MakeInstancedMesh(shader, mr, GenerateGeometry(), instanceCount);
+}
 
+NMesh *MeshData::MakeNMesh(const std::shared_ptr<Shader> &shader,
+                           const std::shared_ptr<MeshRenderer> &mr,
+                           MeshRenderConfigs::Single &single,
+                           std::shared_ptr<MeshGeometry> geometry,
+                           unsigned instanceCount) {
+  if (!geometry) return nullptr;
+  if (geometry->HasVertexTransform())
+    single.SetVertexTransform(geometry->GetVertexTransform());
+
+  mr->SetMeshAndSetupAttributes(
+      std::make_unique<Mesh>(std::move(geometry), instanceCount));
   auto nmesh = new NMesh(shader);
   nmesh->SetMeshRenderer(mr, single);
   return nmesh;
 }
 
-std::unique_ptr<InstancedMesh>
-MeshData::GenerateInstancedMesh(const std::shared_ptr<Shader> &shader,
-                                const std::shared_ptr<MeshRenderer> &mr,
-                                MeshData::ConfigType &config,
-                                unsigned instanceCount) {
-  if (!successful) return nullptr;
-  GenerateHelper(mr, config, instanceCount);
+NNode *MeshData::MakeModel(
+    const std::shared_ptr<ModelGeometry> &geometry,
+    const std::function<NMesh *(const MeshDataSubmesh &)> &makeMesh) {
+  if (!geometry || geometry->nodes.empty()) return nullptr;
+
+  std::vector<NNode *> created;
+  created.reserve(geometry->nodes.size());
+  for (const auto &node : geometry->nodes) {
+    auto *n = new NNode;
+    n->transform = node.transform;
+    if (node.parent >= 0) n->Parent(created[node.parent]);
+    created.push_back(n);
+
+    for (auto index : node.submeshes) {
+      const auto &submesh = geometry->submeshes[index];
+      auto *mesh = makeMesh(submesh);
+      if (!mesh) continue;
+      mesh->GetMeshRenderer()->GetMesh()->SetRange(submesh.Range());
+      mesh->Parent(n);
+    }
+  }
+  return created.front();
+}
 
+std::unique_ptr<InstancedMesh>
+MeshData::MakeInstancedMesh(const std::shared_ptr<Shader> &shader,
+                            const std::shared_ptr<MeshRenderer> &mr,
+                            std::shared_ptr<MeshGeometry> geometry,
+                            unsigned instanceCount) {
+  if (!geometry) return nullptr;
+  mr->SetMeshAndSetupAttributes(
+      std::make_unique<Mesh>(std::move(geometry), instanceCount));
   auto imesh = std::make_unique<InstancedMesh>(shader);
   imesh->SetMeshRenderer(mr);
   return imesh;
 }
 
-void MeshData::GenerateHelper(const std::shared_ptr<MeshRenderer> &mr,
-                              MeshData::ConfigType &config,
-                              unsigned instanceCount) {
-  auto mesh = std::make_unique<Mesh>(verts, indices, instanceCount);
+// Moves a vector out, leaving it empty rather than in an unspecified state
+template <typename T>
+static std::vector<T> Take(std::vector<T> &v) {
+  auto taken = std::move(v);
+  v.clear();
+  return taken;
+}
+
+void MeshData::ReleaseVertexData() {
+  std::vector<GLfloat>().swap(verts);
+  std::vector<GLfloat>().swap(uvs);
+  std::vector<GLfloat>().swap(normals);
+}
+
+std::shared_ptr<ModelGeometry> MeshData::MakeGeometry() {
+  auto geometry = std::make_shared<ModelGeometry>(Take(indices));
+  if (quantized) geometry->SetVertexTransform(dequantization);
+
+  // Quantized positions give bounds in the quantized space, which the
+  // dequantization transform maps along with the vertices
+  if (auto count = VertexCount()) {
+    Vec3 min{verts[0], verts[1], verts[2]}, max = min;
+    for (std::size_t i = 1; i < count; i++) {
+      Vec3 v{verts[i * 3], verts[i * 3 + 1], verts[i * 3 + 2]};
+      min = Vec3(std::min(min.x, v.x), std::min(min.y, v.y),
+                 std::min(min.z, v.z));
+      max = Vec3(std::max(max.x, v.x), std::max(max.y, v.y),
+                 std::max(max.z, v.z));
+    }
+    auto center = (min + max) * 0.5f;
+    float radius = 0.0f;
+    for (std::size_t i = 0; i < count; i++) {
+      Vec3 v{verts[i * 3], verts[i * 3 + 1], verts[i * 3 + 2]};
+      radius = std::max(radius, (v - center).Length());
+    }
+    geometry->SetBounds(center, radius);
+  }
+
+  geometry->submeshes = std::move(submeshes);
+  geometry->nodes = std::move(nodes);
+  geometry->SetMeshlets(Take(meshlets));
+  submeshes.clear();
+  nodes.clear();
+  return geometry;
+}
 
-  config.uvs = uvs;
-  config.normals = normals;
+std::shared_ptr<MeshGeometry> MeshData::GenerateGeometry() {
+  if (!successful) return nullptr;
 
-  mr->SetMeshAndSetupAttributes(std::move(mesh));
+  auto geometry = MakeGeometry();
+  geometry->AddAttribute({0, 3, 0, Take(verts)});
+  if (!uvs.empty()) geometry->AddAttribute({1, 2, 0, Take(uvs)});
+  if (!normals.empty()) geometry->AddAttribute({2, 3, 0, Take(normals)});
+  return geometry;
 }
 
-void MeshData::Load(const aiMesh *mesh) {
-  hasUVs = true;
+std::ostream &operator<<(std::ostream &os, const QuantizationReport &report) {
+  os << "max position error " << report.maxPositionError
+     << ", max normal error " << report.maxNormalError
+     << " degrees, max UV error " << report.maxUVError << ", "
+     << report.bytesBefore << " -> " << report.bytesAfter << " bytes";
+  return os;
+}
+
+QuantizationReport MeshData::Quantize() {
+  QuantizationReport report;
+  auto count = VertexCount();
+  if (!count || quantized) return report;
+
+  Vec3 min{verts[0], verts[1], verts[2]}, max = min;
+  for (std::size_t i = 0; i < count; i++) {
+    Vec3 v{verts[i * 3], verts[i * 3 + 1], verts[i * 3 + 2]};
+    min = Vec3(std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z));
+    max = Vec3(std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z));
+  }
+
+  // Avoid dividing by zero for flat meshes
+  float extent[] = {max.x - min.x, max.y - min.y, max.z - min.z};
+  for (auto &e : extent)
+    if (e <= 0.0f) e = 1.0f;
+  const float origin[] = {min.x, min.y, min.z};
+
+  for (std::size_t i = 0; i < count * 3; i++) {
+    auto axis = i % 3;
+    auto original = verts[i];
+    verts[i] = (original - origin[axis]) / extent[axis];
+
+    auto stored =
+        VertexFormats::ToUNorm(verts[i], 16) / 65535.0f * extent[axis] +
+        origin[axis];
+    report.maxPositionError =
+        std::max(report.maxPositionError, std::abs(stored - original));
+  }
+
+  for (std::size_t i = 0; i + 2 < normals.size(); i += 3) {
+    float encoded[2], decoded[3];
+    VertexFormats::OctEncode(&normals[i], encoded);
+    for (auto &e : encoded)
+      e = VertexFormats::ToSNorm(e, 16) / 32767.0f;
+    VertexFormats::OctDecode(encoded, decoded);
+
+    float length = std::sqrt(normals[i] * normals[i] +
+                             normals[i + 1] * normals[i + 1] +
+                             normals[i + 2] * normals[i + 2]);
+    if (length == 0.0f) continue;
+    float cosine = (normals[i] * decoded[0] + normals[i + 1] * decoded[1] +
+                    normals[i + 2] * decoded[2]) /
+                   length;
+    auto angle = Math::Degrees(std::acos(std::min(std::max(cosine, -1.0f), 1.0f)));
+    report.maxNormalError = std::max(report.maxNormalError, angle);
+  }
+
+  for (auto uv : uvs) {
+    auto stored = VertexFormats::FromHalf(VertexFormats::ToHalf(uv));
+    report.maxUVError = std::max(report.maxUVError, std::abs(stored - uv));
+  }
+
+  report.bytesBefore = count * MeshLayouts::Interleaved::stride;
+  report.bytesAfter = count * MeshLayouts::Quantized::stride;
+
+  dequantization = Mat4::Translate(min.x, min.y, min.z) *
+                   Mat4::Scale(extent[0], extent[1], extent[2]);
+  quantized = true;
+  return report;
+}
+
+std::ostream &operator<<(std::ostream &os,
+                         const MeshOptimizationReport &report) {
+  os << report.original << " -> vertex cache: " << report.vertexCache
+     << " -> overdraw: " << report.overdraw
+     << " -> vertex fetch: " << report.vertexFetch << ", indices "
+     << report.indexBytesBefore << " -> " << report.indexBytesAfter
+     << " bytes";
+  return os;
+}
+
+MeshOptimizationReport
+MeshData::Optimize(const MeshOptimizationSettings &settings) {
+  MeshOptimizationReport report;
+  report.indexBytesBefore = indices.size() * sizeof(GLuint);
+  if (submeshes.size() > 1) {
+    std::cerr << "Meshes with more than one submesh can't be optimized\n";
+    report.indexBytesAfter = report.indexBytesBefore;
+    return report;
+  }
+
+  auto analyze = [this] {
+    return MeshOptimizer::AnalyzeVertexCache(indices, VertexCount());
+  };
+  report.original = analyze();
+
+  if (settings.vertexCache)
+    MeshOptimizer::OptimizeVertexCache(indices, VertexCount());
+  report.vertexCache = analyze();
+
+  if (settings.overdraw)
+    MeshOptimizer::OptimizeOverdraw(indices, verts, VertexCount(),
+                                    settings.overdrawThreshold);
+  report.overdraw = analyze();
+
+  if (settings.vertexFetch) {
+    auto vertexCount = VertexCount();
+    auto remap = MeshOptimizer::OptimizeVertexFetch(indices, vertexCount);
+    MeshOptimizer::RemapVertices(verts, 3, remap);
+    if (normals.size() == vertexCount * 3)
+      MeshOptimizer::RemapVertices(normals, 3, remap);
+    if (uvs.size() == vertexCount * 2)
+      MeshOptimizer::RemapVertices(uvs, 2, remap);
+  }
+  report.vertexFetch = analyze();
+
+  report.indexBytesAfter =
+      indices.size() *
+      ElementBuffer::IndexSize(ElementBuffer::IndexType(indices));
+  return report;
+}
+
+std::size_t MeshData::BuildMeshlets(unsigned maxTriangles,
+                                   unsigned maxVertices) {
+  if (submeshes.size() > 1) {
+    std::cerr << "Meshes with more than one submesh can't be clustered\n";
+    return 0;
+  }
+
+  meshlets = Meshlets::Build(indices, verts, VertexCount(), maxTriangles,
+                             maxVertices);
+  return meshlets.size();
+}
+
+void MeshData::AppendMesh(const aiMesh *mesh) {
+  MeshDataSubmesh submesh;
+  submesh.name = mesh->mName.C_Str();
+  submesh.firstIndex = indices.size();
+  submesh.baseVertex = VertexCount();
+  submesh.vertexCount = mesh->mNumVertices;
+
   for (auto i = 0u; i < mesh->mNumVertices; i++) {
     auto vert = mesh->mVertices[i];
     verts.push_back(vert.x);
     verts.push_back(vert.y);
     verts.push_back(vert.z);
 
-    auto normal = mesh->mNormals[i];
+    auto normal = mesh->mNormals ? mesh->mNormals[i] : aiVector3D{0, 0, 0};
     normals.push_back(normal.x);
     normals.push_back(normal.y);
     normals.push_back(normal.z);
 
-    // Does the mesh have texture coordinates?
+    // Meshes without texture coordinates are padded so that the attributes
+    // of every submesh line up
     // REVIEW: Consider multiple sets of UV coords?
     if (mesh->mTextureCoords[0]) {
       auto coords = mesh->mTextureCoords[0][i];
       uvs.push_back(coords.x);
       uvs.push_back(coords.y);
-    } else
-      hasUVs = false;
+    } else {
+      uvs.push_back(0.0f);
+      uvs.push_back(0.0f);
+    }
   }
+  if (mesh->mTextureCoords[0]) hasUVs = true;
 
   for (auto i = 0u; i < mesh->mNumFaces; i++) {
     auto face = mesh->mFaces[i];
     for (auto j = 0u; j < face.mNumIndices; j++)
       indices.push_back(face.mIndices[j]);
   }
+  submesh.indexCount = indices.size() - submesh.firstIndex;
+  submeshes.push_back(std::move(submesh));
 
   // TODO:
   // if (mesh->mMaterialIndex >= 0) {
@@ -105,6 +339,32 @@ void MeshData::Load(const aiMesh *mesh) {
   // }
 }
 
+void MeshData::AppendNode(const aiNode *node, int parent) {
+  aiVector3D scale, location;
+  aiQuaternion rotation;
+  node->mTransformation.Decompose(scale, rotation, location);
+
+  MeshDataNode out;
+  out.name = node->mName.C_Str();
+  out.parent = parent;
+  out.transform =
+      Transform{Vec3(location.x, location.y, location.z),
+                Quat(rotation.x, rotation.y, rotation.z, rotation.w),
+                Vec3(scale.x, scale.y, scale.z)};
+  out.submeshes.assign(node->mMeshes, node->mMeshes + node->mNumMeshes);
+
+  int index = nodes.size();
+  nodes.push_back(std::move(out));
+  for (auto i = 0u; i < node->mNumChildren; i++)
+    AppendNode(node->mChildren[i], index);
+}
+
+void MeshData::Load(const aiMesh *mesh) {
+  hasUVs = false;
+  AppendMesh(mesh);
+  if (!hasUVs) uvs.clear();
+}
+
 static constexpr const auto sceneProcessFlags =
     aiProcess_Triangulate | aiProcess_CalcTangentSpace;
 
@@ -119,19 +379,58 @@ const aiScene *LoadScene(const std::string &path, Assimp::Importer &importer) {
 }
 
 void MeshData::Load(const std::string &path) {
+  LoadModel(path);
+  RequireSingleMesh();
+}
+
+void MeshData::LoadModel(const std::string &path) {
+  if (MeshBinaryCache::Load(path, *this)) return;
+
+  LoadFromSource(path);
+  if (successful && MeshBinaryCache::enabled)
+    MeshBinaryCache::Store(path, *this);
+}
+
+void MeshData::LoadFromSource(const std::string &path) {
   Assimp::Importer importer;
   const auto *scene = LoadScene(path, importer);
-  const auto *meshes = scene->mRootNode->mChildren[0];
-
-  if (meshes->mNumMeshes != 1) {
-    std::cerr
-        << "Failed to load mesh - there is more than one mesh in the file\n";
+  if (!scene || scene->mNumMeshes == 0) {
+    if (scene) std::cerr << "Failed to load mesh - there are no meshes in '"
+                         << path << "'\n";
     successful = false;
     hasUVs = false;
     return;
   }
 
-  Load(scene->mMeshes[meshes->mMeshes[0]]);
+  // Reserve space for every mesh up front, as they are copied one after
+  // another into the same arrays
+  std::size_t vertexCount = 0, indexCount = 0;
+  for (auto i = 0u; i < scene->mNumMeshes; i++) {
+    const auto *mesh = scene->mMeshes[i];
+    vertexCount += mesh->mNumVertices;
+    for (auto j = 0u; j < mesh->mNumFaces; j++)
+      indexCount += mesh->mFaces[j].mNumIndices;
+  }
+  verts.reserve(vertexCount * 3);
+  normals.reserve(vertexCount * 3);
+  uvs.reserve(vertexCount * 2);
+  indices.reserve(indexCount);
+
+  hasUVs = false;
+  for (auto i = 0u; i < scene->mNumMeshes; i++) AppendMesh(scene->mMeshes[i]);
+  if (!hasUVs) uvs.clear();
+
+  AppendNode(scene->mRootNode, -1);
+}
+
+bool MeshData::RequireSingleMesh() {
+  if (submeshes.size() <= 1) return true;
+
+  std::cerr
+      << "Failed to load mesh - there is more than one mesh in the file\n";
+  successful = false;
+  hasUVs = false;
+  return false;
 }
 
 static auto ReadMeshConfig(const JSON::Value &value,
@@ -153,6 +452,92 @@ static auto ReadMeshConfig(const JSON::Value &value,
   return (generatorIt->second)(dataIt->value, data);
 }
 
+static void CheckLayout(const std::string &layout,
+                        const JSON::ReadData &data) {
+  if (layout != "separate" && layout != "interleaved" && layout != "packed" &&
+      layout != "quantized")
+    JSON::ParseError(data, "Unknown vertex layout '" + layout + "'");
+}
+
+// Reads the options shared by single meshes and models
+static auto ReadShader(const JSON::ConstObject &object,
+                       const std::string &layout,
+                       const Shader::Definitions &configDefinitions,
+                       const JSON::ReadData &data) {
+  auto shaderStr = JSON::GetMember<std::string>("shader", object, data);
+  // Meshes can ask for a variant of the shader with extra definitions, which
+  // are added to those their config needs
+  Shader::Definitions definitions;
+  JSON::TryGetMember(definitions, "definitions", object, {}, data);
+  definitions.insert(std::begin(configDefinitions),
+                     std::end(configDefinitions));
+  if (layout == "quantized") definitions["QUANTIZED_VERTICES"] = "1";
+  return definitions.empty()
+             ? Resources::active->shaders.Get(shaderStr)
+             : Resources::active->GetShaderVariant(shaderStr, definitions);
+}
+
+static std::shared_ptr<MeshGeometry> GenerateLayout(MeshData &meshData,
+                                                    const std::string &layout,
+                                                    const std::string &path) {
+  if (layout == "interleaved")
+    return meshData.GenerateGeometry<MeshLayouts::Interleaved>();
+  if (layout == "packed")
+    return meshData.GenerateGeometry<MeshLayouts::Packed>();
+  if (layout == "quantized") {
+    std::clog << "Quantized mesh '" << path << "': " << meshData.Quantize()
+              << '\n';
+    return meshData.GenerateGeometry<MeshLayouts::Quantized>();
+  }
+  return meshData.GenerateGeometry();
+}
+
+// Takes a mesh's data from the active prefetch, or loads it
+static MeshData LoadMeshData(const std::string &path, bool singleMesh) {
+  MeshData meshData;
+  if (AssetPrefetch::active &&
+      AssetPrefetch::active->TakeMesh(path, meshData)) {
+    if (singleMesh) meshData.RequireSingleMesh();
+  } else if (singleMesh)
+    meshData.Load(path);
+  else
+    meshData.LoadModel(path);
+  return meshData;
+}
+
+// Loads a mesh on the streamer's workers and gives it to the renderer once it
+// has been uploaded. The active Resources must outlive the streamer's uploads
+template <typename Prepare>
+static void StreamMesh(AssetStreamer &streamer, const std::string &key,
+                       const std::string &path, Prepare prepare,
+                       const std::shared_ptr<MeshRenderer> &mr,
+                       MeshRenderConfigs::Single &single,
+                       unsigned instanceCount) {
+  std::weak_ptr<MeshRenderer> weakRenderer = mr;
+  auto *singlePtr = &single;
+  streamer.Submit(
+      "mesh:" + key, [path, prepare] { return prepare(MeshData(path)); },
+      [=](std::shared_ptr<MeshGeometry> &geometry) -> std::size_t {
+        // The config is owned by the renderer, so it is only used while the
+        // renderer is alive
+        auto renderer = weakRenderer.lock();
+        if (!renderer) return 0;
+        if (!geometry) {
+          std::cerr << "Failed to stream mesh '" << path << "'\n";
+          return 0;
+        }
+
+        // Another mesh may have finished loading the same geometry first
+        auto shared =
+            Resources::active->meshes.Get(key, [&] { return geometry; });
+        if (shared->HasVertexTransform())
+          singlePtr->SetVertexTransform(shared->GetVertexTransform());
+        renderer->SetMeshAndSetupAttributes(
+            std::make_unique<Mesh>(shared, instanceCount));
+        return renderer->GetResidency().gpuBytes;
+      });
+}
+
 NMesh *MeshTypeRegistration(const JSON::Value &value,
                             const JSON::ReadData &data) {
   auto t = Trace::Pusher{data.trace, "MeshTypeRegistration"};
@@ -168,13 +553,129 @@ NMesh *MeshTypeRegistration(const JSON::Value &value,
   auto instanceCount =
       JSON::GetMember<unsigned>("instance-count", object, data);
 
-  auto shaderStr = JSON::GetMember<std::string>("shader", object, data);
-  auto shader = Resources::active->shaders.Get(shaderStr);
+  auto layout = JSON::TryGetMember<std::string>("vertex-layout", object,
+                                                "separate", data);
+  CheckLayout(layout, data);
+  auto shader = ReadShader(object, layout, config.definitions, data);
+
+  auto keepCPUData =
+      JSON::TryGetMember<bool>("keep-cpu-data", object, false, data);
+  config.meshRenderer->KeepCPUData(keepCPUData);
+
+  auto clusters = JSON::TryGetMember<bool>("clusters", object, false, data);
+
+  auto optimize =
+      JSON::TryGetMember<std::string>("optimize", object, "none", data);
+  MeshOptimizationSettings optimizeSettings;
+  if (optimize == "overdraw")
+    optimizeSettings.overdraw = true;
+  else if (optimize != "none" && optimize != "vertex-cache")
+    JSON::ParseError(data, "Unknown mesh optimization '" + optimize + "'");
+
+  // Every option which changes the uploaded data is part of the key, so that
+  // meshes only share geometry when it is identical
+  auto key = path + '\n' + layout + '\n' + optimize +
+             (keepCPUData ? "\nkeep-cpu-data" : "") +
+             (clusters ? "\nclusters" : "");
+  // Turns the mesh's data into geometry. Only uses the CPU, so it can run on
+  // a worker thread when streaming
+  auto prepare = [=](MeshData meshData) {
+    if (optimize != "none")
+      std::clog << "Optimized mesh '" << path
+                << "': " << meshData.Optimize(optimizeSettings) << '\n';
+    if (clusters && meshData.successful)
+      std::clog << "Split mesh '" << path << "' into "
+                << meshData.BuildMeshlets() << " clusters\n";
+    return GenerateLayout(meshData, layout, path);
+  };
+
+  auto geometry = Resources::active->meshes.Find(key);
+  if (!geometry && AssetStreamer::active && !AssetPrefetch::active) {
+    // Draw nothing until the mesh has been streamed in
+    auto nmesh = new NMesh(shader);
+    nmesh->SetMeshRenderer(config.meshRenderer, config.single);
+    StreamMesh(*AssetStreamer::active, key, path, prepare,
+               config.meshRenderer, config.single, instanceCount);
+    JSON::GetMember<NNode>(*nmesh, "NNode", object, data);
+    return nmesh;
+  }
+
+  if (!geometry)
+    geometry = Resources::active->meshes.Get(
+        key, [&] { return prepare(LoadMeshData(path, true)); });
 
-  auto nmesh =
-      MeshData(path).GenerateNMesh(shader, config.meshRenderer, config.single,
-                                   config.standard, instanceCount);
+  auto nmesh = MeshData::MakeNMesh(shader, config.meshRenderer, config.single,
+                                   std::move(geometry), instanceCount);
+  JSON::ParseFailIf(!nmesh, data, "Failed to load mesh '" + path + "'");
 
   JSON::GetMember<NNode>(*nmesh, "NNode", object, data);
   return nmesh;
 }
+
+NNode *ModelTypeRegistration(const JSON::Value &value,
+                             const JSON::ReadData &data) {
+  auto t = Trace::Pusher{data.trace, "ModelTypeRegistration"};
+
+  const auto &object = JSON::GetObject(value, data);
+  const auto path = JSON::GetMember<std::string>("path", object, data);
+
+  const auto configObjIt = object.FindMember("config");
+  JSON::ParseFailIf(configObjIt == object.MemberEnd(), data,
+                    "Member 'config' must be present");
+  const auto meshConfigsIt = object.FindMember("mesh-configs");
+  JSON::ParseFailIf(meshConfigsIt != object.MemberEnd() &&
+                        !meshConfigsIt->value.IsObject(),
+                    data, "Member 'mesh-configs' must be of type object");
+
+  auto instanceCount =
+      JSON::TryGetMember<unsigned>("instance-count", object, 1, data);
+
+  auto layout = JSON::TryGetMember<std::string>("vertex-layout", object,
+                                                "separate", data);
+  CheckLayout(layout, data);
+
+  auto keepCPUData =
+      JSON::TryGetMember<bool>("keep-cpu-data", object, false, data);
+  JSON::ParseFailIf(object.HasMember("optimize"), data,
+                    "Models can't be optimized");
+  JSON::ParseFailIf(object.HasMember("clusters"), data,
+                    "Models can't be split into clusters");
+
+  auto key = path + '\n' + layout + "\nmodel" +
+             (keepCPUData ? "\nkeep-cpu-data" : "");
+  // Geometry under a model key is always created by GenerateLayout, which
+  // creates ModelGeometry
+  auto geometry = std::static_pointer_cast<ModelGeometry>(
+      Resources::active->meshes.Get(key, [&] {
+        auto meshData = LoadMeshData(path, false);
+        if (meshData.successful)
+          std::clog << "Loaded model '" << path << "' with "
+                    << meshData.submeshes.size() << " meshes and "
+                    << meshData.nodes.size() << " nodes\n";
+        return GenerateLayout(meshData, layout, path);
+      }));
+
+  auto *model = MeshData::MakeModel(geometry, [&](const auto &submesh) {
+    const auto *configValue = &configObjIt->value;
+    if (meshConfigsIt != object.MemberEnd()) {
+      const auto &meshConfigs = meshConfigsIt->value;
+      auto it = meshConfigs.FindMember(submesh.name.c_str());
+      if (it != meshConfigs.MemberEnd()) configValue = &it->value;
+    }
+
+    // Each mesh's config may need a different variant of the shader
+    auto config = ReadMeshConfig(*configValue, data);
+    config.meshRenderer->KeepCPUData(keepCPUData);
+    auto shader = ReadShader(object, layout, config.definitions, data);
+    return MeshData::MakeNMesh(shader, config.meshRenderer, config.single,
+                               geometry, instanceCount);
+  });
+  JSON::ParseFailIf(!model, data, "Failed to load model '" + path + "'");
+
+  // The root of the file's hierarchy keeps its own transform, which often
+  // converts between coordinate systems
+  auto *root = new NNode;
+  model->Parent(root);
+  JSON::GetMember<NNode>(*root, "NNode", object, data);
+  return root;
+}
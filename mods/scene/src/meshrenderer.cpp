@@ -24,6 +24,7 @@ SOFTWARE.
 -------------------------------------------------------------------------------
 */
 
+#include <cassert>
 #include <meshrenderer.h>
 
 void MeshRenderer::SetMeshAndSetupAttributes(std::unique_ptr<Mesh> _mesh) {
@@ -31,7 +32,18 @@ void MeshRenderer::SetMeshAndSetupAttributes(std::unique_ptr<Mesh> _mesh) {
   assert(mesh);
 
   Setup();
+  mesh->KeepData(keepCPUData);
+  for (auto &va : vertexAttributes) va.KeepData(keepCPUData);
   mesh->Setup([this] {
-    for (auto &va : vertexAttributes) va.Setup();
+    bool setup = true;
+    for (auto &va : vertexAttributes) setup = va.Setup() && setup;
+    return setup;
   });
 }
+
+Residency MeshRenderer::GetResidency() const {
+  Residency residency;
+  if (mesh) residency = mesh->GetResidency();
+  for (const auto &va : vertexAttributes) residency += va.GetResidency();
+  return residency;
+}
@@ -28,15 +28,15 @@ SOFTWARE.
 
 #include <base/shader.h>
 
-void NPointLight::SetUniformData(const std::string &prefix) const {
+void NPointLight::SetUniformData(StringHash prefix) const {
   auto s = Shader::Current();
-  s->GetUniform(prefix + ".location").Set(transform.Location());
-  s->GetUniform(prefix + ".ambient").Set(ambient);
-  s->GetUniform(prefix + ".diffuse").Set(diffuse);
-  s->GetUniform(prefix + ".specular").Set(specular);
-  s->GetUniform(prefix + ".constant").Set(constant);
-  s->GetUniform(prefix + ".linear").Set(linear);
-  s->GetUniform(prefix + ".quadratic").Set(quadratic);
+  s->GetUniform(HashString(".location", prefix)).Set(transform.Location());
+  s->GetUniform(HashString(".ambient", prefix)).Set(ambient);
+  s->GetUniform(HashString(".diffuse", prefix)).Set(diffuse);
+  s->GetUniform(HashString(".specular", prefix)).Set(specular);
+  s->GetUniform(HashString(".constant", prefix)).Set(constant);
+  s->GetUniform(HashString(".linear", prefix)).Set(linear);
+  s->GetUniform(HashString(".quadratic", prefix)).Set(quadratic);
 }
 
 void JSONImpl<NPointLight>::Read(NPointLight &out, const JSON::Value &value, const JSON::ReadData &data) {
@@ -75,4 +75,5 @@ void RegisterSceneTypeAssociations(JSON::TypeManager &manager) {
   manager["NDirectionalLight"] = DefaultNodeTypeRegistration<NDirectionalLight>;
   manager["Tagged"] = TaggedTypeRegistration;
   manager["NMesh"] = MeshTypeRegistration;
+  manager["NModel"] = ModelTypeRegistration;
 }
@@ -0,0 +1,715 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <scenecache.h>
+
+#include <assetprefetch.h>
+#include <base/stringhash.h>
+#include <core/file.h>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <scene.h>
+#include <sstream>
+#include <tagmanager.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+SceneCache::Statistics SceneCache::statistics;
+bool SceneCache::enabled = true;
+std::string SceneCache::directory = "cache/scenes/";
+
+namespace {
+constexpr char magic[4] = {'E', 'R', 'S', 'S'};
+constexpr std::uint32_t version = 2;
+constexpr std::size_t blockAlignment = 16;
+
+// Values nested deeper than this are treated as a corrupt file
+constexpr unsigned maxDepth = 256;
+
+// The tag of a node which isn't tagged
+constexpr std::uint32_t noTag = std::numeric_limits<std::uint32_t>::max();
+
+// Memory each node's value is decoded into before the pool has to allocate
+constexpr std::size_t nodeMemory = 16 * 1024;
+
+struct Header {
+  char magic[4];
+  std::uint32_t version;
+
+  // The source the scene was compiled from
+  File::Stamp source;
+
+  std::uint32_t stringCount, stringBytes;
+  std::uint32_t typeCount, meshCount, textureCount, nodeCount;
+  std::uint64_t nodeBytes;
+
+  // Offsets of each block from the start of the file
+  std::uint64_t nameOffset, stringOffset, typeOffset, meshOffset,
+      textureOffset, nodeOffset;
+};
+
+/*
+ * A string in the block of strings, which is followed by a null character
+ */
+struct Name {
+  std::uint32_t offset, length;
+};
+
+/*
+ * Precedes each value. Numbers and string indices follow their tag directly,
+ * arrays and objects follow it with their size, and packed arrays with their
+ * size and then every element
+ */
+enum class Tag : std::uint8_t {
+  Null,
+  False,
+  True,
+  Int,
+  Uint,
+  Int64,
+  Uint64,
+  Double,
+  String,
+  Array,
+  Object,
+  IntArray,
+  DoubleArray
+};
+
+std::size_t Align(std::size_t offset) {
+  return (offset + blockAlignment - 1) / blockAlignment * blockAlignment;
+}
+
+bool Fits(std::uint64_t offset, std::uint64_t bytes, std::size_t size) {
+  return offset <= size && bytes <= size - offset;
+}
+
+template <typename T>
+std::uint64_t AppendBlock(std::string &contents, const T *data,
+                          std::size_t count) {
+  auto offset = Align(contents.size());
+  contents.resize(offset + count * sizeof(T), '\0');
+  if (count) std::memcpy(&contents[offset], data, count * sizeof(T));
+  return offset;
+}
+
+bool IsString(const JSON::Value &value, const char *string) {
+  return value.IsString() && std::strcmp(value.GetString(), string) == 0;
+}
+
+/*
+ * Whether a node is a 'Tagged' node in the form TaggedTypeRegistration reads
+ */
+bool IsTagged(const JSON::Value &type, const JSON::Value &data) {
+  if (!IsString(type, "Tagged") || !data.IsArray() || data.Size() != 3 ||
+      !data[0u].IsObject() || !data[1u].IsString())
+    return false;
+  auto tagIt = data[0u].FindMember("tag");
+  return tagIt != data[0u].MemberEnd() && tagIt->value.IsString();
+}
+
+class SceneWriter {
+  std::unordered_map<std::string, std::uint32_t> ids;
+  std::unordered_map<std::uint32_t, std::uint32_t> typeIndices;
+  std::unordered_set<std::uint32_t> textureIds;
+
+  template <typename T>
+  void Put(const T &value) {
+    nodes.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  std::uint32_t Intern(const char *string, std::size_t length) {
+    std::string key(string, length);
+    auto it = ids.find(key);
+    if (it != ids.end()) return it->second;
+
+    auto id = static_cast<std::uint32_t>(names.size());
+    names.push_back({static_cast<std::uint32_t>(strings.size()),
+                     static_cast<std::uint32_t>(length)});
+    strings.insert(strings.end(), string, string + length);
+    strings.push_back('\0');
+    ids.emplace(std::move(key), id);
+    return id;
+  }
+
+  std::uint32_t Intern(const JSON::Value &string) {
+    return Intern(string.GetString(), string.GetStringLength());
+  }
+
+  std::uint32_t TypeIndex(const JSON::Value &type) {
+    auto id = Intern(type);
+    auto it = typeIndices.find(id);
+    if (it != typeIndices.end()) return it->second;
+
+    auto index = static_cast<std::uint32_t>(types.size());
+    types.push_back(id);
+    typeIndices.emplace(id, index);
+    return index;
+  }
+
+  // Finds assets the same way as AssetPrefetch::Collect
+  void Collect(const JSON::Value &value) {
+    if (value.IsArray()) {
+      for (const auto &element : value.GetArray()) Collect(element);
+      return;
+    }
+    if (!value.IsObject()) return;
+
+    auto pathIt = value.FindMember("path");
+    if (pathIt != value.MemberEnd() && pathIt->value.IsString() &&
+        value.HasMember("shader"))
+      meshes.push_back(Intern(pathIt->value));
+
+    auto textureIt = value.FindMember("texture");
+    if (textureIt != value.MemberEnd() && textureIt->value.IsString()) {
+      auto id = Intern(textureIt->value);
+      if (textureIds.insert(id).second) textures.push_back(id);
+    }
+
+    for (const auto &member : value.GetObject()) Collect(member.value);
+  }
+
+  void WriteArray(const JSON::ConstArray &array) {
+    auto count = static_cast<std::uint32_t>(array.Size());
+    bool ints = count > 0, doubles = count > 0;
+    for (const auto &element : array) {
+      ints = ints && element.IsInt();
+      doubles = doubles && element.IsDouble();
+    }
+
+    if (ints) {
+      Put(Tag::IntArray);
+      Put(count);
+      for (const auto &element : array) Put(std::int32_t{element.GetInt()});
+    } else if (doubles) {
+      Put(Tag::DoubleArray);
+      Put(count);
+      for (const auto &element : array) Put(element.GetDouble());
+    } else {
+      Put(Tag::Array);
+      Put(count);
+      for (const auto &element : array) Write(element);
+    }
+  }
+
+  void Write(const JSON::Value &value) {
+    if (value.IsNull()) {
+      Put(Tag::Null);
+    } else if (value.IsBool()) {
+      Put(value.GetBool() ? Tag::True : Tag::False);
+    } else if (value.IsInt()) {
+      Put(Tag::Int);
+      Put(std::int32_t{value.GetInt()});
+    } else if (value.IsUint()) {
+      Put(Tag::Uint);
+      Put(std::uint32_t{value.GetUint()});
+    } else if (value.IsInt64()) {
+      Put(Tag::Int64);
+      Put(std::int64_t{value.GetInt64()});
+    } else if (value.IsUint64()) {
+      Put(Tag::Uint64);
+      Put(std::uint64_t{value.GetUint64()});
+    } else if (value.IsNumber()) {
+      Put(Tag::Double);
+      Put(value.GetDouble());
+    } else if (value.IsString()) {
+      Put(Tag::String);
+      Put(Intern(value));
+    } else if (value.IsArray()) {
+      WriteArray(value.GetArray());
+    } else {
+      const auto &object = value.GetObject();
+      Put(Tag::Object);
+      Put(static_cast<std::uint32_t>(object.MemberCount()));
+      for (const auto &member : object) {
+        Put(Intern(member.name));
+        Write(member.value);
+      }
+    }
+  }
+
+  void WriteNode(const JSON::Value &type, const JSON::Value &data) {
+    if (IsTagged(type, data)) {
+      Put(TypeIndex(data[1u]));
+      Put(Intern(data[0u]["tag"]));
+      Write(data[2u]);
+    } else {
+      Put(TypeIndex(type));
+      Put(noTag);
+      Write(data);
+    }
+    Collect(data);
+    nodeCount++;
+  }
+
+public:
+  std::vector<Name> names;
+  std::vector<char> strings;
+
+  // String indices of the node types, meshes and textures
+  std::vector<std::uint32_t> types, meshes, textures;
+
+  std::string nodes;
+  std::uint32_t nodeCount = 0;
+
+  /*
+   * @returns false if the value isn't a scene, with its nodes in pairs of a
+   * type name and data like JSONImpl<Scene> reads
+   */
+  bool WriteScene(const JSON::Value &scene) {
+    if (!scene.IsObject()) return false;
+    auto nodesIt = scene.FindMember("nodes");
+    if (nodesIt == scene.MemberEnd() || !nodesIt->value.IsArray())
+      return false;
+
+    const auto &array = nodesIt->value.GetArray();
+    if (array.Size() % 2 != 0) return false;
+    for (rapidjson::SizeType i = 0; i < array.Size(); i += 2) {
+      if (!array[i].IsString()) return false;
+      WriteNode(array[i], array[i + 1]);
+    }
+    return true;
+  }
+};
+
+/*
+ * Sends the values of a compiled scene to a rapidjson handler, such as a
+ * document. Strings point into the block of strings, which must outlive the
+ * handler's values
+ */
+class SceneReader {
+  const char *cursor, *end;
+  const std::vector<Name> &names;
+  const char *strings;
+
+  bool TakeName(Name &out) {
+    std::uint32_t id;
+    if (!Take(id) || id >= names.size()) return false;
+    out = names[id];
+    return true;
+  }
+
+  template <typename T, typename Handler, typename Emit>
+  bool ReadPacked(Handler &handler, Emit emit) {
+    std::uint32_t count;
+    if (!Take(count) ||
+        static_cast<std::size_t>(end - cursor) / sizeof(T) < count ||
+        !handler.StartArray())
+      return false;
+    for (std::uint32_t i = 0; i < count; i++) {
+      T value;
+      Take(value);
+      if (!emit(value)) return false;
+    }
+    return handler.EndArray(count);
+  }
+
+public:
+  SceneReader(const char *begin, std::size_t size,
+              const std::vector<Name> &_names, const char *_strings)
+      : cursor(begin), end(begin + size), names(_names), strings(_strings) {}
+
+  bool Finished() const { return cursor == end; }
+
+  template <typename T>
+  bool Take(T &out) {
+    if (static_cast<std::size_t>(end - cursor) < sizeof(T)) return false;
+    std::memcpy(&out, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+  }
+
+  template <typename Handler>
+  bool Read(Handler &handler, unsigned depth = 0) {
+    Tag tag;
+    if (depth > maxDepth || !Take(tag)) return false;
+
+    switch (tag) {
+    case Tag::Null:
+      return handler.Null();
+    case Tag::False:
+      return handler.Bool(false);
+    case Tag::True:
+      return handler.Bool(true);
+    case Tag::Int: {
+      std::int32_t value;
+      return Take(value) && handler.Int(value);
+    }
+    case Tag::Uint: {
+      std::uint32_t value;
+      return Take(value) && handler.Uint(value);
+    }
+    case Tag::Int64: {
+      std::int64_t value;
+      return Take(value) && handler.Int64(value);
+    }
+    case Tag::Uint64: {
+      std::uint64_t value;
+      return Take(value) && handler.Uint64(value);
+    }
+    case Tag::Double: {
+      double value;
+      return Take(value) && handler.Double(value);
+    }
+    case Tag::String: {
+      Name name;
+      return TakeName(name) &&
+             handler.String(strings + name.offset, name.length, false);
+    }
+    case Tag::Array: {
+      std::uint32_t count;
+      if (!Take(count) || !handler.StartArray()) return false;
+      for (std::uint32_t i = 0; i < count; i++)
+        if (!Read(handler, depth + 1)) return false;
+      return handler.EndArray(count);
+    }
+    case Tag::Object: {
+      std::uint32_t count;
+      if (!Take(count) || !handler.StartObject()) return false;
+      for (std::uint32_t i = 0; i < count; i++) {
+        Name name;
+        if (!TakeName(name) ||
+            !handler.Key(strings + name.offset, name.length, false) ||
+            !Read(handler, depth + 1))
+          return false;
+      }
+      return handler.EndObject(count);
+    }
+    case Tag::IntArray:
+      return ReadPacked<std::int32_t>(
+          handler, [&](std::int32_t value) { return handler.Int(value); });
+    case Tag::DoubleArray:
+      return ReadPacked<double>(
+          handler, [&](double value) { return handler.Double(value); });
+    }
+    return false;
+  }
+};
+
+/*
+ * Accepts every value, so that a file's nodes can be checked before any of
+ * them is built
+ */
+struct SkipHandler {
+  bool Null() { return true; }
+  bool Bool(bool) { return true; }
+  bool Int(std::int32_t) { return true; }
+  bool Uint(std::uint32_t) { return true; }
+  bool Int64(std::int64_t) { return true; }
+  bool Uint64(std::uint64_t) { return true; }
+  bool Double(double) { return true; }
+  bool String(const char *, std::uint32_t, bool) { return true; }
+  bool Key(const char *, std::uint32_t, bool) { return true; }
+  bool StartObject() { return true; }
+  bool EndObject(std::uint32_t) { return true; }
+  bool StartArray() { return true; }
+  bool EndArray(std::uint32_t) { return true; }
+};
+
+/*
+ * A compiled scene which has been checked, so that it can be read without
+ * checking its contents again
+ */
+struct CompiledScene {
+  MappedFile file;
+  Header header;
+  std::vector<Name> names;
+
+  // The block of strings within the file
+  const char *strings = nullptr;
+
+  std::uint32_t Index(std::uint64_t offset, std::uint32_t i) const {
+    std::uint32_t index;
+    std::memcpy(&index, file.Data() + offset + i * sizeof(index),
+                sizeof(index));
+    return index;
+  }
+
+  std::string String(std::uint32_t id) const {
+    return {strings + names[id].offset, names[id].length};
+  }
+
+  std::vector<std::string> Strings(std::uint64_t offset,
+                                   std::uint32_t count) const {
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (std::uint32_t i = 0; i < count; i++)
+      out.push_back(String(Index(offset, i)));
+    return out;
+  }
+
+  SceneReader Nodes() const {
+    return {file.Data() + header.nodeOffset, header.nodeBytes, names,
+            strings};
+  }
+};
+
+bool CheckIndices(const CompiledScene &scene, std::uint64_t offset,
+                  std::uint32_t count) {
+  for (std::uint32_t i = 0; i < count; i++)
+    if (scene.Index(offset, i) >= scene.header.stringCount) return false;
+  return true;
+}
+
+bool CheckNodes(const CompiledScene &scene) {
+  auto reader = scene.Nodes();
+  SkipHandler skip;
+  for (std::uint32_t i = 0; i < scene.header.nodeCount; i++) {
+    std::uint32_t type, tag;
+    if (!reader.Take(type) || type >= scene.header.typeCount ||
+        !reader.Take(tag) ||
+        (tag != noTag && tag >= scene.header.stringCount) ||
+        !reader.Read(skip))
+      return false;
+  }
+  return reader.Finished();
+}
+
+/*
+ * Opens and checks the compiled form of a scene
+ * @returns false if it is missing, out of date or corrupt
+ */
+bool OpenCompiled(const std::string &source, CompiledScene &out) {
+  auto &statistics = SceneCache::statistics;
+  auto path = SceneCache::Path(source);
+  auto &file = out.file;
+  if (!file.Open(path)) {
+    statistics.misses++;
+    return false;
+  }
+
+  auto &header = out.header;
+  if (file.Size() < sizeof(header)) {
+    statistics.stale++;
+    return false;
+  }
+  std::memcpy(&header, file.Data(), sizeof(header));
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+      header.version != version) {
+    statistics.stale++;
+    return false;
+  }
+
+  // Without its source, the compiled scene is all there is to read
+  if (File::Exists(source) && !File::Matches(source, header.source)) {
+    statistics.stale++;
+    return false;
+  }
+
+  constexpr auto index = sizeof(std::uint32_t);
+  auto size = file.Size();
+  if (!Fits(header.nameOffset,
+            std::uint64_t{header.stringCount} * sizeof(Name), size) ||
+      !Fits(header.stringOffset, header.stringBytes, size) ||
+      !Fits(header.typeOffset, std::uint64_t{header.typeCount} * index,
+            size) ||
+      !Fits(header.meshOffset, std::uint64_t{header.meshCount} * index,
+            size) ||
+      !Fits(header.textureOffset,
+            std::uint64_t{header.textureCount} * index, size) ||
+      !Fits(header.nodeOffset, header.nodeBytes, size)) {
+    std::cerr << "SceneCache: '" << path << "' is truncated\n";
+    statistics.stale++;
+    return false;
+  }
+
+  out.names.resize(header.stringCount);
+  if (header.stringCount)
+    std::memcpy(out.names.data(), file.Data() + header.nameOffset,
+                header.stringCount * sizeof(Name));
+  out.strings = file.Data() + header.stringOffset;
+
+  // Strings are used in place, so each must be followed by its null
+  // character within the block
+  bool valid = true;
+  for (const auto &name : out.names)
+    valid = valid &&
+            std::uint64_t{name.offset} + name.length < header.stringBytes &&
+            out.strings[name.offset + name.length] == '\0';
+  if (!valid || !CheckIndices(out, header.typeOffset, header.typeCount) ||
+      !CheckIndices(out, header.meshOffset, header.meshCount) ||
+      !CheckIndices(out, header.textureOffset, header.textureCount) ||
+      !CheckNodes(out)) {
+    std::cerr << "SceneCache: '" << path << "' is corrupt\n";
+    statistics.stale++;
+    return false;
+  }
+  return true;
+}
+
+void BuildNodes(const CompiledScene &compiled, Scene &scene,
+                const JSON::ReadData &data) {
+  auto t = Trace::Pusher{data.trace, "Scene"};
+  const auto &header = compiled.header;
+
+  // Each type is looked up once, rather than once for every node
+  std::vector<const JSON::TypeManager::mapped_type *> types;
+  types.reserve(header.typeCount);
+  for (std::uint32_t i = 0; i < header.typeCount; i++) {
+    auto type = compiled.String(compiled.Index(header.typeOffset, i));
+    auto funcIt = data.typeManager->find(type);
+    if (funcIt == std::end(*data.typeManager)) {
+      std::cerr << "Type '" << type
+                << "' is not registered in the current TypeManager\n";
+      return;
+    }
+    types.push_back(&funcIt->second);
+  }
+
+  // Every node's value is decoded into the same memory, which is cleared
+  // once the node has been built
+  std::vector<char> memory(nodeMemory);
+  JSON::Document::AllocatorType allocator(memory.data(), memory.size());
+  JSON::Document value(&allocator);
+
+  auto reader = compiled.Nodes();
+  auto generate = [&](auto &handler) { return reader.Read(handler); };
+  for (std::uint32_t i = 0; i < header.nodeCount; i++) {
+    std::uint32_t type, tag;
+    reader.Take(type);
+    reader.Take(tag);
+    value.Populate(generate);
+
+    auto *node = (*types[type])(value, data);
+    if (tag != noTag) {
+      JSON::ParseAssert(TagManager::active, data,
+                        "In order to load a 'Tagged' object, there should be "
+                        "an active TagManager object");
+      TagManager::active->map[compiled.String(tag)] = node;
+    }
+    reinterpret_cast<NNode *>(node)->Parent(&scene.root);
+    allocator.Clear();
+  }
+}
+} // namespace
+
+std::string SceneCache::Path(const std::string &source) {
+  std::stringstream ss;
+  ss << directory << std::hex << std::setw(16) << std::setfill('0')
+     << HashString(source) << ".scene";
+  return ss.str();
+}
+
+void SceneCache::ReadScene(const std::string &source, Scene &scene,
+                           const JSON::ReadData &data) {
+  if (ReadCompiled(source, scene, data)) return;
+
+  JSON::Document document;
+  JSON::GetDataFromFile(document, source);
+  AssetPrefetch::ReadScene(scene, document, data);
+}
+
+bool SceneCache::ReadCompiled(const std::string &source, Scene &scene,
+                              const JSON::ReadData &data) {
+  if (!enabled) return false;
+
+  CompiledScene compiled;
+  if (!OpenCompiled(source, compiled)) return false;
+
+  const auto &header = compiled.header;
+  AssetPrefetch::ReadScene(
+      [&](AssetPrefetch &prefetch) {
+        prefetch.Start(
+            compiled.Strings(header.meshOffset, header.meshCount),
+            compiled.Strings(header.textureOffset, header.textureCount));
+      },
+      [&] { BuildNodes(compiled, scene, data); });
+  statistics.hits++;
+  return true;
+}
+
+bool SceneCache::Store(const std::string &source, const JSON::Value &scene) {
+  File::Stamp stamp;
+  if (!File::GetStamp(source, stamp)) return false;
+
+  SceneWriter writer;
+  if (!writer.WriteScene(scene)) {
+    std::cerr << "SceneCache: '" << source << "' is not a scene\n";
+    return false;
+  }
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.source = stamp;
+  header.stringCount = writer.names.size();
+  header.stringBytes = writer.strings.size();
+  header.typeCount = writer.types.size();
+  header.meshCount = writer.meshes.size();
+  header.textureCount = writer.textures.size();
+  header.nodeCount = writer.nodeCount;
+  header.nodeBytes = writer.nodes.size();
+
+  std::string contents(sizeof(header), '\0');
+  header.nameOffset =
+      AppendBlock(contents, writer.names.data(), writer.names.size());
+  header.stringOffset =
+      AppendBlock(contents, writer.strings.data(), writer.strings.size());
+  header.typeOffset =
+      AppendBlock(contents, writer.types.data(), writer.types.size());
+  header.meshOffset =
+      AppendBlock(contents, writer.meshes.data(), writer.meshes.size());
+  header.textureOffset =
+      AppendBlock(contents, writer.textures.data(), writer.textures.size());
+  header.nodeOffset =
+      AppendBlock(contents, writer.nodes.data(), writer.nodes.size());
+  std::memcpy(&contents[0], &header, sizeof(header));
+
+  try {
+    if (!Directory::Exists(directory)) Directory::Create(directory);
+    File::Write(Path(source), contents);
+  } catch (const FileAccessException &e) {
+    std::cerr << "SceneCache: " << e.what() << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool SceneCache::Compile(const std::string &source) {
+  JSON::Document document;
+  try {
+    JSON::GetDataFromFile(document, source);
+  } catch (const FileAccessException &e) {
+    std::cerr << "SceneCache: " << e.what() << '\n';
+    return false;
+  } catch (const JSON::ParseException &) {
+    std::cerr << "SceneCache: '" << source << "' is not valid JSON\n";
+    return false;
+  }
+  return Store(source, document);
+}
+
+void SceneCache::Report(std::ostream &os) {
+  const auto &s = statistics;
+  os << "Scene cache: " << s.hits << " hits, " << s.misses << " misses";
+  if (s.stale) os << ", " << s.stale << " stale";
+  os << '\n';
+}
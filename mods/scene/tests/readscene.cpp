@@ -0,0 +1,100 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <assetprefetch.h>
+#include <scene.h>
+#include <tagmanager.h>
+#include <test/allocations.h>
+
+#include <iostream>
+#include <vector>
+
+// Meshes, lights and cameras need a GL context or window when read, so they
+// are read as the nodes they are made from instead
+static void *NodeDataRegistration(const JSON::Value &value,
+                                  const JSON::ReadData &data) {
+  auto t = Trace::Pusher{data.trace, "NodeDataRegistration"};
+  auto *node = new NNode;
+  JSON::GetMember<NNode>(*node, "NNode", JSON::GetObject(value, data), data);
+  return node;
+}
+
+// Reads the scene into a new scene, and returns the number of allocations
+// made while reading
+static std::size_t ReadScene(const JSON::Value &document,
+                             const JSON::ReadData &data) {
+  TagManager tags;
+  TagManager::active = &tags;
+  Scene scene;
+
+  auto before = Allocations();
+  AssetPrefetch::ReadScene(scene, document, data);
+  auto made = Allocations() - before;
+  TagManager::active = nullptr;
+
+  std::vector<NNode *> nodes(scene.root.begin(), scene.root.end());
+  REQUIRE(nodes.size() == 4);
+  REQUIRE(tags.map.size() == 3);
+  for (auto *node : nodes) node->Destroy();
+  return made;
+}
+
+TEST_CASE("Reading json-load's scene", "[Scene][benchmark]") {
+  JSON::Document document;
+  JSON::GetDataFromFile(document, "mods/json-load/res/scene.json");
+  REQUIRE(document.IsObject());
+
+  auto typeManager = std::make_shared<JSON::TypeManager>();
+  RegisterSceneTypeAssociations(*typeManager);
+  for (const auto *type : {"NMesh", "NPointLight", "NSpectatorCamera"})
+    (*typeManager)[type] = NodeDataRegistration;
+  JSON::ReadData data{typeManager};
+
+  auto previousEnabled = AssetPrefetch::enabled;
+  AssetPrefetch::enabled = false;
+
+  // The first read also makes one-off allocations, such as for statics
+  ReadScene(document, data);
+  auto made = ReadScene(document, data);
+
+  // Tracing used to copy the name of every function a read was nested in.
+  // Reading now allocates the same however deep it is nested, as only the
+  // nodes, their tags and type names allocate
+  for (std::size_t i = 0; i < 2 * Trace::capacity; i++)
+    data.trace.Push("Benchmark");
+  auto nested = ReadScene(document, data);
+  for (std::size_t i = 0; i < 2 * Trace::capacity; i++) data.trace.Pop();
+  AssetPrefetch::enabled = previousEnabled;
+
+  std::cout << made << " allocations reading mods/json-load/res/scene.json, "
+            << nested << " when nested " << 2 * Trace::capacity
+            << " functions deep\n";
+  REQUIRE(nested == made);
+  // A few dozen allocations at most for each of the 4 nodes
+  REQUIRE(made <= 4 * 32);
+}
@@ -0,0 +1,118 @@
+/*
+-------------------------------------------------------------------------------
+This file is part of Eris Engine
+-------------------------------------------------------------------------------
+Copyright (c) 2017 Thomas Pearson
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+-------------------------------------------------------------------------------
+*/
+
+#include <catch.hpp>
+
+#include <assetprefetch.h>
+#include <scene.h>
+#include <scenecache.h>
+#include <tagmanager.h>
+
+#include <core/file.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// The data each probe node was read from, written back out as text
+static std::vector<std::string> probed;
+
+static void *ProbeRegistration(const JSON::Value &value,
+                               const JSON::ReadData & /* data */) {
+  probed.push_back(JSON::WriteToString(
+      [&](JSON::Writer &writer) { value.Accept(writer); }));
+  return new NNode;
+}
+
+static void DestroyNodes(Scene &scene) {
+  std::vector<NNode *> nodes(scene.root.begin(), scene.root.end());
+  for (auto *node : nodes) node->Destroy();
+}
+
+TEST_CASE("Compiling a scene", "[SceneCache]") {
+  const std::string source = "scenecache-test.scene.json";
+  auto previousDirectory = SceneCache::directory;
+  auto previousPrefetch = AssetPrefetch::enabled;
+  SceneCache::directory = "scenecache-test/";
+  AssetPrefetch::enabled = false;
+
+  // Covers every kind of value, packed and unpacked arrays, and tagged nodes
+  File::Write(source, R"({"nodes": [
+    "Probe", {
+      "location": [1, 2, 3], "scale": [0.5, 1.5, 2.5], "name": "a",
+      "visible": true, "hidden": false, "parent": null, "big": 4294967295,
+      "huge": -9007199254740993, "mixed": [1, 0.5, "b", {"c": []}]
+    },
+    "Tagged", [{"tag": "probe"}, "Probe", {"name": "a", "empty": {}}]
+  ]})");
+
+  auto typeManager = std::make_shared<JSON::TypeManager>();
+  RegisterSceneTypeAssociations(*typeManager);
+  (*typeManager)["Probe"] = ProbeRegistration;
+  JSON::ReadData data{typeManager};
+  TagManager tags;
+  TagManager::active = &tags;
+
+  auto hits = SceneCache::statistics.hits.load();
+  auto misses = SceneCache::statistics.misses.load();
+  auto stale = SceneCache::statistics.stale.load();
+
+  // Without a compiled scene, the source is read
+  Scene fromSource;
+  SceneCache::ReadScene(source, fromSource, data);
+  REQUIRE(SceneCache::statistics.misses == misses + 1);
+  auto expected = probed;
+  REQUIRE(expected.size() == 2);
+
+  REQUIRE(SceneCache::Compile(source));
+  probed.clear();
+  tags.map.clear();
+  Scene compiled;
+  SceneCache::ReadScene(source, compiled, data);
+  REQUIRE(SceneCache::statistics.hits == hits + 1);
+  REQUIRE(probed == expected);
+  REQUIRE(tags.map.count("probe") == 1);
+
+  // A build can ship the compiled scene without its source
+  std::remove(source.c_str());
+  probed.clear();
+  Scene shipped;
+  REQUIRE(SceneCache::ReadCompiled(source, shipped, data));
+  REQUIRE(probed == expected);
+
+  // Changing the source makes the compiled scene stale
+  File::Write(source, R"({"nodes": ["Probe", {}]})");
+  Scene edited;
+  REQUIRE_FALSE(SceneCache::ReadCompiled(source, edited, data));
+  REQUIRE(SceneCache::statistics.stale == stale + 1);
+
+  TagManager::active = nullptr;
+  for (auto *scene : {&fromSource, &compiled, &shipped}) DestroyNodes(*scene);
+  std::remove(source.c_str());
+  std::remove(SceneCache::Path(source).c_str());
+  std::remove(SceneCache::directory.c_str());
+  SceneCache::directory = previousDirectory;
+  AssetPrefetch::enabled = previousPrefetch;
+}
@@ -26,3 +26,22 @@ SOFTWARE.
 
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
+
+#include <test/allocations.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::size_t> allocations{0};
+
+std::size_t Allocations() { return allocations; }
+
+void *operator new(std::size_t size) {
+  allocations++;
+  if (void *p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }